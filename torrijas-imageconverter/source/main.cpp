@@ -0,0 +1,112 @@
+//
+// Copyright (c) 2015 Gustavo Valiente gustavovalient@gmail.com
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+//
+
+#include <algorithm>
+#include <cctype>
+#include <iostream>
+#include <string>
+#include "trjfile.h"
+#include "trjimagedata.h"
+#include "trjexception.h"
+
+// Converts the images of an asset folder (and its subfolders) to QOI files ahead of time, so they are
+// loaded without decoding PNG or JPEG at startup:
+//
+// torrijas-imageconverter <input folder> [<output folder>]
+//
+// The output folder mirrors the input one, and it's the input folder if it isn't specified.
+
+namespace
+{
+    bool isConvertible(const trj::File& file)
+    {
+        std::string extension = file.getExtension().getCharArray();
+        std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+
+        return extension == "png" || extension == "jpg" || extension == "jpeg" || extension == "bmp" ||
+                extension == "tga" || extension == "gif" || extension == "psd";
+    }
+
+    void convertFolder(const trj::Folder& inputFolder, trj::Folder outputFolder, int& numConverted,
+            int& numFailed)
+    {
+        if(! outputFolder.exists() && ! outputFolder.create())
+        {
+            std::cerr << "Folder create failed: " << outputFolder.getPath().getCharArray() << std::endl;
+            ++numFailed;
+            return;
+        }
+
+        for(const trj::File& inputFile : inputFolder.getChildFiles())
+        {
+            if(! isConvertible(inputFile))
+            {
+                continue;
+            }
+
+            trj::File outputFile(outputFolder, inputFile.getNameWithoutExtension() + ".qoi");
+
+            try
+            {
+                trj::ImageData imageData(inputFile);
+                imageData.save(outputFile, trj::ImageData::FileFormat::QOI);
+                std::cout << inputFile.getPath().getCharArray() << " -> " <<
+                        outputFile.getPath().getCharArray() << std::endl;
+                ++numConverted;
+            }
+            catch(const trj::Exception& exception)
+            {
+                std::cerr << inputFile.getPath().getCharArray() << ": " << exception.getMessage().getCharArray() <<
+                        std::endl;
+                ++numFailed;
+            }
+        }
+
+        for(const trj::Folder& inputChildFolder : inputFolder.getChildFolders())
+        {
+            convertFolder(inputChildFolder, trj::Folder(outputFolder, inputChildFolder.getName()), numConverted,
+                    numFailed);
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if(argc < 2 || argc > 3)
+    {
+        std::cerr << "Usage: torrijas-imageconverter <input folder> [<output folder>]" << std::endl;
+        return 1;
+    }
+
+    trj::String inputPath = std::string(argv[1]);
+    if(! trj::Folder::isFolderPath(inputPath))
+    {
+        std::cerr << "Input folder not found: " << argv[1] << std::endl;
+        return 1;
+    }
+
+    trj::Folder inputFolder(inputPath);
+    trj::Folder outputFolder = argc == 3 ? trj::Folder(std::string(argv[2])) : inputFolder;
+
+    int numConverted = 0;
+    int numFailed = 0;
+    convertFolder(inputFolder, std::move(outputFolder), numConverted, numFailed);
+
+    std::cout << numConverted << " images converted, " << numFailed << " failed" << std::endl;
+    return numFailed ? 1 : 0;
+}
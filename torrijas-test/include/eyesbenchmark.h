@@ -25,6 +25,23 @@ class EyesBenchmark : public Test
 {
 
 public:
+    // The default variant is the original workload, so its numbers can be compared with previous runs:
+    enum class Variant
+    {
+        DEFAULT,
+        SPATIAL_INDEX, // Same nodes, culled with the root node spatial index.
+        INSTANCED // Clones of one node drawn instanced, culled with the root node spatial index.
+    };
+
+protected:
+    Variant mVariant;
+
+public:
+    explicit EyesBenchmark(Variant variant = Variant::DEFAULT) noexcept :
+        mVariant(variant)
+    {
+    }
+
     void run();
 };
 
@@ -19,6 +19,8 @@
 #ifndef TEST_H
 #define TEST_H
 
+#include <functional>
+#include <random>
 #include "trjnode.h"
 
 class Test
@@ -34,6 +36,17 @@ public:
 
     static trj::Ptr<trj::Node> getEyesNode(float positionX, float positionY);
 
+    // Adds numNodes nodes created by createNode to the given parent at random positions, moving back and forth
+    // and, if rotate is true, rotating:
+    static void addAnimatedNodes(trj::Node& parent, int numNodes, float maxPosition, bool rotate,
+            const std::function<trj::Ptr<trj::Node>(std::mt19937& randomGenerator, int index)>& createNode);
+
+    // Runs each test for some frames and shows the result returned by getTestResult with its average time.
+    // setUpTest is called before each test, and getTestTime returns the time of the last frame to average:
+    static void runTimedTests(int numTests, const std::function<void(int testIndex)>& setUpTest,
+            const std::function<trj::String(int testIndex, float averageTime)>& getTestResult,
+            const std::function<double()>& getTestTime = nullptr);
+
     static void setTitle(trj::String title);
 
     static void setTitle(trj::String title, trj::String aditionalText);
@@ -24,12 +24,19 @@
 
 void EyesBenchmark::run()
 {
-    trj::main([]()
+    Variant variant = mVariant;
+
+    trj::main([variant]()
     {
         trj::Application::setBackgroundColor(0.3, 0.3, 0.3);
         trj::Application::setShowPerformanceGraphs(true);
 
         auto& rootNode = trj::Node::getRootNode();
+        if(variant != Variant::DEFAULT)
+        {
+            rootNode.setSpatialIndexEnabled(true);
+        }
+
         rootNode.addChild(getCenterNode());
 
         std::mt19937 randomGenerator;
@@ -43,21 +50,51 @@ void EyesBenchmark::run()
         float aspectRatio = trj::Application::getScreenAspectRatio();
         rootNode.reserveChildren(numEyes + rootNode.getChildren().size());
 
+        // In the instanced variant all eyes are clones of the same node, so they share its render cache:
+        trj::Ptr<trj::Node> eyesPrototype;
+        if(variant == Variant::INSTANCED)
+        {
+            eyesPrototype = getEyesNode(0, 0);
+            eyesPrototype->setRenderInstanced(true);
+        }
+
         for(int index = 0; index < numEyes; ++index)
         {
             float positionX = positionDistribution(randomGenerator);
             float positionY = positionDistribution(randomGenerator);
 
-            auto& eyesNode = rootNode.addChild(getEyesNode(positionX * aspectRatio, positionY));
-            eyesNode.setOpacity(opacityDistribution(randomGenerator));
+            trj::Node* eyesNode;
+            if(eyesPrototype)
+            {
+                const trj::Point& prototypePosition = eyesPrototype->getPosition();
+                eyesNode = &rootNode.addChild(eyesPrototype->getClone());
+                eyesNode->setPosition(prototypePosition.getX() + (positionX * aspectRatio),
+                        prototypePosition.getY() + positionY);
+            }
+            else
+            {
+                eyesNode = &rootNode.addChild(getEyesNode(positionX * aspectRatio, positionY));
+            }
+
+            eyesNode->setOpacity(opacityDistribution(randomGenerator));
 
             trj::Color blendColor(colorDistribution(randomGenerator),
                     colorDistribution(randomGenerator), colorDistribution(randomGenerator));
-            eyesNode.setBlendColor(blendColor, blendFactorDistribution(randomGenerator));
+            eyesNode->setBlendColor(blendColor, blendFactorDistribution(randomGenerator));
+        }
+
+        trj::String title = "Eyes Benchmark";
+        if(variant == Variant::SPATIAL_INDEX)
+        {
+            title = "Eyes Benchmark (spatial index)";
+        }
+        else if(variant == Variant::INSTANCED)
+        {
+            title = "Eyes Benchmark (instanced)";
         }
 
         double loadTime = trj::Application::getElapsedTime() - time;
-        setTitle("Eyes Benchmark", "Load time: " + trj::String(loadTime) + " seconds");
+        setTitle(std::move(title), "Load time: " + trj::String(loadTime) + " seconds");
 
         while(true)
         {
@@ -68,6 +68,11 @@ void ImagesTest::run()
         spriteNode->setBlendColor(1.0f, 0.0f, 0.0f, 0.5f);
         rootNode.addChild(std::move(spriteNode));
 
+        // Drawn once it is decoded and uploaded:
+        auto& torrijoNode = rootNode.addChild(trj::ImageNode::create(200,
+                trj::Image::loadAsync("../../torrijas-test/images/torrijo.png")));
+        torrijoNode.setPosition(0, 350);
+
         setTitle("Images Test");
 
         while(true)
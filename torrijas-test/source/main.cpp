@@ -22,6 +22,11 @@
 #include "keyboardtest.h"
 #include "mousetest.h"
 #include "eyesbenchmark.h"
+#include "parallelupdatebenchmark.h"
+#include "parallelupdatetest.h"
+#include "simdtessellationtest.h"
+#include "streamingbenchmark.h"
+#include "spritesbenchmark.h"
 #include "linestest.h"
 #include "filestest.h"
 #include "imagestest.h"
@@ -82,6 +87,13 @@ int main()
     KeyboardTest().run();
     MouseTest().run();
     EyesBenchmark().run();
+    EyesBenchmark(EyesBenchmark::Variant::SPATIAL_INDEX).run();
+    EyesBenchmark(EyesBenchmark::Variant::INSTANCED).run();
+    ParallelUpdateTest().run();
+    SimdTessellationTest().run();
+    ParallelUpdateBenchmark().run();
+    StreamingBenchmark().run();
+    SpritesBenchmark().run();
     LinesTest().run();
     FilesTest().run();
     ImagesTest().run();
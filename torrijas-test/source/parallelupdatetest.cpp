@@ -0,0 +1,180 @@
+//
+// Copyright (c) 2015 Gustavo Valiente gustavovalient@gmail.com
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+//
+
+#include "parallelupdatetest.h"
+
+#include <iostream>
+#include <random>
+#include "trjmain.h"
+#include "trjnode.h"
+#include "trjapplicationconfig.h"
+#include "trjcallbackaction.h"
+#include "trjmoveaction.h"
+#include "trjrotateaction.h"
+#include "trjscaleaction.h"
+#include "trjsequenceaction.h"
+#include "trjrepeataction.h"
+
+namespace
+{
+    // Moves itself in each per frame update:
+    class DriftNode : public trj::Node
+    {
+
+    protected:
+        float mSpeed;
+
+        void updateItself(float elapsedTime) override
+        {
+            const trj::Point& position = getPosition();
+            setPosition(position.getX() + (mSpeed * elapsedTime), position.getY());
+        }
+
+    public:
+        explicit DriftNode(float speed) noexcept :
+            mSpeed(speed)
+        {
+        }
+    };
+
+    struct NodeState
+    {
+        float positionX;
+        float positionY;
+        float rotationAngle;
+        float scaleX;
+        float scaleY;
+    };
+
+    std::vector<NodeState> getFinalStates(int numThreads)
+    {
+        trj::Application::setNumUpdateThreads(numThreads);
+
+        auto& rootNode = trj::Node::getRootNode();
+        auto& nodesParent = rootNode.addNewChild();
+
+        std::mt19937 randomGenerator;
+        std::uniform_real_distribution<float> positionDistribution(-500, 500);
+        std::uniform_real_distribution<float> durationDistribution(0.1f, 1.0f);
+
+        // Long runs of nodes without callbacks or per frame updates are updated in parallel, and the
+        // other ones inline between them:
+        const int numNodes = 4000;
+        const int runSize = 1000;
+        const int numInlineNodes = 20;
+        nodesParent.reserveChildren(numNodes);
+
+        for(int index = 0; index < numNodes; ++index)
+        {
+            float duration = durationDistribution(randomGenerator);
+            bool inlineNode = index % runSize < numInlineNodes;
+            trj::Node* node;
+
+            if(inlineNode && index % 2 == 0)
+            {
+                auto driftNode = trj::Ptr<DriftNode>(new DriftNode(positionDistribution(randomGenerator)));
+                driftNode->setUpdateEnabled(true);
+                node = &nodesParent.addChild(std::move(driftNode));
+            }
+            else
+            {
+                node = &nodesParent.addNewChild();
+            }
+
+            float positionX = positionDistribution(randomGenerator);
+            float positionY = positionDistribution(randomGenerator);
+            node->setPosition(positionX, positionY);
+
+            std::vector<trj::Ptr<trj::Action>> actions;
+            if(inlineNode && index % 2 == 1)
+            {
+                // The callback reads the next node before it is updated, like in the single thread update:
+                actions.push_back(trj::CallBackAction::create([&nodesParent, index]()
+                {
+                    const trj::Point& nextPosition = nodesParent.getChild(index + 1).getPosition();
+                    nodesParent.getChild(index).setPosition(nextPosition.getY(), nextPosition.getX());
+                }));
+            }
+            actions.push_back(trj::MoveAction::create(100, 50, duration));
+            actions.push_back(trj::ScaleAction::create(0.5f, 0.25f, duration));
+            node->addAction(trj::RepeatAction::create(trj::SequenceAction::create(std::move(actions)), 3));
+            node->addAction(trj::RepeatAction::create(trj::RotateAction::create(trj::kPi, duration)));
+        }
+
+        const int numFrames = 300;
+        for(int frame = 0; frame < numFrames; ++frame)
+        {
+            trj::Application::updateNodes(1 / 60.0f);
+        }
+
+        std::vector<NodeState> states;
+        for(int index = 0; index < numNodes; ++index)
+        {
+            const trj::Node& node = nodesParent.getChild(index);
+            const trj::Point& position = node.getPosition();
+            states.push_back(NodeState{ position.getX(), position.getY(), node.getRotationAngle(),
+                    node.getScaleX(), node.getScaleY() });
+        }
+
+        rootNode.removeChild(nodesParent);
+        return states;
+    }
+}
+
+void ParallelUpdateTest::run()
+{
+    trj::ApplicationConfig config;
+    config.setHeadlessEnabled(true);
+
+    trj::main(config, []()
+    {
+        std::vector<NodeState> inlineStates = getFinalStates(1);
+        const int numThreadsList[] = { 2, 4, 8 };
+        bool passed = true;
+
+        for(int numThreads : numThreadsList)
+        {
+            std::vector<NodeState> parallelStates = getFinalStates(numThreads);
+            int numDifferentNodes = 0;
+
+            for(std::size_t index = 0; index < inlineStates.size(); ++index)
+            {
+                const NodeState& a = inlineStates[index];
+                const NodeState& b = parallelStates[index];
+                if(a.positionX != b.positionX || a.positionY != b.positionY ||
+                        a.rotationAngle != b.rotationAngle || a.scaleX != b.scaleX || a.scaleY != b.scaleY)
+                {
+                    ++numDifferentNodes;
+                }
+            }
+
+            std::cout << "Parallel update test, " << numThreads << " threads: " <<
+                    (numDifferentNodes ? "FAILED, " : "passed, ") << numDifferentNodes << " different nodes" <<
+                    std::endl;
+            passed &= ! numDifferentNodes;
+        }
+
+        trj::Application::setNumUpdateThreads(1);
+        trj::Application::setClosed(true);
+
+        if(! passed)
+        {
+            throw trj::Exception(__FILE__, __LINE__, "Parallel update test failed");
+        }
+    });
+}
@@ -0,0 +1,147 @@
+//
+// Copyright (c) 2015 Gustavo Valiente gustavovalient@gmail.com
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+//
+
+#include "simdtessellationtest.h"
+
+#include <iostream>
+#include <random>
+#include <vector>
+#include "nanovg.h"
+#include "trjmain.h"
+#include "trjapplication.h"
+#include "trjapplicationconfig.h"
+
+namespace
+{
+    // Random closed and open paths of cubic and quadratic curves, filled and stroked with random styles:
+    void drawRandomPaths(NVGcontext& nanoVgContext, unsigned int seed)
+    {
+        std::mt19937 randomGenerator(seed);
+        std::uniform_real_distribution<float> positionDistribution(-500, 500);
+        std::uniform_real_distribution<float> scaleDistribution(0.05f, 20.0f);
+        std::uniform_real_distribution<float> strokeWidthDistribution(0.25f, 40.0f);
+        std::uniform_int_distribution<int> numCurvesDistribution(1, 12);
+        std::uniform_int_distribution<int> styleDistribution(0, 2);
+
+        const int lineJoins[] = { NVG_MITER, NVG_ROUND, NVG_BEVEL };
+        const int lineCaps[] = { NVG_BUTT, NVG_ROUND, NVG_SQUARE };
+        const int numPaths = 8;
+
+        for(int pathIndex = 0; pathIndex < numPaths; ++pathIndex)
+        {
+            nvgResetTransform(&nanoVgContext);
+            nvgScale(&nanoVgContext, scaleDistribution(randomGenerator), scaleDistribution(randomGenerator));
+
+            nvgBeginPath(&nanoVgContext);
+            nvgMoveTo(&nanoVgContext, positionDistribution(randomGenerator), positionDistribution(randomGenerator));
+
+            for(int curveIndex = 0, numCurves = numCurvesDistribution(randomGenerator); curveIndex < numCurves;
+                    ++curveIndex)
+            {
+                float controlX = positionDistribution(randomGenerator);
+                float controlY = positionDistribution(randomGenerator);
+                float x = positionDistribution(randomGenerator);
+                float y = positionDistribution(randomGenerator);
+
+                if(curveIndex % 2)
+                {
+                    nvgQuadTo(&nanoVgContext, controlX, controlY, x, y);
+                }
+                else
+                {
+                    nvgBezierTo(&nanoVgContext, controlX, controlY, positionDistribution(randomGenerator),
+                            positionDistribution(randomGenerator), x, y);
+                }
+            }
+
+            int style = styleDistribution(randomGenerator);
+            if(style != 1)
+            {
+                nvgClosePath(&nanoVgContext);
+                nvgFillColor(&nanoVgContext, nvgRGBA(255, 0, 0, 255));
+                nvgFill(&nanoVgContext);
+            }
+
+            if(style != 0)
+            {
+                nvgStrokeWidth(&nanoVgContext, strokeWidthDistribution(randomGenerator));
+                nvgLineJoin(&nanoVgContext, lineJoins[styleDistribution(randomGenerator)]);
+                nvgLineCap(&nanoVgContext, lineCaps[styleDistribution(randomGenerator)]);
+                nvgStrokeColor(&nanoVgContext, nvgRGBA(0, 0, 255, 255));
+                nvgStroke(&nanoVgContext);
+            }
+        }
+    }
+
+    std::vector<unsigned char> recordRandomPaths(NVGcontext& nanoVgContext, unsigned int seed, bool simd)
+    {
+        // Display lists are recorded in a recording context, so the application back end isn't used:
+        NVGcontext* recordingContext = nvgCreateRecordingContext(&nanoVgContext);
+        if(! recordingContext)
+        {
+            throw trj::Exception(__FILE__, __LINE__, "NanoVG recording context build failed");
+        }
+
+        nvgSimdTessellation(recordingContext, simd);
+        nvgBeginFrame(recordingContext, trj::Application::getRealScreenWidth(),
+                trj::Application::getRealScreenHeight(), 1);
+
+        NVGdisplayList* displayList = nvgCreateDisplayList(-1);
+        nvgBindDisplayList(recordingContext, displayList);
+        drawRandomPaths(*recordingContext, seed);
+        nvgBindDisplayList(recordingContext, nullptr);
+
+        std::vector<unsigned char> data(nvgWriteDisplayList(recordingContext, displayList, nullptr));
+        nvgWriteDisplayList(recordingContext, displayList, data.data());
+
+        nvgDeleteDisplayList(displayList);
+        nvgDeleteRecordingContext(recordingContext);
+        return data;
+    }
+}
+
+void SimdTessellationTest::run()
+{
+    trj::ApplicationConfig config;
+    config.setHeadlessEnabled(true);
+
+    trj::main(config, []()
+    {
+        NVGcontext& nanoVgContext = trj::Application::getNanoVgContext();
+        const unsigned int numSeeds = 200;
+        int numDifferentLists = 0;
+
+        for(unsigned int seed = 0; seed < numSeeds; ++seed)
+        {
+            if(recordRandomPaths(nanoVgContext, seed, true) != recordRandomPaths(nanoVgContext, seed, false))
+            {
+                ++numDifferentLists;
+            }
+        }
+
+        std::cout << "SIMD tessellation test: " << (numDifferentLists ? "FAILED, " : "passed, ") <<
+                numDifferentLists << " different display lists of " << numSeeds << std::endl;
+
+        trj::Application::setClosed(true);
+
+        if(numDifferentLists)
+        {
+            throw trj::Exception(__FILE__, __LINE__, "SIMD tessellation test failed");
+        }
+    });
+}
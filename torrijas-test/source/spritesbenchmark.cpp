@@ -0,0 +1,79 @@
+//
+// Copyright (c) 2015 Gustavo Valiente gustavovalient@gmail.com
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+//
+
+#include "spritesbenchmark.h"
+
+#include "trjmain.h"
+#include "trjnode.h"
+#include "trjimage.h"
+#include "trjimagenode.h"
+#include "trjapplicationconfig.h"
+#include "trjrenderstats.h"
+
+void SpritesBenchmark::run()
+{
+    trj::ApplicationConfig config;
+    config.setVSyncEnabled(false);
+
+    trj::main(config, []()
+    {
+        trj::Application::setBackgroundColor(0.3, 0.3, 0.3);
+        trj::Application::setShowPerformanceGraphs(true);
+
+        auto& rootNode = trj::Node::getRootNode();
+        rootNode.addChild(getCenterNode());
+
+        auto& nodesParent = rootNode.addNewChild();
+        trj::Image spritesImage("../../torrijas-test/images/sprites.png", 0);
+        const trj::Rect spriteRegions[] = {
+            trj::Rect(0, 0, 135, 107),
+            trj::Rect(65, 60, 60, 50),
+            trj::Rect(225, 137, 40, 45)
+        };
+
+        std::uniform_int_distribution<int> regionDistribution(0, 2);
+
+        // Image nodes of the same image, so consecutive ones are drawn with one call. A quarter of them
+        // are tinted:
+        addAnimatedNodes(nodesParent, 20000, 450, false, [&](std::mt19937& randomGenerator, int index)
+        {
+            const trj::Rect& spriteRegion = spriteRegions[regionDistribution(randomGenerator)];
+            auto node = trj::ImageNode::create(20, spritesImage, spriteRegion);
+
+            if(index % 4 == 0)
+            {
+                node->setBlendColor(1.0f, 0.0f, 0.0f, 0.5f);
+            }
+
+            return node;
+        });
+
+        setTitle("Sprites Benchmark", "Average frame time / GL draws:");
+
+        const int numTests = 1;
+
+        runTimedTests(numTests, [](int)
+        {
+        },
+        [](int, float averageTime)
+        {
+            trj::RenderStats renderStats = trj::Application::getRenderStats();
+            return trj::String(averageTime) + " ms   " + trj::String(renderStats.getNumGlDraws()) + " draws";
+        });
+    });
+}
@@ -0,0 +1,80 @@
+//
+// Copyright (c) 2015 Gustavo Valiente gustavovalient@gmail.com
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+//
+
+#include "streamingbenchmark.h"
+
+#include "trjmain.h"
+#include "trjnode.h"
+#include "trjapplicationconfig.h"
+#include "trjcolorpen.h"
+#include "trjrectshape.h"
+#include "trjellipseshape.h"
+
+void StreamingBenchmark::run()
+{
+    trj::ApplicationConfig config;
+    config.setVSyncEnabled(false);
+
+    trj::main(config, []()
+    {
+        trj::Application::setBackgroundColor(0.3, 0.3, 0.3);
+        trj::Application::setShowPerformanceGraphs(true);
+
+        auto& rootNode = trj::Node::getRootNode();
+        rootNode.addChild(getCenterNode());
+
+        auto& nodesParent = rootNode.addNewChild();
+
+        std::uniform_real_distribution<float> colorDistribution(0.0f, 1.0f);
+
+        // Visible nodes, so their vertices and uniforms are uploaded every frame:
+        addAnimatedNodes(nodesParent, 10000, 450, true, [&](std::mt19937& randomGenerator, int)
+        {
+            float red = colorDistribution(randomGenerator);
+            float green = colorDistribution(randomGenerator);
+            float blue = colorDistribution(randomGenerator);
+            trj::ShapeGroup shapeGroup(trj::ColorPen(trj::Color(red, green, blue)));
+            shapeGroup.addShape(trj::EllipseShape(0, 0, 10, 6));
+
+            trj::ShapeGroup strokeShapeGroup(trj::StrokeColorPen(trj::Color(1, 1, 1, 0.5f), 2));
+            strokeShapeGroup.addShape(trj::RectShape(-10, -10, 20, 20));
+
+            auto node = trj::Node::create();
+            node->addShapeGroup(std::move(shapeGroup));
+            node->addShapeGroup(std::move(strokeShapeGroup));
+            return node;
+        });
+
+        setTitle("Streaming Benchmark", "Streaming buffers / average frame time:");
+
+        // Streaming buffers are only supported with TRJ_CFG_GL3, so the other backends measure
+        // the same path twice:
+        const bool streamingBuffersList[] = { false, true, false, true };
+        const int numTests = 4;
+
+        runTimedTests(numTests, [&](int testIndex)
+        {
+            trj::Application::setStreamingBuffersEnabled(streamingBuffersList[testIndex]);
+        },
+        [](int, float averageTime)
+        {
+            return trj::String(trj::Application::isStreamingBuffersEnabled() ? "On: " : "Off: ") +
+                    trj::String(averageTime) + " ms";
+        });
+    });
+}
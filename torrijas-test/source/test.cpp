@@ -26,6 +26,10 @@
 #include "trjlineargradientpen.h"
 #include "trjradialgradientpen.h"
 #include "trjellipseshape.h"
+#include "trjmoveaction.h"
+#include "trjrotateaction.h"
+#include "trjsequenceaction.h"
+#include "trjrepeataction.h"
 
 trj::Ptr<trj::Node> Test::getCenterNode()
 {
@@ -143,6 +147,81 @@ trj::Ptr<trj::Node> Test::getEyesNode(float positionX, float positionY)
     return eyesNode;
 }
 
+void Test::addAnimatedNodes(trj::Node& parent, int numNodes, float maxPosition, bool rotate,
+        const std::function<trj::Ptr<trj::Node>(std::mt19937& randomGenerator, int index)>& createNode)
+{
+    std::mt19937 randomGenerator;
+    std::uniform_real_distribution<float> positionDistribution(-maxPosition, maxPosition);
+    std::uniform_real_distribution<float> durationDistribution(0.5f, 2.0f);
+
+    float aspectRatio = trj::Application::getScreenAspectRatio();
+    parent.reserveChildren(parent.getChildren().size() + numNodes);
+
+    for(int index = 0; index < numNodes; ++index)
+    {
+        auto& node = parent.addChild(createNode(randomGenerator, index));
+        node.setPosition(positionDistribution(randomGenerator) * aspectRatio,
+                positionDistribution(randomGenerator));
+
+        float duration = durationDistribution(randomGenerator);
+        auto moveAction = trj::MoveAction::create(100, 50, duration);
+        auto reverseMoveAction = moveAction->getReversed();
+
+        std::vector<trj::Ptr<trj::Action>> actions;
+        actions.push_back(std::move(moveAction));
+        actions.push_back(std::move(reverseMoveAction));
+        node.addAction(trj::RepeatAction::create(trj::SequenceAction::create(std::move(actions))));
+
+        if(rotate)
+        {
+            node.addAction(trj::RepeatAction::create(trj::RotateAction::create(trj::kPi, duration)));
+        }
+    }
+}
+
+void Test::runTimedTests(int numTests, const std::function<void(int testIndex)>& setUpTest,
+        const std::function<trj::String(int testIndex, float averageTime)>& getTestResult,
+        const std::function<double()>& getTestTime)
+{
+    auto& resultsNode = trj::Node::getRootNode().addChild(trj::TextNode::create());
+    resultsNode.setFontSize(50);
+    resultsNode.setHorizontalAlignment(trj::TextNode::HorizontalAlignment::CENTER);
+
+    const int numFramesPerTest = 200;
+    trj::String results;
+    int testIndex = 0;
+    int numFrames = 0;
+    double testTime = 0;
+
+    setUpTest(testIndex);
+
+    while(true)
+    {
+        double time = trj::Application::getElapsedTime();
+        trj::Application::update();
+        testTime += getTestTime ? getTestTime() : trj::Application::getElapsedTime() - time;
+        ++numFrames;
+
+        if(testIndex < numTests && numFrames == numFramesPerTest)
+        {
+            float averageTime = (testTime * 1000) / numFrames;
+            results += getTestResult(testIndex, averageTime) + "   ";
+            resultsNode.setTexts({ trj::TextNode::Text(0, 0, results) });
+
+            ++testIndex;
+            numFrames = 0;
+            testTime = 0;
+
+            if(testIndex < numTests)
+            {
+                setUpTest(testIndex);
+            }
+        }
+
+        checkEscapeKey();
+    }
+}
+
 void Test::setTitle(trj::String title)
 {
     auto titleNode = trj::TextNode::create();
@@ -0,0 +1,87 @@
+//
+// Copyright (c) 2015 Gustavo Valiente gustavovalient@gmail.com
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+//
+
+#ifndef TRJ_ATLAS_PACKER_H
+#define TRJ_ATLAS_PACKER_H
+
+#include <vector>
+
+namespace trj
+{
+
+namespace priv
+{
+
+// Skyline bottom-left rectangle packer: each rect is placed where its top is the lowest.
+class AtlasPacker
+{
+
+protected:
+    struct Segment
+    {
+        int x;
+        int y;
+        int width;
+    };
+
+    std::vector<Segment> mSegments;
+    int mWidth;
+    int mHeight;
+    int mUsedArea = 0;
+
+    bool fit(int index, int width, int height, int& y) const;
+
+    void addSegment(int index, int x, int y, int width);
+
+public:
+    AtlasPacker(int width, int height);
+
+    int getWidth() const noexcept
+    {
+        return mWidth;
+    }
+
+    int getHeight() const noexcept
+    {
+        return mHeight;
+    }
+
+    // Area of the inserted rects:
+    int getUsedArea() const noexcept
+    {
+        return mUsedArea;
+    }
+
+    // Area below the skyline, including the gaps between the inserted rects:
+    int getCoveredArea() const noexcept;
+
+    bool insert(int width, int height, int& x, int& y);
+
+    void remove(int width, int height) noexcept
+    {
+        mUsedArea -= width * height;
+    }
+
+    void clear();
+};
+
+}
+
+}
+
+#endif
@@ -19,9 +19,15 @@
 #ifndef TRJ_DISPLAY_LIST_MANAGER_H
 #define TRJ_DISPLAY_LIST_MANAGER_H
 
+#include <array>
+#include <cstdint>
 #include <vector>
-#include "trjcommon.h"
+#include <unordered_map>
+#include "trjstring.h"
+#include "trjrendercachestats.h"
+#include "private/trjhash.h"
 
+struct NVGcontext;
 struct NVGdisplayList;
 
 namespace trj
@@ -32,19 +38,63 @@ class Application;
 namespace priv
 {
 
+struct RenderCache
+{
+    NVGdisplayList* displayList = nullptr;
+    std::uint64_t key = 0;
+    std::uint64_t keyCheck = 0;
+    std::size_t numBytes = 0;
+    std::size_t numRecordedBytes = 0;
+    long lastFrame = 0;
+    float scaleX = 0;
+    float scaleY = 0;
+    std::vector<unsigned int> atlasPageGenerations;
+    int numReferences = 1;
+    bool recorded = false;
+};
+
 class DisplayListManager
 {
     friend class trj::Application;
 
 protected:
+    // Free display lists are pooled by the power of two of their size in bytes:
+    static constexpr int smNumSizeClasses = 32;
+
+    // Most nodes record a few commands, bigger display lists grow while they are recorded:
+    static constexpr int smInitialNumCommands = 4;
+
     static DisplayListManager* smInstance;
 
-    std::vector<NVGdisplayList*> mDisplayLists;
+    std::vector<RenderCache*> mRenderCaches;
+    std::vector<RenderCache*> mFreeRenderCaches;
+    std::array<std::vector<NVGdisplayList*>, smNumSizeClasses> mDisplayListPools;
+    std::unordered_map<std::uint64_t, RenderCache*> mSharedRenderCaches;
+    String mFolderPath;
+    std::size_t mBudget;
+    std::size_t mNumBytes = 0;
+    std::size_t mNumPooledBytes = 0;
+    long mFrame = 0;
+    int mEvictionFrames;
+    int mNumDraws = 0;
+    int mNumRecords = 0;
+    int mNumEvictions = 0;
+    int mNumLoads = 0;
+    RenderCacheStats mStats;
 
-    DisplayListManager() noexcept
-    {
-        smInstance = this;
-    }
+    DisplayListManager(std::size_t budget, int evictionFrames, const String& folderPath);
+
+    void update();
+
+    void trimPools();
+
+    void evictIdleRenderCaches();
+
+    void release(RenderCache& renderCache);
+
+    String getFilePath(const RenderCache& renderCache) const;
+
+    void save(NVGcontext& nanoVgContext, const RenderCache& renderCache) const;
 
 public:
     DisplayListManager(const DisplayListManager& other) = delete;
@@ -53,10 +103,69 @@ public:
     ~DisplayListManager();
 
     #ifdef TRJ_CFG_ENABLE_RENDER_CACHE
-        static NVGdisplayList& pull();
+        static RenderCache& pull();
+
+        static void push(RenderCache& renderCache);
+
+        static void share(RenderCache& renderCache) noexcept
+        {
+            ++renderCache.numReferences;
+        }
+
+        // Returns an empty key if a scale is zero or not finite:
+        static Hash getKey(const Hash& contentHash, float scaleX, float scaleY) noexcept;
+
+        // Returns nullptr if the shared render cache with the same key has another key check:
+        static RenderCache* find(const Hash& key);
+
+        static void insert(RenderCache& renderCache, const Hash& key);
+
+        // Returns true if the render cache must be recorded again. Outdated render caches aren't shared:
+        static bool isOutdated(NVGcontext& nanoVgContext, RenderCache& renderCache);
 
-        static void push(NVGdisplayList& displayList);
+        // Resets the display list of the render cache, or pulls one from the pools with the size of the
+        // last record if it has been evicted:
+        static void reset(RenderCache& renderCache);
+
+        // Updates the render cache size after it has been recorded, and writes it to the render cache folder
+        // if it has a key:
+        static void recorded(NVGcontext& nanoVgContext, RenderCache& renderCache);
+
+        // Reads the display list of a render cache with key from the render cache folder.
+        // Returns false if it has not been written yet or if it can't be read:
+        static bool load(NVGcontext& nanoVgContext, RenderCache& renderCache);
+
+        static void drawn(RenderCache& renderCache) noexcept
+        {
+            renderCache.lastFrame = smInstance->mFrame;
+            ++smInstance->mNumDraws;
+        }
     #endif
+
+    static std::size_t getBudget() noexcept
+    {
+        return smInstance->mBudget;
+    }
+
+    static void setBudget(std::size_t budget) noexcept
+    {
+        smInstance->mBudget = budget;
+    }
+
+    static int getEvictionFrames() noexcept
+    {
+        return smInstance->mEvictionFrames;
+    }
+
+    static void setEvictionFrames(int evictionFrames) noexcept
+    {
+        smInstance->mEvictionFrames = evictionFrames;
+    }
+
+    static const RenderCacheStats& getStats() noexcept
+    {
+        return smInstance->mStats;
+    }
 };
 
 }
@@ -0,0 +1,93 @@
+//
+// Copyright (c) 2015 Gustavo Valiente gustavovalient@gmail.com
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+//
+
+#ifndef TRJ_HASH_H
+#define TRJ_HASH_H
+
+#include <cstdint>
+#include <functional>
+#include "trjrect.h"
+#include "trjcolor.h"
+#include "trjstring.h"
+
+namespace trj
+{
+
+namespace priv
+{
+    // 64 bit hashes on every target. The check half is combined with another function, so values that
+    // collide in the value half are told apart:
+    struct Hash
+    {
+        std::uint64_t value = 0;
+        std::uint64_t check = 0;
+    };
+
+    inline void hashCombine(Hash& hash, std::uint64_t value) noexcept
+    {
+        hash.value ^= value + 0x9e3779b97f4a7c15 + (hash.value << 6) + (hash.value >> 2);
+        hash.check = (hash.check ^ value) * 0x100000001b3;
+    }
+
+    template<typename Type>
+    void hashCombine(Hash& hash, const Type& value) noexcept
+    {
+        hashCombine(hash, static_cast<std::uint64_t>(std::hash<Type>()(value)));
+    }
+
+    inline void hashCombine(Hash& hash, const Hash& other) noexcept
+    {
+        hashCombine(hash, other.value);
+        hash.check = (hash.check ^ other.check) * 0x100000001b3;
+    }
+
+    inline void hashCombine(Hash& hash, const Point& point) noexcept
+    {
+        hashCombine(hash, point.getX());
+        hashCombine(hash, point.getY());
+    }
+
+    inline void hashCombine(Hash& hash, const Rect& rect) noexcept
+    {
+        hashCombine(hash, rect.getX());
+        hashCombine(hash, rect.getY());
+        hashCombine(hash, rect.getWidth());
+        hashCombine(hash, rect.getHeight());
+    }
+
+    inline void hashCombine(Hash& hash, const Color& color) noexcept
+    {
+        hashCombine(hash, color.getRed());
+        hashCombine(hash, color.getGreen());
+        hashCombine(hash, color.getBlue());
+        hashCombine(hash, color.getAlpha());
+    }
+
+    inline void hashCombine(Hash& hash, const String& string) noexcept
+    {
+        const char* charArray = string.getCharArray();
+        for(int index = 0, size = string.getSize(); index < size; ++index)
+        {
+            hashCombine(hash, charArray[index]);
+        }
+    }
+}
+
+}
+
+#endif
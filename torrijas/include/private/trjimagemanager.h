@@ -19,20 +19,37 @@
 #ifndef TRJ_IMAGE_MANAGER_H
 #define TRJ_IMAGE_MANAGER_H
 
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 #include "trjcommon.h"
+#include "trjstring.h"
+#include "trjptr.h"
+#include "trjimagedata.h"
+#include "private/trjatlaspacker.h"
 
 namespace trj
 {
 
 class Node;
 class Color;
-class ImageData;
+class Rect;
 class Application;
 
 namespace priv
 {
 
+// Images loaded asynchronously get their texture when they are added, with the size read from the file
+// header. Their files are decoded in other threads, and the decoded rows are uploaded in the next frames
+// without exceeding an upload budget per frame.
+//
+// In atlas mode, small images without mipmaps are packed in shared textures (pages) and get negative handles.
+// Atlas images are only drawn inside their own rect, so they aren't repeated: images used by image pattern
+// pens are moved out of the atlas to their own texture. Pages whose images are mostly released are repacked
+// in the next update, so the textures and rects of atlas images must be queried when they are drawn.
 class ImageManager
 {
     friend class trj::Application;
@@ -40,16 +57,76 @@ class ImageManager
 protected:
     static ImageManager* smInstance;
 
+    // Atlas pages are square, and images are packed with a border of duplicated edge pixels:
+    static constexpr int smPageSize = 1024;
+    static constexpr int smMaxAtlasImageSize = 256;
+    static constexpr int smAtlasBorder = 1;
+
+    struct Page
+    {
+        AtlasPacker packer;
+        std::vector<unsigned char> pixels;
+        int texture;
+        int flags;
+        unsigned int generation;
+        bool fragmented;
+    };
+
     struct Entry
     {
         void* frameBuffer;
+        int texture;
+        int flags;
         int count;
+        bool loaded;
+        bool loadFailed;
+        Page* page;
+        int x;
+        int y;
+        int width;
+        int height;
+    };
+
+    struct Load
+    {
+        int image;
+        String filePath;
+        Ptr<ImageData> imageData;
+        int uploadedRows;
     };
 
     std::unordered_map<int, Entry> mEntries;
+    std::vector<Ptr<Page>> mPages;
+    std::deque<Load> mPendingLoads;
+    std::deque<Load> mDecodedLoads;
+    std::deque<Load> mUploads;
+    std::vector<std::thread> mThreads;
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    std::size_t mUploadBudget = 4 * 1024 * 1024;
+    int mNumThreads = 2;
+    int mNextAtlasImage = -1;
+    unsigned int mAtlasGeneration = 0;
+    bool mAtlasEnabled = false;
+    bool mExit = false;
 
     ImageManager();
 
+    int addAtlasImage(const unsigned char* data, int width, int height, int flags);
+
+    bool insertAtlasImage(Page& page, const unsigned char* data, int width, int height, int stride,
+            int& x, int& y);
+
+    void removeAtlasImage(Entry& entry);
+
+    void moveAtlasImageOut(Entry& entry);
+
+    void repackPage(Page& page);
+
+    void runThread();
+
+    void stopThreads() noexcept;
+
 public:
     ImageManager(const ImageManager& other) = delete;
     ImageManager& operator=(const ImageManager& other) = delete;
@@ -62,8 +139,48 @@ public:
 
     static int addImage(Node& node, int width, int height, const Color& backgroundColor, int flags);
 
+    static int addImageAsync(const String& filePath, int flags);
+
+    static bool isImageLoaded(int image);
+
+    static bool isImageLoadFailed(int image);
+
+    static void getImageSize(int image, int& width, int& height);
+
+    // Returns the texture of the given image, and sets textureRect to the rect in which the whole texture
+    // must be drawn (rotated by angle around its origin) so the image is drawn in rect:
+    static int getTexture(int image, const Rect& rect, float angle, Rect& textureRect);
+
+    static bool isAtlasEnabled() noexcept;
+
+    // Only the images added after enabling it are packed:
+    static void setAtlasEnabled(bool enabled) noexcept;
+
+    // Until endRecord is called, the generations of the atlas pages drawn in the current thread are added to
+    // atlasPageGenerations. Pages get a new generation each time their images are moved:
+    static void beginRecord(std::vector<unsigned int>& atlasPageGenerations) noexcept;
+
+    static void endRecord() noexcept;
+
+    // Returns true if any of the given atlas pages has been repacked or deleted since it was drawn:
+    static bool isAtlasOutdated(const std::vector<unsigned int>& atlasPageGenerations) noexcept;
+
+    // Uploads the decoded rows of the images loaded asynchronously and repacks the fragmented pages:
+    static void update();
+
+    static int getNumThreads() noexcept;
+
+    static void setNumThreads(int numThreads);
+
+    static std::size_t getUploadBudget() noexcept;
+
+    static void setUploadBudget(std::size_t uploadBudget);
+
     static void addImageRef(int image);
 
+    // Adds a reference of an image pattern, which can repeat the image, so it is moved out of the atlas:
+    static void addPatternImageRef(int image);
+
     static void removeImageRef(int image);
 };
 
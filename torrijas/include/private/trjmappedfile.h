@@ -0,0 +1,75 @@
+//
+// Copyright (c) 2015 Gustavo Valiente gustavovalient@gmail.com
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+//
+
+#ifndef TRJ_MAPPED_FILE_H
+#define TRJ_MAPPED_FILE_H
+
+#include <cstddef>
+#include "trjcommon.h"
+
+namespace trj
+{
+
+class String;
+
+namespace priv
+{
+
+// Read only memory map of a file:
+class MappedFile
+{
+
+protected:
+    const unsigned char* mData = nullptr;
+    std::size_t mSize = 0;
+
+    #ifdef _WIN32
+        void* mFileHandle = nullptr;
+        void* mMappingHandle = nullptr;
+    #endif
+
+public:
+    // If the file can't be mapped, the mapped file is empty:
+    explicit MappedFile(const String& path);
+
+    MappedFile(const MappedFile& other) = delete;
+    MappedFile& operator=(const MappedFile& other) = delete;
+
+    ~MappedFile();
+
+    bool isEmpty() const noexcept
+    {
+        return ! mData;
+    }
+
+    const unsigned char* getData() const noexcept
+    {
+        return mData;
+    }
+
+    std::size_t getSize() const noexcept
+    {
+        return mSize;
+    }
+};
+
+}
+
+}
+
+#endif
@@ -0,0 +1,136 @@
+//
+// Copyright (c) 2015 Gustavo Valiente gustavovalient@gmail.com
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+//
+
+#ifndef TRJ_NODE_UPDATE_MANAGER_H
+#define TRJ_NODE_UPDATE_MANAGER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "trjptr.h"
+
+namespace trj
+{
+
+class Node;
+class Application;
+
+namespace priv
+{
+
+class SpatialIndex;
+
+// The registered nodes are updated in registration order. With more than one thread, long runs
+// of nodes without callback actions or per frame updates are updated in parallel, and the
+// invalidations that touch other nodes are deferred to a serial commit after each run, so the
+// results match the single thread update. Actions must only modify the node they are run on.
+class NodeUpdateManager
+{
+    friend class trj::Application;
+
+protected:
+    static NodeUpdateManager* smInstance;
+
+    struct DirtySpatialIndexItem
+    {
+        SpatialIndex* spatialIndex;
+        Node* node;
+    };
+
+    struct Chunk
+    {
+        std::vector<int> committedNodes;
+        std::vector<DirtySpatialIndexItem> dirtySpatialIndexItems;
+        std::vector<Node*> invalidatedParents;
+        std::vector<Node*> invalidatedNodes;
+    };
+
+    struct Worker
+    {
+        std::atomic<int> nextChunk;
+        int endChunk;
+    };
+
+    std::vector<Node*> mNodes;
+    std::vector<Chunk> mChunks;
+    std::vector<Ptr<Worker>> mWorkers;
+    std::vector<std::thread> mThreads;
+    std::mutex mMutex;
+    std::condition_variable mStartCondition;
+    std::condition_variable mEndCondition;
+    const Node* mRootNode = nullptr;
+    float mElapsedTime = 0;
+    int mNumRemovedNodes = 0;
+    int mFirstNode = 0;
+    int mEndNode = 0;
+    int mNumChunks = 0;
+    int mNumPendingThreads = 0;
+    unsigned int mPhase = 0;
+    bool mExit = false;
+
+    NodeUpdateManager() noexcept
+    {
+        smInstance = this;
+    }
+
+    bool getActionsState(const Node& node, float& actionsSpeed, bool& actionsPaused) const noexcept;
+
+    bool isParallelUpdate(const Node* node) const noexcept;
+
+    void updateNode(int nodeIndex);
+
+    void updateNodesInParallel(int firstNode, int endNode);
+
+    void runWorker(int workerIndex);
+
+    void runChunk(int chunkIndex);
+
+    void commitChunkInvalidations(Chunk& chunk);
+
+    void commitChunkNodes(Chunk& chunk);
+
+    void runThread(int workerIndex, unsigned int phase);
+
+    void stopThreads() noexcept;
+
+    void removeEmptyEntries() noexcept;
+
+public:
+    NodeUpdateManager(const NodeUpdateManager& other) = delete;
+    NodeUpdateManager& operator=(const NodeUpdateManager& other) = delete;
+
+    ~NodeUpdateManager();
+
+    static void addNode(Node& node);
+
+    static void removeNode(Node& node) noexcept;
+
+    static void updateNodes(const Node& rootNode, float elapsedTime);
+
+    static int getNumThreads() noexcept;
+
+    static void setNumThreads(int numThreads);
+};
+
+}
+
+}
+
+#endif
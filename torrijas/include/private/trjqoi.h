@@ -0,0 +1,58 @@
+//
+// Copyright (c) 2015 Gustavo Valiente gustavovalient@gmail.com
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+//
+
+#ifndef TRJ_QOI_H
+#define TRJ_QOI_H
+
+#include <cstddef>
+#include <vector>
+
+namespace trj
+{
+
+class String;
+
+namespace priv
+{
+
+// QOI ("Quite OK Image") lossless format: a 14 bytes header followed by byte aligned chunks which reference
+// the previous pixel or a 64 entries table of recent ones. It's decoded and encoded in one linear pass.
+namespace qoi
+{
+    constexpr std::size_t headerSize = 14;
+
+    bool isQoi(const unsigned char* data, std::size_t size) noexcept;
+
+    // Reads the image size from the header:
+    bool getSize(const unsigned char* data, std::size_t size, int& width, int& height) noexcept;
+
+    // Reads the image size from the header of the given file:
+    bool getFileSize(const String& filePath, int& width, int& height);
+
+    // Returns RGBA pixels allocated with malloc, or nullptr if the data is invalid:
+    unsigned char* decode(const unsigned char* data, std::size_t size, int& width, int& height) noexcept;
+
+    // Replaces output with the encoded RGBA pixels:
+    void encode(const unsigned char* pixels, int width, int height, std::vector<unsigned char>& output);
+}
+
+}
+
+}
+
+#endif
@@ -0,0 +1,119 @@
+//
+// Copyright (c) 2015 Gustavo Valiente gustavovalient@gmail.com
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+//
+
+#ifndef TRJ_RENDER_CACHE_RECORDER_H
+#define TRJ_RENDER_CACHE_RECORDER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct NVGcontext;
+
+namespace trj
+{
+
+class Node;
+class RenderContext;
+class Application;
+
+namespace priv
+{
+
+struct Hash;
+struct RenderCache;
+
+// With more than one thread, the shareable render caches that the next render would record are recorded
+// before it in parallel, each thread with its own NanoVG recording context. The main thread only uploads
+// them and shares them by key, so the render finds them instead of recording them.
+class RenderCacheRecorder
+{
+    friend class trj::Application;
+
+protected:
+    static RenderCacheRecorder* smInstance;
+
+    struct Record
+    {
+        Node* node;
+        RenderCache* renderCache;
+    };
+
+    std::vector<Record> mRecords;
+    std::vector<RenderCache*> mRenderCaches;
+    std::vector<NVGcontext*> mRecordingContexts;
+    std::vector<std::thread> mThreads;
+    std::atomic<int> mNextRecord;
+    std::mutex mMutex;
+    std::condition_variable mStartCondition;
+    std::condition_variable mEndCondition;
+    int mNumThreads = 1;
+    int mWindowWidth = 0;
+    int mWindowHeight = 0;
+    int mNumPendingThreads = 0;
+    unsigned int mPhase = 0;
+    bool mExit = false;
+
+    RenderCacheRecorder() noexcept :
+        mNextRecord(0)
+    {
+        smInstance = this;
+    }
+
+    #ifdef TRJ_CFG_ENABLE_RENDER_CACHE
+        void collect(Node& node, RenderContext& renderContext, bool renderOffScreen);
+
+        void addRecord(Node& node, NVGcontext& nanoVgContext, const Hash& key, float scaleX, float scaleY);
+    #endif
+
+    void recordInParallel();
+
+    void runWorker(int workerIndex);
+
+    void runThread(int workerIndex, unsigned int phase);
+
+    void stopThreads() noexcept;
+
+    void deleteRecordingContexts() noexcept;
+
+public:
+    RenderCacheRecorder(const RenderCacheRecorder& other) = delete;
+    RenderCacheRecorder& operator=(const RenderCacheRecorder& other) = delete;
+
+    ~RenderCacheRecorder();
+
+    #ifdef TRJ_CFG_ENABLE_RENDER_CACHE
+        // Records the render caches before rendering rootNode with renderContext:
+        static void record(Node& rootNode, RenderContext& renderContext, float devicePixelRatio);
+
+        // Releases the render caches not taken by any node once rendering is done:
+        static void release();
+    #endif
+
+    static int getNumThreads() noexcept;
+
+    static void setNumThreads(int numThreads);
+};
+
+}
+
+}
+
+#endif
@@ -0,0 +1,169 @@
+//
+// Copyright (c) 2015 Gustavo Valiente gustavovalient@gmail.com
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+//
+
+#ifndef TRJ_SPATIAL_INDEX_H
+#define TRJ_SPATIAL_INDEX_H
+
+#include <vector>
+#include "trjcommon.h"
+
+namespace trj
+{
+
+class Node;
+class Rect;
+
+namespace priv
+{
+
+// Loose quadtree of the children of a node, indexed by their bounds in the parent space.
+// Each cell also keeps the tight bounds of its items and children, which are updated lazily along the
+// path of the cells whose items have changed.
+class SpatialIndex
+{
+
+protected:
+    struct Cell
+    {
+        float x;
+        float y;
+        float size;
+        int parent;
+        int children[4];
+        std::vector<int> items;
+        float minX;
+        float minY;
+        float maxX;
+        float maxY;
+        bool boundsDirty;
+    };
+
+    struct Item
+    {
+        Node* node;
+        float minX;
+        float minY;
+        float maxX;
+        float maxY;
+        int order;
+        int cell;
+        int slot;
+    };
+
+    static const int kNoCell = -1;
+    static const int kUnboundedCell = -2;
+    static const int kMaxDepth = 16;
+
+    std::vector<Cell> mCells;
+    std::vector<Item> mItems;
+    std::vector<int> mFreeItems;
+    std::vector<int> mUnboundedItems;
+    std::vector<Node*> mDirtyNodes;
+    std::vector<std::pair<int, Node*>> mQueryItems;
+    std::vector<Node*> mQueryNodes;
+    std::vector<int> mQueryCells;
+    int mRootCell = kNoCell;
+    unsigned int mStamp = 1;
+    float mAspectRatio = 0;
+
+    int addCell(float x, float y, float size);
+
+    void growRoot(float centerX, float centerY, float extent);
+
+    void link(int item);
+
+    void unlink(int item) noexcept;
+
+    void invalidateBounds(int cell) noexcept;
+
+    void updateBounds(int cell) noexcept;
+
+public:
+    SpatialIndex() = default;
+
+    SpatialIndex(const SpatialIndex& other) = delete;
+    SpatialIndex& operator=(const SpatialIndex& other) = delete;
+
+    int add(Node& node, int order);
+
+    void remove(int item) noexcept;
+
+    void setBounds(int item, const Rect& bounds);
+
+    void setUnbounded(int item);
+
+    void setOrder(int item, int order) noexcept
+    {
+        mItems[item].order = order;
+    }
+
+    void clear() noexcept;
+
+    const std::vector<Node*>& query(const Rect& rect);
+
+    // Returns false if there are unbounded items:
+    bool getBounds(Rect& bounds);
+
+    int getNumItems() const noexcept
+    {
+        return mItems.size() - mFreeItems.size();
+    }
+
+    const std::vector<Node*>& getDirtyNodes() const noexcept
+    {
+        return mDirtyNodes;
+    }
+
+    void addDirtyNode(Node& node)
+    {
+        mDirtyNodes.push_back(&node);
+    }
+
+    void removeDirtyNode(Node& node) noexcept;
+
+    void clearDirtyNodes() noexcept
+    {
+        mDirtyNodes.clear();
+    }
+
+    unsigned int getStamp() const noexcept
+    {
+        return mStamp;
+    }
+
+    void increaseStamp() noexcept
+    {
+        ++mStamp;
+    }
+
+    float getAspectRatio() const noexcept
+    {
+        return mAspectRatio;
+    }
+
+    void setAspectRatio(float aspectRatio) noexcept
+    {
+        mAspectRatio = aspectRatio;
+    }
+};
+
+}
+
+}
+
+#endif
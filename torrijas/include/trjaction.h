@@ -35,6 +35,8 @@ class Action
     friend class SequenceAction;
 
 protected:
+    bool mCallBacks = false;
+
     static bool checkElapsedTime(float& elapsedTime, float& durationLeft);
 
     Action() = default;
@@ -50,6 +52,12 @@ public:
     virtual Ptr<Action> getClone() const = 0;
 
     virtual Ptr<Action> getReversed() const = 0;
+
+    // Actions with callbacks can modify other nodes, so they are always run in registration order:
+    bool hasCallBacks() const noexcept
+    {
+        return mCallBacks;
+    }
 };
 
 }
@@ -19,6 +19,7 @@
 #ifndef TRJ_APPLICATION_H
 #define TRJ_APPLICATION_H
 
+#include <cstddef>
 #include "trjcommon.h"
 
 struct NVGcontext;
@@ -32,6 +33,8 @@ class Size;
 class Rect;
 class Color;
 class ImageData;
+class RenderStats;
+class RenderCacheStats;
 class ImageManager;
 class ApplicationConfig;
 
@@ -108,10 +111,34 @@ public:
 
     static float getFrameTime() noexcept;
 
+    // Time spent updating the nodes in the last frame:
+    static float getUpdateTime() noexcept;
+
     static float getFpsLimit() noexcept;
 
     static void setFpsLimit(float fpsLimit) noexcept;
 
+    static int getNumUpdateThreads() noexcept;
+
+    static void setNumUpdateThreads(int numThreads);
+
+    static int getNumRenderCacheThreads() noexcept;
+
+    static void setNumRenderCacheThreads(int numThreads);
+
+    static int getNumImageLoadThreads() noexcept;
+
+    static void setNumImageLoadThreads(int numThreads);
+
+    static std::size_t getImageUploadBudget() noexcept;
+
+    static void setImageUploadBudget(std::size_t budget);
+
+    static bool isImageAtlasEnabled() noexcept;
+
+    // Only the images built after enabling it are packed:
+    static void setImageAtlasEnabled(bool enabled) noexcept;
+
     static bool isClosed();
 
     static void setClosed(bool closed);
@@ -120,11 +147,34 @@ public:
 
     static void setShowBoundingBoxes(bool show) noexcept;
 
+    static bool isHeadless() noexcept;
+
+    static bool isStreamingBuffersEnabled() noexcept;
+
+    // Only supported with TRJ_CFG_GL3:
+    static void setStreamingBuffersEnabled(bool enabled) noexcept;
+
+    static RenderStats getRenderStats() noexcept;
+
+    static std::size_t getRenderCacheBudget() noexcept;
+
+    static void setRenderCacheBudget(std::size_t budget) noexcept;
+
+    static int getRenderCacheEvictionFrames() noexcept;
+
+    static void setRenderCacheEvictionFrames(int evictionFrames);
+
+    // Render caches memory and usage in the last frame:
+    static RenderCacheStats getRenderCacheStats() noexcept;
+
     static NVGcontext& getNanoVgContext() noexcept;
 
     static void update();
 
     static void update(float seconds);
+
+    // Updates the node actions and per frame updates with the given frame time, without rendering a frame:
+    static void updateNodes(float frameTime);
 };
 
 }
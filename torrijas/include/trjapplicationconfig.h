@@ -19,6 +19,7 @@
 #ifndef TRJ_APPLICATION_CONFIG_H
 #define TRJ_APPLICATION_CONFIG_H
 
+#include <cstddef>
 #include "trjstring.h"
 
 namespace trj
@@ -31,12 +32,22 @@ protected:
     String mWindowTitle = String("Torrijas");
     String mDefaultFontName = String("sans");
     String mDefaultFontFilePath = String("../../torrijas/fonts/Roboto-Regular.ttf");
+    String mRenderCacheFolderPath;
     int mScreenWidth = 1280;
     int mScreenHeight = 720;
     float mLogicalScreenHeight = 1000;
+    std::size_t mRenderCacheBudget = 64 * 1024 * 1024;
+    int mRenderCacheEvictionFrames = 60;
+    int mNumUpdateThreads = 1;
+    int mNumRenderCacheThreads = 1;
+    int mNumImageLoadThreads = 2;
+    std::size_t mImageUploadBudget = 4 * 1024 * 1024;
     bool mFullScreen = false;
     bool mVSync = true;
     bool mAntialias = true;
+    bool mHeadless = false;
+    bool mStreamingBuffers = true;
+    bool mImageAtlas = false;
 
 public:
     const String& getWindowTitle() const noexcept
@@ -99,6 +110,97 @@ public:
         mLogicalScreenHeight = logicalScreenHeight;
     }
 
+    std::size_t getRenderCacheBudget() const noexcept
+    {
+        return mRenderCacheBudget;
+    }
+
+    // Max number of bytes used by render caches. When it is exceeded, the render caches of the nodes
+    // which have not been drawn for the last render cache eviction frames are released:
+    void setRenderCacheBudget(std::size_t renderCacheBudget) noexcept
+    {
+        mRenderCacheBudget = renderCacheBudget;
+    }
+
+    int getRenderCacheEvictionFrames() const noexcept
+    {
+        return mRenderCacheEvictionFrames;
+    }
+
+    void setRenderCacheEvictionFrames(int renderCacheEvictionFrames) noexcept
+    {
+        mRenderCacheEvictionFrames = renderCacheEvictionFrames;
+    }
+
+    const String& getRenderCacheFolderPath() const noexcept
+    {
+        return mRenderCacheFolderPath;
+    }
+
+    // Folder in which recorded render caches are written, so they can be read instead of recorded again
+    // in later runs. They aren't written if it is empty:
+    void setRenderCacheFolderPath(String renderCacheFolderPath) noexcept
+    {
+        mRenderCacheFolderPath = std::move(renderCacheFolderPath);
+    }
+
+    int getNumUpdateThreads() const noexcept
+    {
+        return mNumUpdateThreads;
+    }
+
+    void setNumUpdateThreads(int numUpdateThreads) noexcept
+    {
+        mNumUpdateThreads = numUpdateThreads;
+    }
+
+    int getNumRenderCacheThreads() const noexcept
+    {
+        return mNumRenderCacheThreads;
+    }
+
+    // With more than one thread, the missing render caches of the visible nodes are recorded in parallel
+    // before rendering. Otherwise they are recorded while rendering:
+    void setNumRenderCacheThreads(int numRenderCacheThreads) noexcept
+    {
+        mNumRenderCacheThreads = numRenderCacheThreads;
+    }
+
+    int getNumImageLoadThreads() const noexcept
+    {
+        return mNumImageLoadThreads;
+    }
+
+    // Threads in which the images loaded with Image::loadAsync are decoded:
+    void setNumImageLoadThreads(int numImageLoadThreads) noexcept
+    {
+        mNumImageLoadThreads = numImageLoadThreads;
+    }
+
+    std::size_t getImageUploadBudget() const noexcept
+    {
+        return mImageUploadBudget;
+    }
+
+    // Max bytes of the images loaded with Image::loadAsync uploaded per frame:
+    void setImageUploadBudget(std::size_t imageUploadBudget) noexcept
+    {
+        mImageUploadBudget = imageUploadBudget;
+    }
+
+    bool isImageAtlasEnabled() const noexcept
+    {
+        return mImageAtlas;
+    }
+
+    // Small images without mipmaps or flipping are packed in shared textures, so nodes drawing different
+    // images can be batched. Images used by image pattern pens are moved to their own texture, since
+    // they can be repeated:
+    void setImageAtlasEnabled(bool imageAtlas) noexcept
+    {
+        mImageAtlas = imageAtlas;
+    }
+
     bool isFullScreenEnabled() const noexcept
     {
         return mFullScreen;
@@ -128,6 +230,28 @@ public:
     {
         mAntialias = antialias;
     }
+
+    bool isHeadlessEnabled() const noexcept
+    {
+        return mHeadless;
+    }
+
+    void setHeadlessEnabled(bool headless) noexcept
+    {
+        mHeadless = headless;
+    }
+
+    bool isStreamingBuffersEnabled() const noexcept
+    {
+        return mStreamingBuffers;
+    }
+
+    // Streams vertices and uniforms to the GPU through fenced ring buffers instead of re-specifying
+    // them each frame. It is only used with TRJ_CFG_GL3:
+    void setStreamingBuffersEnabled(bool streamingBuffers) noexcept
+    {
+        mStreamingBuffers = streamingBuffers;
+    }
 };
 
 }
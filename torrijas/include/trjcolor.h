@@ -45,6 +45,9 @@ public:
     static std::pair<Color, float> getBlendResult(
             const std::vector<std::pair<Color, float>>& blendColors) noexcept;
 
+    static std::pair<Color, float> getBlendTint(
+            const std::vector<std::pair<Color, float>>& blendColors) noexcept;
+
     Color() noexcept :
         Color(0, 0, 0, 1)
     {
@@ -33,10 +33,15 @@
 
     #define TRJ_ERROR(message) \
         TRJ_ASSERT(false, message)
+
+    #define TRJ_WARNING(message) \
+        trj::Debug::createException(__FILE__, __LINE__, message)
 #else
     #define TRJ_ASSERT(condition, message)
 
     #define TRJ_ERROR(message)
+
+    #define TRJ_WARNING(message)
 #endif
 
 namespace trj
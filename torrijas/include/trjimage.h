@@ -39,6 +39,8 @@ protected:
     int mWidth = 0;
     int mHeight = 0;
 
+    explicit Image(int handle);
+
     void initSize();
 
 public:
@@ -55,6 +57,13 @@ public:
 
     static void getSize(NVGcontext& nanoVgContext, int imageHandle, int& imageWidth, int& imageHeight);
 
+    // Returns an image with the size of the given file, which is decoded in other threads and uploaded
+    // in the next frames. Its pixels shouldn't be drawn until it is loaded. If the file can't be decoded,
+    // the image is never loaded and isLoadFailed returns true:
+    static Image loadAsync(const String& filePath, int flags = REPEAT_X | REPEAT_Y);
+
+    static Image loadAsync(const File& file, int flags = REPEAT_X | REPEAT_Y);
+
     Image(const ImageData& imageData, int flags = REPEAT_X | REPEAT_Y);
 
     Image(const String& filePath, int flags = REPEAT_X | REPEAT_Y);
@@ -98,6 +107,10 @@ public:
     {
         return mHeight;
     }
+
+    bool isLoaded() const;
+
+    bool isLoadFailed() const;
 };
 
 }
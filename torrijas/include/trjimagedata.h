@@ -35,7 +35,8 @@ public:
     {
         PNG,
         BMP,
-        TGA
+        TGA,
+        QOI // Lossless, and much faster to decode and encode than PNG.
     };
 
 protected:
@@ -50,6 +51,7 @@ public:
 
     ImageData(const unsigned char* data, int width, int height);
 
+    // QOI files are detected by their header, the other formats are decoded with stb_image:
     ImageData(const String& filePath);
 
     ImageData(const File& file);
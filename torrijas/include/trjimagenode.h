@@ -46,6 +46,14 @@ protected:
 
     Rect generateBoundingBox() override;
 
+    bool renderCacheAvailable(const RenderContext& renderContext) const override;
+
+    bool renderCacheBlendable() const override;
+
+    bool renderCacheConcurrent() const override;
+
+    priv::Hash generateRenderCacheHash() const override;
+
     void renderItself(RenderContext& renderContext) override;
 
 public:
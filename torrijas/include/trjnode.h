@@ -19,19 +19,32 @@
 #ifndef TRJ_NODE_H
 #define TRJ_NODE_H
 
+#include <cstdint>
 #include "trjstring.h"
 #include "trjshapegroup.h"
 #include "trjaction.h"
 
+struct NVGcontext;
+
 namespace trj
 {
 
 class RenderContext;
 class Application;
 
+namespace priv
+{
+    class SpatialIndex;
+    class NodeUpdateManager;
+    class RenderCacheRecorder;
+    struct Hash;
+}
+
 class Node
 {
     friend class Application;
+    friend class priv::NodeUpdateManager;
+    friend class priv::RenderCacheRecorder;
 
 protected:
     Point mPosition;
@@ -39,9 +52,17 @@ protected:
     Rect mScissorRect;
     Rect mBoundingBox;
     Rect mFinalBoundingBox;
+    Rect mSubtreeBoundingBox;
     String mTag;
     Node* mParent = nullptr;
     void* mRenderCache = nullptr;
+    std::uint64_t mRenderCacheHash = 0;
+    std::uint64_t mRenderCacheCheckHash = 0;
+    std::array<void*, 2> mLodRenderCaches = {{ nullptr, nullptr }};
+    priv::SpatialIndex* mSpatialIndex = nullptr;
+    int mSpatialIndexItem = -1;
+    unsigned int mSpatialIndexStamp = 0;
+    int mUpdateIndex = -1;
     float mRotationAngle = 0;
     float mSkewXAngle = 0;
     float mSkewYAngle = 0;
@@ -50,8 +71,11 @@ protected:
     float mOpacity = 1;
     float mBlendColorFactor = 0;
     float mActionsSpeed = 1;
-    float mFinalScaleX = 1;
-    float mFinalScaleY = 1;
+    float mRenderScaleX = 0;
+    float mRenderScaleY = 0;
+    float mSubtreeAspectRatio = 0;
+    float mWorldScaleX = 1;
+    float mWorldScaleY = 1;
     bool mVisible = true;
     bool mHidden = false;
     bool mMoveWithScreenWidth = false;
@@ -61,18 +85,29 @@ protected:
     bool mFlipY = false;
     bool mActionsRunning = false;
     bool mActionsPaused = false;
+    bool mUpdateEnabled = false;
     bool mRenderOffScreen = false;
+    bool mRenderInstanced = false;
     bool mInvalidateBoundingBox = false;
     bool mInvalidateRenderCache = false;
     bool mInvalidateTransform = true;
+    bool mInvalidateWorldTransform = true;
+    bool mInvalidateDescendantWorldTransforms = true;
     bool mInvalidateHidden = true;
     bool mIsOnScreen = false;
+    bool mSpatialIndexItemDirty = false;
+    bool mSubtreeUnbounded = false;
+    bool mInvalidateSubtreeBoundingBox = true;
+    bool mInvalidateFinalBoundingBoxes = false;
+    bool mInvalidationsDeferred = false;
+    bool mTransformInvalidationDeferred = false;
+    bool mBoundingBoxInvalidationDeferred = false;
 
     std::vector<ShapeGroup> mShapeGroups;
     std::vector<Ptr<Action>> mActions;
     std::vector<const Node*> mChildren;
     std::array<float, 6> mTransform;
-    std::array<float, 6> mFinalTransform;
+    std::array<float, 6> mWorldTransform;
 
     Node() noexcept
     {
@@ -82,10 +117,23 @@ protected:
 
     virtual Rect generateBoundingBox();
 
+    // Per frame update, called only if setUpdateEnabled(true) has been called. Nodes aren't updated
+    // by default, so subclasses that override it must enable it:
     virtual void updateItself(float elapsedTime);
 
     virtual bool renderCacheAvailable(const RenderContext& renderContext) const;
 
+    // Returns true if the render cache is tinted when it is drawn, so it can be shared by content.
+    // Only Node returns true: subclasses that render more than their shape groups share their render caches
+    // only if they override it and generateRenderCacheHash:
+    virtual bool renderCacheBlendable() const;
+
+    // Returns true if renderItself only uses the given render context, so the render cache can be recorded
+    // in other threads with their own NanoVG contexts. Only Node returns true, like renderCacheBlendable:
+    virtual bool renderCacheConcurrent() const;
+
+    virtual priv::Hash generateRenderCacheHash() const;
+
     virtual void renderItself(RenderContext& renderContext);
 
     void addActionImpl(Ptr<Action>&& action);
@@ -98,22 +146,120 @@ protected:
 
     void update(float elapsedTime, float actionsElapsedTime, bool actionsPaused);
 
+    void updateActions(float actionsElapsedTime, bool actionsPaused);
+
+    void commitUpdate(float elapsedTime);
+
+    void refreshUpdateEntry();
+
+    // In debug builds, warns once if updateItself is overridden but the updates are disabled:
+    void checkUpdateEnabled() noexcept;
+
     void render(RenderContext& renderContext);
 
+    void renderChildren(RenderContext& renderContext);
+
     void invalidateBoundingBox() noexcept
     {
         mInvalidateBoundingBox = true;
         invalidateRenderCache();
+
+        if(mInvalidationsDeferred)
+        {
+            mBoundingBoxInvalidationDeferred = true;
+        }
+        else
+        {
+            invalidateSubtreeBoundingBox();
+        }
     }
 
     void invalidateRenderCache() noexcept
     {
         mInvalidateRenderCache = true;
+        mRenderCacheHash = 0;
     }
 
     void invalidateTransform() noexcept
     {
         mInvalidateTransform = true;
+        mInvalidateWorldTransform = true;
+
+        if(mInvalidationsDeferred)
+        {
+            mTransformInvalidationDeferred = true;
+        }
+        else
+        {
+            invalidateSpatialIndexItem();
+
+            if(mParent)
+            {
+                mParent->invalidateSubtreeBoundingBox();
+                mParent->invalidateDescendantWorldTransforms();
+            }
+        }
+    }
+
+    void invalidateWorldTransform() noexcept
+    {
+        mInvalidateWorldTransform = true;
+
+        if(mParent)
+        {
+            mParent->invalidateDescendantWorldTransforms();
+        }
+    }
+
+    // Marks the path to the root, so the world transforms pass reaches the invalidated descendants:
+    void invalidateDescendantWorldTransforms() noexcept
+    {
+        for(Node* node = this; node && ! node->mInvalidateDescendantWorldTransforms; node = node->mParent)
+        {
+            node->mInvalidateDescendantWorldTransforms = true;
+        }
+    }
+
+    void invalidateSubtreeBoundingBox() noexcept
+    {
+        for(Node* node = this; node && ! node->mInvalidateSubtreeBoundingBox; node = node->mParent)
+        {
+            node->mInvalidateSubtreeBoundingBox = true;
+            node->invalidateSpatialIndexItem();
+        }
+    }
+
+    const Rect& getSubtreeBoundingBox(float aspectRatio);
+
+    bool isSubtreeOnScreen(RenderContext& renderContext, bool renderOffScreen);
+
+    void invalidateSpatialIndexItem() noexcept
+    {
+        if(mParent && mParent->mSpatialIndex && ! mSpatialIndexItemDirty)
+        {
+            addDirtySpatialIndexItem();
+        }
+    }
+
+    void addDirtySpatialIndexItem() noexcept;
+
+    void addSpatialIndexItem(Node& child, int order);
+
+    void removeSpatialIndexItem(Node& child) noexcept;
+
+    void updateSpatialIndex(float aspectRatio);
+
+    void generateTransform(float aspectRatio, float* transform) const noexcept;
+
+    const std::array<float, 6>& getTransform(float aspectRatio) noexcept
+    {
+        if(mInvalidateTransform)
+        {
+            generateTransform(aspectRatio, mTransform.data());
+            mInvalidateTransform = false;
+        }
+
+        return mTransform;
     }
 
     void invalidateHidden() noexcept
@@ -121,7 +267,33 @@ protected:
         mInvalidateHidden = true;
     }
 
-    void updateTransform(RenderContext& renderContext);
+    bool isHidden() noexcept;
+
+    // Updates the world transforms and scales of this node and of its invalidated descendants, parents
+    // before children. Render, culling and render cache collection read them instead of accumulating
+    // the transforms again each frame:
+    void updateWorldTransforms(const std::array<float, 6>& parentTransform, float parentScaleX,
+            float parentScaleY, float aspectRatio, bool windowSizeChanged, bool invalidate);
+
+    #ifdef TRJ_CFG_ENABLE_RENDER_CACHE
+        priv::Hash getRenderCacheHash();
+
+        void updateRenderCache(RenderContext& renderContext, void*& renderCache, float scaleX, float scaleY);
+
+        void* getLodRenderCache(RenderContext& renderContext, float finalScaleX, float finalScaleY);
+
+        void* findLodRenderCache(NVGcontext& nanoVgContext, float finalScaleX, float finalScaleY);
+
+        // Returns the key of the render cache that the next render will record with the given final scale,
+        // or zero if it won't record one or it can't be shared:
+        priv::Hash getPendingRenderCacheKey(RenderContext& renderContext, float finalScaleX,
+                float finalScaleY, float& scaleX, float& scaleY);
+
+        void recordRenderCache(RenderContext& renderContext, void*& renderCache, float scaleX, float scaleY,
+                const priv::Hash& key);
+
+        void releaseLodRenderCaches();
+    #endif
 
     void releaseRenderCache();
 
@@ -336,8 +508,26 @@ public:
     void setRenderOffScreen(bool renderOffScreen) noexcept
     {
         mRenderOffScreen = renderOffScreen;
+        invalidateSubtreeBoundingBox();
+    }
+
+    bool renderInstanced() const noexcept
+    {
+        return mRenderInstanced;
     }
 
+    void setRenderInstanced(bool renderInstanced) noexcept
+    {
+        mRenderInstanced = renderInstanced;
+    }
+
+    bool isSpatialIndexEnabled() const noexcept
+    {
+        return mSpatialIndex != nullptr;
+    }
+
+    void setSpatialIndexEnabled(bool enabled);
+
     const Node* getParent() const noexcept
     {
         return mParent;
@@ -427,6 +617,15 @@ public:
         return mActionsRunning;
     }
 
+    bool isUpdateEnabled() const noexcept
+    {
+        return mUpdateEnabled;
+    }
+
+    // Enables the per frame updateItself calls. Disabled by default, so only the nodes that need
+    // them are visited each frame:
+    void setUpdateEnabled(bool enabled);
+
     const std::vector<const Node*>& getChildren() const noexcept
     {
         return mChildren;
@@ -30,6 +30,11 @@ namespace trj
 class RenderContext;
 class ShapeGroup;
 
+namespace priv
+{
+    struct Hash;
+}
+
 enum class LineCap
 {
     BUTT,
@@ -182,6 +187,8 @@ public:
         mLineJoin = lineJoin;
     }
 
+    priv::Hash getHash() const noexcept;
+
     void horizontalFlip() noexcept;
 
     Pen getHorizontalFlipped() const noexcept
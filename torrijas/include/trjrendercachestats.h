@@ -0,0 +1,113 @@
+//
+// Copyright (c) 2015 Gustavo Valiente gustavovalient@gmail.com
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+//
+
+#ifndef TRJ_RENDER_CACHE_STATS_H
+#define TRJ_RENDER_CACHE_STATS_H
+
+#include <algorithm>
+#include <cstddef>
+#include "trjcommon.h"
+
+namespace trj
+{
+
+class RenderCacheStats
+{
+
+protected:
+    std::size_t mNumBytes = 0;
+    std::size_t mNumPooledBytes = 0;
+    int mNumRenderCaches = 0;
+    int mNumDraws = 0;
+    int mNumRecords = 0;
+    int mNumEvictions = 0;
+    int mNumLoads = 0;
+
+public:
+    RenderCacheStats() noexcept
+    {
+    }
+
+    RenderCacheStats(std::size_t numBytes, std::size_t numPooledBytes, int numRenderCaches, int numDraws,
+            int numRecords, int numEvictions, int numLoads) noexcept :
+        mNumBytes(numBytes),
+        mNumPooledBytes(numPooledBytes),
+        mNumRenderCaches(numRenderCaches),
+        mNumDraws(numDraws),
+        mNumRecords(numRecords),
+        mNumEvictions(numEvictions),
+        mNumLoads(numLoads)
+    {
+    }
+
+    std::size_t getNumBytes() const noexcept
+    {
+        return mNumBytes;
+    }
+
+    std::size_t getNumPooledBytes() const noexcept
+    {
+        return mNumPooledBytes;
+    }
+
+    std::size_t getNumTotalBytes() const noexcept
+    {
+        return mNumBytes + mNumPooledBytes;
+    }
+
+    int getNumRenderCaches() const noexcept
+    {
+        return mNumRenderCaches;
+    }
+
+    int getNumDraws() const noexcept
+    {
+        return mNumDraws;
+    }
+
+    int getNumRecords() const noexcept
+    {
+        return mNumRecords;
+    }
+
+    int getNumEvictions() const noexcept
+    {
+        return mNumEvictions;
+    }
+
+    // Number of render caches read from the render cache folder instead of being recorded:
+    int getNumLoads() const noexcept
+    {
+        return mNumLoads;
+    }
+
+    // Ratio of render cache draws which didn't need to record the render cache:
+    float getHitRate() const noexcept
+    {
+        if(mNumDraws <= 0)
+        {
+            return 0;
+        }
+
+        return float(mNumDraws - std::min(mNumRecords, mNumDraws)) / mNumDraws;
+    }
+};
+
+}
+
+#endif
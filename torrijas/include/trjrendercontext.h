@@ -19,6 +19,7 @@
 #ifndef TRJ_RENDER_CONTEXT_H
 #define TRJ_RENDER_CONTEXT_H
 
+#include <array>
 #include <vector>
 #include "trjrect.h"
 #include "trjcolor.h"
@@ -31,9 +32,20 @@ namespace trj
 class RenderContext
 {
 
+public:
+    struct Scissor
+    {
+        std::array<float, 6> transform;
+        float extentX;
+        float extentY;
+    };
+
 protected:
+    std::array<float, 6> mTransform;
+    Scissor mScissor;
     Rect mWindowRect;
     std::vector<std::pair<Color, float>> mBlendColors;
+    std::pair<Color, float> mBlendTint;
     NVGcontext& mNanoVgContext;
     float mAspectRatio;
     float mFinalScaleX;
@@ -45,11 +57,16 @@ protected:
     bool mShowBoundingBoxes;
     bool mRenderOffScreen;
     bool mInvalidateFinalBoundingBoxes;
+    bool mNanoVgScissorUpdated;
 
 public:
-    RenderContext(NVGcontext& nanoVgContext, int windowWidth, int windowHeight,
-            bool windowWidthChanged, bool windowHeightChanged, bool showBoundingBoxes) noexcept :
+    RenderContext(NVGcontext& nanoVgContext, const std::array<float, 6>& transform,
+            int windowWidth, int windowHeight, bool windowWidthChanged, bool windowHeightChanged,
+            bool showBoundingBoxes) noexcept :
+        mTransform(transform),
+        mScissor{ {{ 0, 0, 0, 0, 0, 0 }}, -1, -1 },
         mWindowRect(0, 0, windowWidth, windowHeight),
+        mBlendTint(Color(), 0.0f),
         mNanoVgContext(nanoVgContext),
         mAspectRatio(windowWidth / (float) windowHeight),
         mFinalScaleX(1),
@@ -60,7 +77,8 @@ public:
         mScissorEnabled(false),
         mShowBoundingBoxes(showBoundingBoxes),
         mRenderOffScreen(false),
-        mInvalidateFinalBoundingBoxes(false)
+        mInvalidateFinalBoundingBoxes(false),
+        mNanoVgScissorUpdated(false)
     {
     }
 
@@ -69,6 +87,39 @@ public:
         return mNanoVgContext;
     }
 
+    const std::array<float, 6>& getTransform() const noexcept
+    {
+        return mTransform;
+    }
+
+    void setTransform(const std::array<float, 6>& transform) noexcept
+    {
+        mTransform = transform;
+    }
+
+    const Scissor& getScissor() const noexcept
+    {
+        return mScissor;
+    }
+
+    void setScissor(const Scissor& scissor) noexcept
+    {
+        mScissor = scissor;
+        mNanoVgScissorUpdated = false;
+    }
+
+    void intersectScissor(const Rect& rect) noexcept;
+
+    // Forces the next applyNanoVgState call to set the scissor in the NanoVG context:
+    void invalidateNanoVgScissor() noexcept
+    {
+        mNanoVgScissorUpdated = false;
+    }
+
+    // Sets the current transform, scissor, opacity and blend tint in the NanoVG context.
+    // It must be called before rendering primitives:
+    void applyNanoVgState() noexcept;
+
     const Rect& getWindowRect() const noexcept
     {
         return mWindowRect;
@@ -174,14 +225,28 @@ public:
         return Color::getBlendResult(mBlendColors);
     }
 
+    // Blend colors are applied by NanoVG as a global tint, so primitives colors aren't blended one by one:
+    const std::pair<Color, float>& getBlendTint() const noexcept
+    {
+        return mBlendTint;
+    }
+
+    void swapBlendColors(std::vector<std::pair<Color, float>>& blendColors) noexcept
+    {
+        mBlendColors.swap(blendColors);
+        mBlendTint = Color::getBlendTint(mBlendColors);
+    }
+
     void pushBlendColor(const Color& blendColor, float blendFactor)
     {
         mBlendColors.push_back(std::make_pair(blendColor, blendFactor));
+        mBlendTint = Color::getBlendTint(mBlendColors);
     }
 
     void popBlendColor() noexcept
     {
         mBlendColors.pop_back();
+        mBlendTint = Color::getBlendTint(mBlendColors);
     }
 };
 
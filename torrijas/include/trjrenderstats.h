@@ -0,0 +1,121 @@
+//
+// Copyright (c) 2015 Gustavo Valiente gustavovalient@gmail.com
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+//
+
+#ifndef TRJ_RENDER_STATS_H
+#define TRJ_RENDER_STATS_H
+
+#include "trjcommon.h"
+
+namespace trj
+{
+
+class RenderStats
+{
+
+protected:
+    int mNumFills = 0;
+    int mNumStrokes = 0;
+    int mNumTriangles = 0;
+    int mNumPaths = 0;
+    int mNumVertices = 0;
+    int mNumMergedCalls = 0;
+    int mNumSortedCalls = 0;
+    int mNumGlDraws = 0;
+
+public:
+    RenderStats() noexcept
+    {
+    }
+
+    RenderStats(int numFills, int numStrokes, int numTriangles, int numPaths, int numVertices,
+            int numMergedCalls, int numSortedCalls, int numGlDraws) noexcept :
+        mNumFills(numFills),
+        mNumStrokes(numStrokes),
+        mNumTriangles(numTriangles),
+        mNumPaths(numPaths),
+        mNumVertices(numVertices),
+        mNumMergedCalls(numMergedCalls),
+        mNumSortedCalls(numSortedCalls),
+        mNumGlDraws(numGlDraws)
+    {
+    }
+
+    int getNumFills() const noexcept
+    {
+        return mNumFills;
+    }
+
+    int getNumStrokes() const noexcept
+    {
+        return mNumStrokes;
+    }
+
+    int getNumTriangles() const noexcept
+    {
+        return mNumTriangles;
+    }
+
+    int getNumDrawCalls() const noexcept
+    {
+        return mNumFills + mNumStrokes + mNumTriangles;
+    }
+
+    int getNumPaths() const noexcept
+    {
+        return mNumPaths;
+    }
+
+    int getNumVertices() const noexcept
+    {
+        return mNumVertices;
+    }
+
+    // Draw calls drawn with the state of the previous draw call:
+    int getNumMergedCalls() const noexcept
+    {
+        return mNumMergedCalls;
+    }
+
+    // Draw calls moved before the draw calls they don't overlap, next to a draw call with the same state:
+    int getNumSortedCalls() const noexcept
+    {
+        return mNumSortedCalls;
+    }
+
+    // GL draw commands issued by the draw calls:
+    int getNumGlDraws() const noexcept
+    {
+        return mNumGlDraws;
+    }
+
+    // Ratio of draw calls merged with the previous draw call:
+    float getMergeRate() const noexcept
+    {
+        int numDrawCalls = getNumDrawCalls();
+        if(numDrawCalls <= 0)
+        {
+            return 0;
+        }
+
+        return float(mNumMergedCalls) / numDrawCalls;
+    }
+};
+
+}
+
+#endif
@@ -29,6 +29,11 @@ namespace trj
 
 class ShapeGroup;
 
+namespace priv
+{
+    struct Hash;
+}
+
 class Shape
 {
     friend class ShapeGroup;
@@ -158,6 +163,8 @@ public:
         mHole = hole;
     }
 
+    priv::Hash getHash() const noexcept;
+
     void horizontalFlip() noexcept;
 
     Shape getHorizontalFlipped() const noexcept
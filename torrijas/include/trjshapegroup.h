@@ -68,6 +68,8 @@ public:
 
     const Rect& getBoundingBox() noexcept;
 
+    priv::Hash getHash() const noexcept;
+
     const std::vector<Shape>& getShapes() const noexcept
     {
         return mShapes;
@@ -129,7 +129,11 @@ protected:
 
     Rect generateBoundingBox() override;
 
-    bool renderCacheAvailable(const RenderContext& renderContext) const override;
+    bool renderCacheBlendable() const override;
+
+    bool renderCacheConcurrent() const override;
+
+    priv::Hash generateRenderCacheHash() const override;
 
     void renderItself(RenderContext& renderContext) override;
 
@@ -189,6 +193,7 @@ public:
     void setFontColor(const Color& color) noexcept
     {
         mFontColor = color;
+        invalidateRenderCache();
     }
 
     void setFontColor(float red, float green, float blue, float alpha = 1) noexcept
@@ -31,6 +31,18 @@
 #pragma warning(disable: 4706)  // assignment within conditional expression
 #endif
 
+// Tessellation kernels use SSE2 or NEON when available. Define NVG_NO_SIMD to use the scalar ones.
+// Both compute the same operations in the same order, so their results are identical.
+#if !defined(NVG_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define NVG_SSE2 1
+#define NVG_SIMD 1
+#elif !defined(NVG_NO_SIMD) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#include <arm_neon.h>
+#define NVG_NEON 1
+#define NVG_SIMD 1
+#endif
+
 #define NVG_INIT_FONTIMAGE_SIZE  512*2
 #define NVG_MAX_FONTIMAGE_SIZE   2048
 #define NVG_MAX_FONTIMAGES       4
@@ -73,6 +85,8 @@ struct NVGstate {
 	int lineJoin;
 	int lineCap;
 	float alpha;
+	NVGcolor tint;
+	float tintFactor;
 	float xform[6];
 #if NVG_TRANSFORM_IN_VERTEX_SHADER
     float invxform[6];
@@ -124,46 +138,63 @@ enum NVGdisplayListCommandType
 	NVG_COMMAND_TRIANGLE = 2
 };
 
+// Display list commands are stored one after another with a variable length: each header is followed by
+// its solid color or by the index of its paint, and then by the parameters of its type. Paints, scissors
+// and transforms are stored in side tables, and each entry is shared by consecutive commands:
 struct NVGdisplayListCommand
 {
-	enum NVGdisplayListCommandType type;
-
-	NVGpaint paint;
-	NVGscissor scissor;
-	float xform[6];
+	unsigned char type;
+	unsigned char solid;
+	unsigned short size;
+	int xform;
+	int scissor;
+};
+typedef struct NVGdisplayListCommand NVGdisplayListCommand;
 
-	union
-	{
-		struct {
-			float fringe;
-			float bounds[4];
-			int path;
-			int npaths;
-		}
-		fillParams;
+struct NVGfillParams
+{
+	float fringe;
+	float bounds[4];
+	int path;
+	int npaths;
+	int quad;
+};
+typedef struct NVGfillParams NVGfillParams;
 
-		struct {
-			float fringe;
-			float strokeWidth;
-			int path;
-			int npaths;
-		}
-		strokeParams;
+struct NVGstrokeParams
+{
+	float fringe;
+	float strokeWidth;
+	int path;
+	int npaths;
+};
+typedef struct NVGstrokeParams NVGstrokeParams;
 
-		struct {
-			int vertices;
-			int nverts;
-		}
-		triangleParams;
-	};
+struct NVGtriangleParams
+{
+	int vertices;
+	int nverts;
 };
-typedef struct NVGdisplayListCommand NVGdisplayListCommand;
+typedef struct NVGtriangleParams NVGtriangleParams;
 
 struct NVGdisplayList
 {
-	NVGdisplayListCommand* commands;
+	// Command bytes:
+	unsigned char* commands;
 	int ccommands;
 	int ncommands;
+
+	NVGpaint* paints;
+	int npaints;
+	int cpaints;
+
+	NVGscissor* scissors;
+	int nscissors;
+	int cscissors;
+
+	float* xforms;
+	int nxforms;
+	int cxforms;
     
     NVGvertex* vertices;
     int nverts;
@@ -172,6 +203,14 @@ struct NVGdisplayList
     NVGpath* paths;
     int npaths;
     int cpaths;
+
+    // Back end vertex buffer with a copy of the vertices:
+    NVGcontext* ctx;
+    int buffer;
+    int nbufferVerts;
+
+    // Font atlas image used by the text commands, -1 if they use more than one:
+    int fontImage;
 };
 
 struct NVGcontext {
@@ -187,6 +226,7 @@ struct NVGcontext {
 	float distTol;
 	float fringeWidth;
 	float devicePxRatio;
+	int simd;
 	struct FONScontext* fs;
 	int fontImages[NVG_MAX_FONTIMAGES];
 	int fontImageIdx;
@@ -207,26 +247,41 @@ struct NVGcontext {
                              const NVGvertex* verts, int nverts);
 
 	NVGdisplayList* displayList;
+
+	// Instances of the same display list waiting to be drawn together:
+	NVGdisplayList* instanceList;
+	float instanceFringeScale;
+	NVGinstance* instances;
+	int ninstances;
+	int cinstances;
 };
 
+static void nvg__flushInstances(NVGcontext* ctx);
+
 //default immediate render callbacks
 static void nvg__renderFill(NVGcontext* ctx, NVGpaint* paint, NVGscissor* scissor, const float* xform,
                             float fringe, const float* bounds, const NVGpath* paths, int npaths)
 {
+	nvg__flushInstances(ctx);
 	ctx->params.renderFill(ctx->params.userPtr, paint, scissor, xform, fringe, bounds, paths, npaths);
 }
 static void nvg__renderStroke(NVGcontext* ctx, NVGpaint* paint, NVGscissor* scissor, const float* xform,
                               float fringe, float strokeWidth, const NVGpath* paths, int npaths)
 {
+	nvg__flushInstances(ctx);
 	ctx->params.renderStroke(ctx->params.userPtr, paint, scissor, xform, fringe, strokeWidth, paths, npaths);
 }
 static void nvg__renderTriangles(NVGcontext* ctx, NVGpaint* paint, NVGscissor* scissor, const float* xform,
                                  const NVGvertex* verts, int nverts)
 {
+	nvg__flushInstances(ctx);
 	ctx->params.renderTriangles(ctx->params.userPtr, paint, scissor, xform, verts, nverts);
 }
 
 static NVGscissor* nvg__combineScissor(const NVGscissor * rhs, const NVGscissor * lhs, NVGscissor * result);
+static void nvg__resetScissor(NVGscissor * scissor);
+static void nvg__setPaintColor(NVGpaint* p, NVGcolor color);
+static void nvg__vset(NVGvertex* vtx, float x, float y, float u, float v);
 
 static float nvg__sqrtf(float a) { return sqrtf(a); }
 static float nvg__modf(float a, float b) { return fmodf(a, b); }
@@ -334,6 +389,8 @@ NVGcontext* nvgCreateInternal(NVGparams* params)
 	ctx->cache = nvg__allocPathCache();
 	if (ctx->cache == NULL) goto error;
 
+	ctx->simd = 1;
+
 	nvgSave(ctx);
 	nvgReset(ctx);
 
@@ -380,6 +437,7 @@ void nvgDeleteInternal(NVGcontext* ctx)
 	if (ctx == NULL) return;
 	if (ctx->commands != NULL) free(ctx->commands);
 	if (ctx->cache != NULL) nvg__deletePathCache(ctx->cache);
+	if (ctx->instances != NULL) free(ctx->instances);
 
 	if (ctx->fs)
 		fonsDeleteInternal(ctx->fs);
@@ -421,11 +479,14 @@ void nvgBeginFrame(NVGcontext* ctx, int windowWidth, int windowHeight, float dev
 
 void nvgCancelFrame(NVGcontext* ctx)
 {
+	ctx->instanceList = NULL;
+	ctx->ninstances = 0;
 	ctx->params.renderCancel(ctx->params.userPtr);
 }
 
 void nvgEndFrame(NVGcontext* ctx)
 {
+	nvg__flushInstances(ctx);
 	ctx->params.renderFlush(ctx->params.userPtr);
 	if (ctx->fontImageIdx != 0) {
 		int fontImage = ctx->fontImages[ctx->fontImageIdx];
@@ -460,7 +521,7 @@ static NVGvertex* nvg__allocDrawListVertices(NVGdisplayList* ctx, int n)
     {
         int i;
         NVGvertex * vertices = NULL;
-        int cverts = ctx->cverts + ((n + 0xff) & ~0xff);
+        int cverts = ctx->nverts + n + ctx->cverts/2; // 1.5x Overallocate
         
         vertices = (NVGvertex*)realloc(ctx->vertices, sizeof(NVGvertex)*cverts);
         if (vertices == NULL) return NULL;
@@ -485,7 +546,7 @@ static NVGpath* nvg__allocDrawListPaths(NVGdisplayList* ctx, int n)
     if (ctx->npaths + n >= ctx->cpaths)
     {
         NVGpath * paths = NULL;
-        int cpaths = ctx->cpaths + ((n + 0xff) & ~0xff);
+        int cpaths = ctx->npaths + n + ctx->cpaths/2; // 1.5x Overallocate
         
         paths = (NVGpath*)realloc(ctx->paths, sizeof(NVGpath)*cpaths);
         if (paths == NULL) return NULL;
@@ -555,87 +616,178 @@ static int nvg__deepCopyPaths(NVGdisplayList* ctx, const NVGpath* paths, int npa
 	return (int)(path - ctx->paths);
 }
 
-static NVGdisplayListCommand* nvg__allocDisplayListCommand(NVGdisplayList* ctx)
+static int nvg__reserveDisplayListItems(void** items, int* citems, int nitems, int n, int itemSize)
 {
-    if (ctx->ncommands == ctx->ccommands)
-    {
-        NVGdisplayListCommand * commands;
-		
-		int ccommands;
-		int grow = ctx->ccommands/2;
-		if (grow < 4) grow = 4;
-		
-        ccommands = ctx->ncommands + grow;
-        commands = (NVGdisplayListCommand*)realloc(ctx->commands, sizeof(NVGdisplayListCommand)*ccommands);
-        if (commands == NULL) return NULL;
-        
-        ctx->commands = commands;
-        ctx->ccommands = ccommands;
-    }
-    
-    return ctx->commands + ctx->ncommands;
+	if (nitems + n > *citems)
+	{
+		int citemsNew = nitems + n + *citems/2; // 1.5x Overallocate
+		void* itemsNew = realloc(*items, itemSize*citemsNew);
+		if (itemsNew == NULL) return 0;
+
+		*items = itemsNew;
+		*citems = citemsNew;
+	}
+
+	return 1;
+}
+
+static int nvg__displayListPaint(NVGdisplayList* ctx, const NVGpaint* paint)
+{
+	if (ctx->npaints > 0 && memcmp(&ctx->paints[ctx->npaints-1], paint, sizeof(NVGpaint)) == 0)
+		return ctx->npaints-1;
+
+	if (!nvg__reserveDisplayListItems((void**)&ctx->paints, &ctx->cpaints, ctx->npaints, 1, sizeof(NVGpaint)))
+		return -1;
+
+	ctx->paints[ctx->npaints] = *paint;
+	return ctx->npaints++;
+}
+
+static int nvg__displayListScissor(NVGdisplayList* ctx, const NVGscissor* scissor)
+{
+	NVGscissor noScissor;
+	nvg__resetScissor(&noScissor);
+
+	if (memcmp(scissor, &noScissor, sizeof(NVGscissor)) == 0)
+		return -1;
+
+	if (ctx->nscissors > 0 && memcmp(&ctx->scissors[ctx->nscissors-1], scissor, sizeof(NVGscissor)) == 0)
+		return ctx->nscissors-1;
+
+	if (!nvg__reserveDisplayListItems((void**)&ctx->scissors, &ctx->cscissors, ctx->nscissors, 1,
+									  sizeof(NVGscissor)))
+		return -2;
+
+	ctx->scissors[ctx->nscissors] = *scissor;
+	return ctx->nscissors++;
+}
+
+static int nvg__displayListXform(NVGdisplayList* ctx, const float* xform)
+{
+	if (ctx->nxforms > 0 && memcmp(&ctx->xforms[(ctx->nxforms-1)*6], xform, sizeof(float)*6) == 0)
+		return ctx->nxforms-1;
+
+	if (!nvg__reserveDisplayListItems((void**)&ctx->xforms, &ctx->cxforms, ctx->nxforms, 1, sizeof(float)*6))
+		return -1;
+
+	memcpy(&ctx->xforms[ctx->nxforms*6], xform, sizeof(float)*6);
+	return ctx->nxforms++;
+}
+
+// Returns the parameters of the command:
+static void* nvg__displayListCommandParams(NVGdisplayListCommand* cmd)
+{
+	return (unsigned char*)(cmd + 1) + (cmd->solid ? sizeof(NVGcolor) : sizeof(int));
+}
+
+// Writes the header and the paint of a new command, which is added to the display list by incrementing
+// ncommands with its size:
+static NVGdisplayListCommand* nvg__allocDisplayListCommand(NVGdisplayList* ctx, int type, const NVGpaint* paint,
+														   const NVGscissor* scissor, const float* xform,
+														   int paramsSize)
+{
+	NVGdisplayListCommand* cmd;
+	NVGpaint solidPaint;
+	int solid, size, paintIndex = 0, scissorIndex, xformIndex;
+
+	// Solid colors are stored in the command:
+	nvg__setPaintColor(&solidPaint, paint->innerColor);
+	solid = memcmp(&solidPaint, paint, sizeof(NVGpaint)) == 0;
+	size = (int)sizeof(NVGdisplayListCommand) + (solid ? (int)sizeof(NVGcolor) : (int)sizeof(int)) + paramsSize;
+
+	if (!solid && (paintIndex = nvg__displayListPaint(ctx, paint)) < 0) return NULL;
+	if ((scissorIndex = nvg__displayListScissor(ctx, scissor)) < -1) return NULL;
+	if ((xformIndex = nvg__displayListXform(ctx, xform)) < 0) return NULL;
+	if (!nvg__reserveDisplayListItems((void**)&ctx->commands, &ctx->ccommands, ctx->ncommands, size, 1))
+		return NULL;
+
+	cmd = (NVGdisplayListCommand*)(ctx->commands + ctx->ncommands);
+	cmd->type = (unsigned char)type;
+	cmd->solid = (unsigned char)solid;
+	cmd->size = (unsigned short)size;
+	cmd->xform = xformIndex;
+	cmd->scissor = scissorIndex;
+
+	if (solid)
+		memcpy(cmd + 1, &paint->innerColor, sizeof(NVGcolor));
+	else
+		memcpy(cmd + 1, &paintIndex, sizeof(int));
+
+	return cmd;
 }
 
 static void nvg__drawListRenderFill(NVGcontext* uptr, NVGpaint* paint, NVGscissor* scissor, const float* xform, float fringe, const float* bounds, const NVGpath* paths, int npaths)
 {
 	NVGdisplayList* ctx = uptr->displayList;
-    NVGdisplayListCommand* cmd = nvg__allocDisplayListCommand(ctx);
+	NVGfillParams* params;
+    NVGdisplayListCommand* cmd = nvg__allocDisplayListCommand(ctx, NVG_COMMAND_FILL, paint, scissor, xform,
+																sizeof(NVGfillParams));
     if (cmd == NULL) return;
+
+	params = (NVGfillParams*)nvg__displayListCommandParams(cmd);
+	memcpy(params->bounds,bounds,sizeof(float)*4);
+	params->fringe = fringe;
+	params->path = nvg__deepCopyPaths(ctx, paths, npaths);
+	params->npaths = npaths;
+	params->quad = -1;
+
+	// The bounds quad is stored too, so fills can be drawn from a back end vertex buffer:
+	if (uptr->params.renderCreateBuffer != NULL)
+	{
+		NVGvertex* quad = nvg__allocDrawListVertices(ctx, 6);
+		if (quad != NULL)
+		{
+			nvg__vset(&quad[0], bounds[0], bounds[3], 0.5f, 1.0f);
+			nvg__vset(&quad[1], bounds[2], bounds[3], 0.5f, 1.0f);
+			nvg__vset(&quad[2], bounds[2], bounds[1], 0.5f, 1.0f);
+			nvg__vset(&quad[3], bounds[0], bounds[3], 0.5f, 1.0f);
+			nvg__vset(&quad[4], bounds[2], bounds[1], 0.5f, 1.0f);
+			nvg__vset(&quad[5], bounds[0], bounds[1], 0.5f, 1.0f);
+			params->quad = ctx->nverts;
+			ctx->nverts += 6;
+		}
+	}
     
-	cmd->type = NVG_COMMAND_FILL;
-	cmd->paint = *paint;
-	cmd->scissor = *scissor;
-	memcpy(cmd->xform, xform, sizeof(float)*6);
-
-	memcpy(cmd->fillParams.bounds,bounds,sizeof(float)*4);
-	cmd->fillParams.fringe = fringe;
-	cmd->fillParams.path = nvg__deepCopyPaths(ctx, paths, npaths);
-	cmd->fillParams.npaths = npaths;
-    
-    ctx->ncommands++;
+    ctx->ncommands += cmd->size;
 }
 
 static void nvg__drawListRenderStroke(NVGcontext* uptr, NVGpaint* paint, NVGscissor* scissor, const float* xform, float fringe, float strokeWidth, const NVGpath* paths, int npaths)
 {
 	NVGdisplayList* ctx = uptr->displayList;
-    NVGdisplayListCommand* cmd = nvg__allocDisplayListCommand(ctx);
+	NVGstrokeParams* params;
+    NVGdisplayListCommand* cmd = nvg__allocDisplayListCommand(ctx, NVG_COMMAND_STROKE, paint, scissor, xform,
+																sizeof(NVGstrokeParams));
     if (cmd == NULL) return;
-	
-    cmd->type = NVG_COMMAND_STROKE;
-	cmd->paint = *paint;
-	cmd->scissor = *scissor;
-	memcpy(cmd->xform, xform, sizeof(float)*6);
-
-	cmd->strokeParams.fringe = fringe;
-	cmd->strokeParams.strokeWidth = strokeWidth;
-	cmd->strokeParams.path = nvg__deepCopyPaths(ctx, paths, npaths);
-	cmd->strokeParams.npaths = npaths;
+
+	params = (NVGstrokeParams*)nvg__displayListCommandParams(cmd);
+	params->fringe = fringe;
+	params->strokeWidth = strokeWidth;
+	params->path = nvg__deepCopyPaths(ctx, paths, npaths);
+	params->npaths = npaths;
     
-    ctx->ncommands++;
+    ctx->ncommands += cmd->size;
 }
 
 static void nvg__drawListRenderTriangles(NVGcontext* uptr, NVGpaint* paint, NVGscissor* scissor, const float* xform, const NVGvertex* verts, int nverts)
 {
 	NVGdisplayList* ctx = uptr->displayList;
     NVGvertex* vtx = NULL;
+	NVGtriangleParams* params;
     
-	NVGdisplayListCommand* cmd = nvg__allocDisplayListCommand(ctx);
+	NVGdisplayListCommand* cmd = nvg__allocDisplayListCommand(ctx, NVG_COMMAND_TRIANGLE, paint, scissor, xform,
+															  sizeof(NVGtriangleParams));
     if (cmd == NULL) return;
     
-	cmd->type = NVG_COMMAND_TRIANGLE;
-	cmd->paint = *paint;
-	cmd->scissor = *scissor;
-	memcpy(cmd->xform, xform, sizeof(float)*6);
-    
     vtx = nvg__allocDrawListVertices(ctx, nverts);
     if (vtx == NULL) return;
 
-    cmd->triangleParams.vertices = (int)(vtx - ctx->vertices);
+	params = (NVGtriangleParams*)nvg__displayListCommandParams(cmd);
+    params->vertices = (int)(vtx - ctx->vertices);
 	memcpy(vtx, verts, sizeof(NVGvertex)*nverts);
-	cmd->triangleParams.nverts = nverts;
+	params->nverts = nverts;
     
     ctx->nverts += nverts;
-    ctx->ncommands++;
+    ctx->ncommands += cmd->size;
 }
 
 NVGdisplayList* nvgCreateDisplayList(int initalNumCommands)
@@ -646,10 +798,12 @@ NVGdisplayList* nvgCreateDisplayList(int initalNumCommands)
 	if (ctx == NULL) goto error;
 	memset(ctx, 0, sizeof(NVGdisplayList));
     
-	ctx->commands = (NVGdisplayListCommand*)malloc(sizeof(NVGdisplayListCommand)*ncommands);
+	// Commands are allocated with the size of solid color fills. Paints, scissors and transforms are
+	// allocated when they are recorded:
+	ctx->ccommands = ncommands*(int)(sizeof(NVGdisplayListCommand) + sizeof(NVGcolor) + sizeof(NVGfillParams));
+	ctx->commands = (unsigned char*)malloc(ctx->ccommands);
 	if (!ctx->commands) goto error;
 	ctx->ncommands = 0;
-	ctx->ccommands = ncommands;
     
     ctx->vertices = (NVGvertex*)malloc(sizeof(NVGvertex)*ncommands*NVG_INIT_DISPLAYLIST_VERTS_PER_PATH_SIZE);
     if (!ctx->vertices) goto error;
@@ -673,12 +827,35 @@ void nvgDeleteDisplayList(NVGdisplayList* list)
 	if (list != NULL)
 	{
 		nvgResetDisplayList(list);
+
+		if (list->buffer != 0)
+			list->ctx->params.renderDeleteBuffer(list->ctx->params.userPtr, list->buffer);
+
+		list->buffer = 0;
 		
 		if (list->commands != NULL) 
 			free(list->commands);
 
 		list->commands = 0;
         list->ccommands = 0;
+
+		if (list->paints != NULL)
+			free(list->paints);
+
+		list->paints = 0;
+		list->cpaints = 0;
+
+		if (list->scissors != NULL)
+			free(list->scissors);
+
+		list->scissors = 0;
+		list->cscissors = 0;
+
+		if (list->xforms != NULL)
+			free(list->xforms);
+
+		list->xforms = 0;
+		list->cxforms = 0;
         
         if (list->vertices != NULL)
             free(list->vertices);
@@ -691,11 +868,47 @@ void nvgDeleteDisplayList(NVGdisplayList* list)
         
         list->paths = 0;
         list->cpaths = 0;
+
+		free(list);
+	}
+}
+
+static void nvg__uploadDisplayList(NVGcontext* ctx, NVGdisplayList* list)
+{
+	NVGdisplayListCommand* cmd;
+	int i;
+
+	if (ctx->params.renderCreateBuffer == NULL)
+		return;
+
+	if (list->buffer != 0)
+		ctx->params.renderDeleteBuffer(ctx->params.userPtr, list->buffer);
+
+	list->ctx = ctx;
+	list->buffer = 0;
+	list->nbufferVerts = 0;
+
+	// All fills need their bounds quad:
+	for (i = 0; i < list->ncommands; i += cmd->size)
+	{
+		cmd = (NVGdisplayListCommand*)(list->commands + i);
+		if (cmd->type == NVG_COMMAND_FILL && ((NVGfillParams*)nvg__displayListCommandParams(cmd))->quad < 0)
+			return;
+	}
+
+	if (list->nverts > 0) {
+		list->buffer = ctx->params.renderCreateBuffer(ctx->params.userPtr, list->vertices, list->nverts);
+		list->nbufferVerts = list->nverts;
 	}
 }
 
 void nvgBindDisplayList(NVGcontext* ctx, NVGdisplayList* list)
 {
+	nvg__flushInstances(ctx);
+
+	if (ctx->displayList != NULL && ctx->displayList != list)
+		nvg__uploadDisplayList(ctx, ctx->displayList);
+
 	if (list == NULL)
 	{
 		ctx->renderFill = nvg__renderFill;
@@ -714,100 +927,731 @@ void nvgBindDisplayList(NVGcontext* ctx, NVGdisplayList* list)
 
 void nvgResetDisplayList(NVGdisplayList* list)
 {
+	// Pending instances of the list are drawn before its commands are lost:
+	if (list->ctx != NULL && list->ctx->instanceList == list)
+		nvg__flushInstances(list->ctx);
+
+	// The back end buffer is deleted when the frame is flushed, so pending draws still can use it:
+	if (list->buffer != 0) {
+		list->ctx->params.renderDeleteBuffer(list->ctx->params.userPtr, list->buffer);
+		list->buffer = 0;
+		list->nbufferVerts = 0;
+	}
+
 	list->ncommands = 0;
+	list->npaints = 0;
+	list->nscissors = 0;
+	list->nxforms = 0;
     list->nverts = 0;
     list->npaths = 0;
+    list->fontImage = 0;
 }
 
-void nvgDrawDisplayList(NVGcontext* ctx, NVGdisplayList* list)
+static int nvg__recordingRenderCreate(void* uptr)
+{
+	NVG_NOTUSED(uptr);
+	return 1;
+}
+
+static int nvg__recordingRenderCreateTexture(void* uptr, int type, int w, int h, int imageFlags, const unsigned char* data)
+{
+	NVG_NOTUSED(uptr);
+	NVG_NOTUSED(type);
+	NVG_NOTUSED(w);
+	NVG_NOTUSED(h);
+	NVG_NOTUSED(imageFlags);
+	NVG_NOTUSED(data);
+	return 1;
+}
+
+static int nvg__recordingRenderDeleteTexture(void* uptr, int image)
+{
+	NVG_NOTUSED(uptr);
+	NVG_NOTUSED(image);
+	return 1;
+}
+
+static void nvg__recordingRenderViewport(void* uptr, int width, int height)
+{
+	NVG_NOTUSED(uptr);
+	NVG_NOTUSED(width);
+	NVG_NOTUSED(height);
+}
+
+// Buffers are created by the context which uploads the display list
+static int nvg__recordingRenderCreateBuffer(void* uptr, const NVGvertex* verts, int nverts)
+{
+	NVG_NOTUSED(uptr);
+	NVG_NOTUSED(verts);
+	NVG_NOTUSED(nverts);
+	return 0;
+}
+
+NVGcontext* nvgCreateRecordingContext(NVGcontext* ctx)
+{
+	NVGparams params;
+	NVGcontext* recordingCtx;
+	memset(&params, 0, sizeof(params));
+	params.edgeAntiAlias = ctx->params.edgeAntiAlias;
+	params.renderCreate = nvg__recordingRenderCreate;
+	params.renderCreateTexture = nvg__recordingRenderCreateTexture;
+	params.renderDeleteTexture = nvg__recordingRenderDeleteTexture;
+	params.renderViewport = nvg__recordingRenderViewport;
+
+	// Fills store their bounds quad only if the display lists can be uploaded
+	if (ctx->params.renderCreateBuffer != NULL)
+		params.renderCreateBuffer = nvg__recordingRenderCreateBuffer;
+
+	recordingCtx = nvgCreateInternal(&params);
+	if (recordingCtx != NULL)
+		recordingCtx->simd = ctx->simd;
+	return recordingCtx;
+}
+
+void nvgSimdTessellation(NVGcontext* ctx, int enabled)
+{
+	ctx->simd = enabled;
+}
+
+void nvgDeleteRecordingContext(NVGcontext* ctx)
+{
+	nvgDeleteInternal(ctx);
+}
+
+void nvgUploadDisplayList(NVGcontext* ctx, NVGdisplayList* list)
+{
+	list->ctx = ctx;
+	nvg__uploadDisplayList(ctx, list);
+}
+
+int nvgDisplayListMemory(NVGdisplayList* list)
+{
+	return (int)(sizeof(NVGdisplayList) +
+		list->ccommands +
+		sizeof(NVGpaint)*list->cpaints +
+		sizeof(NVGscissor)*list->cscissors +
+		sizeof(float)*6*list->cxforms +
+		sizeof(NVGvertex)*list->cverts +
+		sizeof(NVGpath)*list->cpaths +
+		sizeof(NVGvertex)*list->nbufferVerts);
+}
+
+#define NVG_DISPLAYLIST_FILE_MAGIC 0x4c44564e // "NVDL"
+#define NVG_DISPLAYLIST_FILE_VERSION 2
+
+// Display lists are written in the native byte order, and only read by contexts with the same tessellation
+// settings. Paths store offsets to their vertices instead of pointers:
+struct NVGdisplayListFileHeader
+{
+	int magic;
+	int version;
+	int size;
+	float tessTol;
+	float distTol;
+	float fringeWidth;
+	int edgeAntiAlias;
+	int ncommands;
+	int npaints;
+	int nscissors;
+	int nxforms;
+	int nverts;
+	int npaths;
+	unsigned int checksum;
+};
+typedef struct NVGdisplayListFileHeader NVGdisplayListFileHeader;
+
+struct NVGdisplayListFilePath
+{
+	int first;
+	int count;
+	int closed;
+	int nbevel;
+	int fill;
+	int nfill;
+	int stroke;
+	int nstroke;
+	int winding;
+	int convex;
+};
+typedef struct NVGdisplayListFilePath NVGdisplayListFilePath;
+
+static int nvg__displayListFileSize(const NVGdisplayListFileHeader* header)
+{
+	return (int)(sizeof(NVGdisplayListFileHeader) +
+		header->ncommands +
+		sizeof(NVGpaint)*header->npaints +
+		sizeof(NVGscissor)*header->nscissors +
+		sizeof(float)*6*header->nxforms +
+		sizeof(NVGvertex)*header->nverts +
+		sizeof(NVGdisplayListFilePath)*header->npaths);
+}
+
+// Checks the item counts of a file header against the file size without overflowing:
+static int nvg__validDisplayListFileSize(const NVGdisplayListFileHeader* header, int size)
+{
+	int counts[6] = { header->ncommands, header->npaints, header->nscissors, header->nxforms, header->nverts,
+					  header->npaths };
+	int itemSizes[6] = { 1, (int)sizeof(NVGpaint), (int)sizeof(NVGscissor), (int)sizeof(float)*6,
+						 (int)sizeof(NVGvertex), (int)sizeof(NVGdisplayListFilePath) };
+	int i;
+
+	size -= (int)sizeof(NVGdisplayListFileHeader);
+	for (i = 0; i < 6; ++i)
+	{
+		if (counts[i] < 0 || counts[i] > size / itemSizes[i])
+			return 0;
+
+		size -= counts[i] * itemSizes[i];
+	}
+
+	return size == 0;
+}
+
+// FNV-1a hash of the data written after the file header:
+static unsigned int nvg__displayListChecksum(const unsigned char* data, int size)
+{
+	unsigned int checksum = 2166136261u;
+	int i;
+
+	for (i = 0; i < size; ++i)
+	{
+		checksum ^= data[i];
+		checksum *= 16777619u;
+	}
+
+	return checksum;
+}
+
+static void nvg__copyDisplayListItems(unsigned char** dst, const unsigned char** src, int size)
+{
+	if (size > 0)
+		memcpy(*dst, *src, size);
+
+	*dst += size;
+	*src += size;
+}
+
+static int nvg__displayListVertexOffset(NVGdisplayList* list, const NVGvertex* vertex)
+{
+	if (vertex == NULL || vertex < list->vertices || vertex > list->vertices + list->nverts)
+		return -1;
+
+	return (int)(vertex - list->vertices);
+}
+
+static int nvg__validDisplayListRange(int first, int count, int n)
+{
+	return first < 0 || (first <= n && count >= 0 && count <= n - first);
+}
+
+// Checks the commands read from a file, so they can be drawn without further checks:
+static int nvg__validDisplayListCommands(NVGdisplayList* list)
+{
+	NVGdisplayListCommand* cmd;
+	int i, paramsSize, paint;
+
+	for (i = 0; i < list->ncommands; i += cmd->size)
+	{
+		if (list->ncommands - i < (int)sizeof(NVGdisplayListCommand))
+			return 0;
+
+		cmd = (NVGdisplayListCommand*)(list->commands + i);
+		switch (cmd->type)
+		{
+		case NVG_COMMAND_FILL: paramsSize = (int)sizeof(NVGfillParams); break;
+		case NVG_COMMAND_STROKE: paramsSize = (int)sizeof(NVGstrokeParams); break;
+		case NVG_COMMAND_TRIANGLE: paramsSize = (int)sizeof(NVGtriangleParams); break;
+		default: return 0;
+		}
+
+		if (cmd->size != (int)sizeof(NVGdisplayListCommand) +
+			(cmd->solid ? (int)sizeof(NVGcolor) : (int)sizeof(int)) + paramsSize ||
+			cmd->size > list->ncommands - i ||
+			cmd->xform < 0 || cmd->xform >= list->nxforms ||
+			cmd->scissor < -1 || cmd->scissor >= list->nscissors)
+			return 0;
+
+		if (!cmd->solid)
+		{
+			memcpy(&paint, cmd + 1, sizeof(int));
+			if (paint < 0 || paint >= list->npaints)
+				return 0;
+		}
+
+		switch (cmd->type)
+		{
+		case NVG_COMMAND_FILL:
+		{
+			NVGfillParams* params = (NVGfillParams*)nvg__displayListCommandParams(cmd);
+			if (!nvg__validDisplayListRange(params->path, params->npaths, list->npaths) ||
+				!nvg__validDisplayListRange(params->quad, 6, list->nverts))
+				return 0;
+		} break;
+		case NVG_COMMAND_STROKE:
+		{
+			NVGstrokeParams* params = (NVGstrokeParams*)nvg__displayListCommandParams(cmd);
+			if (!nvg__validDisplayListRange(params->path, params->npaths, list->npaths))
+				return 0;
+		} break;
+		case NVG_COMMAND_TRIANGLE:
+		{
+			NVGtriangleParams* params = (NVGtriangleParams*)nvg__displayListCommandParams(cmd);
+			if (!nvg__validDisplayListRange(params->vertices, params->nverts, list->nverts))
+				return 0;
+		} break;
+		};
+	}
+
+	return 1;
+}
+
+int nvgWriteDisplayList(NVGcontext* ctx, NVGdisplayList* list, unsigned char* data)
+{
+	NVGdisplayListFileHeader header;
+	int i;
+
+	// Image and font atlas handles aren't valid in other contexts:
+	if (list->fontImage != 0)
+		return 0;
+
+	for (i = 0; i < list->npaints; ++i)
+	{
+		if (list->paints[i].image != 0)
+			return 0;
+	}
+
+	header.magic = NVG_DISPLAYLIST_FILE_MAGIC;
+	header.version = NVG_DISPLAYLIST_FILE_VERSION;
+	header.size = (int)sizeof(NVGdisplayListFileHeader);
+	header.tessTol = ctx->tessTol;
+	header.distTol = ctx->distTol;
+	header.fringeWidth = ctx->fringeWidth;
+	header.edgeAntiAlias = ctx->params.edgeAntiAlias;
+	header.ncommands = list->ncommands;
+	header.npaints = list->npaints;
+	header.nscissors = list->nscissors;
+	header.nxforms = list->nxforms;
+	header.nverts = list->nverts;
+	header.npaths = list->npaths;
+	header.checksum = 0;
+
+	if (data != NULL)
+	{
+		unsigned char* ptr = data;
+		const unsigned char* src = (const unsigned char*)&header;
+
+		nvg__copyDisplayListItems(&ptr, &src, (int)sizeof(header));
+		src = list->commands;
+		nvg__copyDisplayListItems(&ptr, &src, list->ncommands);
+		src = (const unsigned char*)list->paints;
+		nvg__copyDisplayListItems(&ptr, &src, (int)sizeof(NVGpaint)*list->npaints);
+		src = (const unsigned char*)list->scissors;
+		nvg__copyDisplayListItems(&ptr, &src, (int)sizeof(NVGscissor)*list->nscissors);
+		src = (const unsigned char*)list->xforms;
+		nvg__copyDisplayListItems(&ptr, &src, (int)sizeof(float)*6*list->nxforms);
+		src = (const unsigned char*)list->vertices;
+		nvg__copyDisplayListItems(&ptr, &src, (int)sizeof(NVGvertex)*list->nverts);
+
+		for (i = 0; i < list->npaths; ++i)
+		{
+			const NVGpath* path = &list->paths[i];
+			NVGdisplayListFilePath filePath;
+			filePath.first = path->first;
+			filePath.count = path->count;
+			filePath.closed = path->closed;
+			filePath.nbevel = path->nbevel;
+			filePath.fill = nvg__displayListVertexOffset(list, path->fill);
+			filePath.nfill = path->nfill;
+			filePath.stroke = nvg__displayListVertexOffset(list, path->stroke);
+			filePath.nstroke = path->nstroke;
+			filePath.winding = path->winding;
+			filePath.convex = path->convex;
+			memcpy(ptr, &filePath, sizeof(filePath));
+			ptr += sizeof(filePath);
+		}
+
+		header.checksum = nvg__displayListChecksum(data + sizeof(header), (int)(ptr - data) - (int)sizeof(header));
+		memcpy(data, &header, sizeof(header));
+	}
+
+	return nvg__displayListFileSize(&header);
+}
+
+int nvgReadDisplayList(NVGcontext* ctx, NVGdisplayList* list, const unsigned char* data, int size)
+{
+	NVGdisplayListFileHeader header;
+	const unsigned char* ptr = data;
+	unsigned char* dst;
+	int i;
+
+	if (size < (int)sizeof(header))
+		return 0;
+
+	memcpy(&header, data, sizeof(header));
+	if (header.magic != NVG_DISPLAYLIST_FILE_MAGIC || header.version != NVG_DISPLAYLIST_FILE_VERSION ||
+		header.size != (int)sizeof(header) || header.tessTol != ctx->tessTol || header.distTol != ctx->distTol ||
+		header.fringeWidth != ctx->fringeWidth || header.edgeAntiAlias != ctx->params.edgeAntiAlias ||
+		!nvg__validDisplayListFileSize(&header, size) ||
+		header.checksum != nvg__displayListChecksum(data + sizeof(header), size - (int)sizeof(header)))
+		return 0;
+
+	nvgResetDisplayList(list);
+
+	if (!nvg__reserveDisplayListItems((void**)&list->commands, &list->ccommands, 0, header.ncommands, 1) ||
+		!nvg__reserveDisplayListItems((void**)&list->paints, &list->cpaints, 0, header.npaints,
+									  sizeof(NVGpaint)) ||
+		!nvg__reserveDisplayListItems((void**)&list->scissors, &list->cscissors, 0, header.nscissors,
+									  sizeof(NVGscissor)) ||
+		!nvg__reserveDisplayListItems((void**)&list->xforms, &list->cxforms, 0, header.nxforms,
+									  sizeof(float)*6) ||
+		!nvg__reserveDisplayListItems((void**)&list->vertices, &list->cverts, 0, header.nverts,
+									  sizeof(NVGvertex)) ||
+		!nvg__reserveDisplayListItems((void**)&list->paths, &list->cpaths, 0, header.npaths, sizeof(NVGpath)))
+		return 0;
+
+	ptr += sizeof(header);
+	dst = list->commands;
+	nvg__copyDisplayListItems(&dst, &ptr, header.ncommands);
+	dst = (unsigned char*)list->paints;
+	nvg__copyDisplayListItems(&dst, &ptr, (int)sizeof(NVGpaint)*header.npaints);
+	dst = (unsigned char*)list->scissors;
+	nvg__copyDisplayListItems(&dst, &ptr, (int)sizeof(NVGscissor)*header.nscissors);
+	dst = (unsigned char*)list->xforms;
+	nvg__copyDisplayListItems(&dst, &ptr, (int)sizeof(float)*6*header.nxforms);
+	dst = (unsigned char*)list->vertices;
+	nvg__copyDisplayListItems(&dst, &ptr, (int)sizeof(NVGvertex)*header.nverts);
+
+	for (i = 0; i < header.npaths; ++i)
+	{
+		NVGpath* path = &list->paths[i];
+		NVGdisplayListFilePath filePath;
+		memcpy(&filePath, ptr, sizeof(filePath));
+		ptr += sizeof(filePath);
+
+		if (!nvg__validDisplayListRange(filePath.fill, filePath.nfill, header.nverts) ||
+			!nvg__validDisplayListRange(filePath.stroke, filePath.nstroke, header.nverts))
+		{
+			nvgResetDisplayList(list);
+			return 0;
+		}
+
+		path->first = filePath.first;
+		path->count = filePath.count;
+		path->closed = (unsigned char)filePath.closed;
+		path->nbevel = filePath.nbevel;
+		path->fill = filePath.fill >= 0 ? list->vertices + filePath.fill : NULL;
+		path->nfill = filePath.fill >= 0 ? filePath.nfill : 0;
+		path->stroke = filePath.stroke >= 0 ? list->vertices + filePath.stroke : NULL;
+		path->nstroke = filePath.stroke >= 0 ? filePath.nstroke : 0;
+		path->winding = filePath.winding;
+		path->convex = filePath.convex;
+	}
+
+	list->ncommands = header.ncommands;
+	list->npaints = header.npaints;
+	list->nscissors = header.nscissors;
+	list->nxforms = header.nxforms;
+	list->nverts = header.nverts;
+	list->npaths = header.npaths;
+
+	if (!nvg__validDisplayListCommands(list))
+	{
+		nvgResetDisplayList(list);
+		return 0;
+	}
+
+	nvg__uploadDisplayList(ctx, list);
+	return 1;
+}
+
+static void nvg__setInstance(NVGinstance* instance, const NVGstate* state)
+{
+	memcpy(instance->xform, state->xform, sizeof(float)*6);
+	instance->tint = state->tint;
+	instance->tintFactor = state->tintFactor;
+	instance->alpha = state->alpha;
+}
+
+static NVGcolor nvg__tintColor(NVGcolor color, NVGcolor tint, float factor)
+{
+	float inverseFactor = 1.0f - factor;
+	color.r = (color.r * inverseFactor) + (tint.r * factor);
+	color.g = (color.g * inverseFactor) + (tint.g * factor);
+	color.b = (color.b * inverseFactor) + (tint.b * factor);
+	color.a = (color.a * inverseFactor) + (tint.a * factor);
+	return color;
+}
+
+// Returns the texel tint (with its amount in alpha) equivalent to mixing the given one and then the tint color
+// by amount.
+static NVGcolor nvg__combineTint(NVGcolor first, NVGcolor tint, float amount)
+{
+	NVGcolor result;
+	float firstWeight, tintWeight;
+
+	result.a = 1.0f - (1.0f - first.a) * (1.0f - amount);
+	if (result.a <= 0.0f)
+		return nvgRGBAf(0, 0, 0, 0);
+
+	firstWeight = first.a * (1.0f - amount) / result.a;
+	tintWeight = amount / result.a;
+	result.r = (first.r * firstWeight) + (tint.r * tintWeight);
+	result.g = (first.g * firstWeight) + (tint.g * tintWeight);
+	result.b = (first.b * firstWeight) + (tint.b * tintWeight);
+	return result;
+}
+
+static int nvg__isFontImage(NVGcontext* ctx, int image)
+{
+	int i;
+	for (i = 0; i < NVG_MAX_FONTIMAGES; i++)
+		if (ctx->fontImages[i] == image)
+			return 1;
+	return 0;
+}
+
+// Paint colors are tinted here. The texels of images are tinted by the back end, except the font atlas ones,
+// which are coverage values.
+static void nvg__tintPaint(NVGcontext* ctx, NVGpaint* paint, NVGcolor tint, float factor)
+{
+	if (factor <= 0.0f) return;
+
+	if (paint->image != 0 && !nvg__isFontImage(ctx, paint->image)) {
+		paint->tint = nvg__combineTint(paint->tint, tint, nvg__clampf(tint.a * factor, 0.0f, 1.0f));
+	} else {
+		paint->innerColor = nvg__tintColor(paint->innerColor, tint, factor);
+		paint->outerColor = nvg__tintColor(paint->outerColor, tint, factor);
+	}
+}
+
+// Passes the display list commands to the back end, with the given instance applied to them. If ninstances
+// is not zero, the commands are drawn instead for the instances stored in the back end at the given offset.
+static void nvg__drawDisplayList(NVGcontext* ctx, NVGdisplayList* list, const NVGinstance* instance,
+                                 const NVGscissor* currentScissor, float invscale, int instances, int ninstances)
 {
-	NVGstate* state = nvg__getState(ctx);
 	float t[6];
     int i;
-	NVGpaint paint;
-	NVGscissor tmpScissor;
+	NVGpaint paint, solidPaint;
+	NVGscissor noScissor, tmpScissor;
     NVGdisplayListCommand * cmd;
-    float invscale = 1.0f / nvg__getAverageScale(state->xform);
+	const float* xform;
+
+	// Draw from the back end vertex buffer, unless the commands are being recorded in another display list:
+	int buffer = ctx->displayList == NULL ? list->buffer : 0;
 	
 	NVGscissor * cmdScissor = NULL;
-	NVGscissor currentScissor = state->scissor;
-	
-	if (currentScissor.extent[0] >= 0)
-	{
-#if !NVG_TRANSFORM_IN_VERTEX_SHADER
-        float invStateTx[6];
-        nvgTransformInverse(invStateTx, state->xform);
-        nvgTransformMultiply(currentScissor.xform, invStateTx);
-#else
-		nvgTransformMultiply(currentScissor.xform, state->invxform);
-#endif
-	}
+
+	nvg__setPaintColor(&solidPaint, nvgRGBA(0, 0, 0, 0));
+	nvg__resetScissor(&noScissor);
 	
-	for (i=0; i<list->ncommands; ++i)
+	for (i=0; i<list->ncommands; i += cmd->size)
 	{
-		cmd = &list->commands[i];
+		cmd = (NVGdisplayListCommand*)(list->commands + i);
+		xform = &list->xforms[cmd->xform*6];
 
-        paint = cmd->paint;
-        paint.innerColor.a *= state->alpha;
-        paint.outerColor.a *= state->alpha;
-		
-		cmdScissor = &cmd->scissor;
-		
-		//need to combine current scissor with cached one?
-		if (currentScissor.extent[0] >= 0)
+		if (cmd->solid)
 		{
-			if (cmdScissor->extent[0] >= 0)
-			{
-				//combine current and cached scissor
-				cmdScissor = nvg__combineScissor(cmdScissor, &currentScissor, &tmpScissor);
-			}
-			else
+			paint = solidPaint;
+			memcpy(&paint.innerColor, cmd + 1, sizeof(NVGcolor));
+			paint.outerColor = paint.innerColor;
+		}
+		else
+		{
+			paint = list->paints[*(const int*)(cmd + 1)];
+		}
+
+		cmdScissor = cmd->scissor >= 0 ? &list->scissors[cmd->scissor] : &noScissor;
+		memcpy(t, xform, sizeof(float)*6);
+
+		// The back end applies the instances transform, tint and alpha:
+		if (ninstances == 0)
+		{
+			nvg__tintPaint(ctx, &paint, instance->tint, instance->tintFactor);
+
+	        paint.innerColor.a *= instance->alpha;
+	        paint.outerColor.a *= instance->alpha;
+			
+			//need to combine current scissor with cached one?
+			if (currentScissor != NULL && currentScissor->extent[0] >= 0)
 			{
-				//use current scissor if no cached
-				cmdScissor = &currentScissor;
+				//the current scissor is relative to the instance, the cached one to the command transform
+				float invCmdXform[6];
+				NVGscissor cmdCurrentScissor = *currentScissor;
+				nvgTransformInverse(invCmdXform, xform);
+				nvgTransformMultiply(cmdCurrentScissor.xform, invCmdXform);
+
+				if (cmdScissor->extent[0] >= 0)
+				{
+					//combine current and cached scissor
+					cmdScissor = nvg__combineScissor(cmdScissor, &cmdCurrentScissor, &tmpScissor);
+				}
+				else
+				{
+					//use current scissor if no cached
+					tmpScissor = cmdCurrentScissor;
+					cmdScissor = &tmpScissor;
+				}
 			}
+			
+			nvgTransformMultiply(t, instance->xform);
 		}
-		
-		memcpy(t, cmd->xform, sizeof(float)*6);
-		nvgTransformMultiply(t, state->xform);
 
 		switch( cmd->type )
 		{
 		case NVG_COMMAND_FILL:
 		{
-            if (cmd->fillParams.path >= 0)
+			NVGfillParams* params = (NVGfillParams*)nvg__displayListCommandParams(cmd);
+            if (params->path >= 0)
             {
-                NVGpath* paths = &list->paths[cmd->fillParams.path];
-                float fringe = cmd->fillParams.fringe * invscale;
-
-                ctx->renderFill(ctx, &paint, cmdScissor, t,
-                                fringe, cmd->fillParams.bounds, paths, cmd->fillParams.npaths);
+                NVGpath* paths = &list->paths[params->path];
+                float fringe = params->fringe * invscale;
+
+                if (buffer != 0)
+                    ctx->params.renderFillBuffer(ctx->params.userPtr, &paint, cmdScissor, t, fringe, buffer,
+                                                 params->quad, list->vertices, paths, params->npaths,
+                                                 instances, ninstances);
+                else
+                    ctx->renderFill(ctx, &paint, cmdScissor, t,
+                                    fringe, params->bounds, paths, params->npaths);
             }
 		} break;
 		case NVG_COMMAND_STROKE:
 		{
-            if (cmd->strokeParams.path >= 0)
+			NVGstrokeParams* params = (NVGstrokeParams*)nvg__displayListCommandParams(cmd);
+            if (params->path >= 0)
             {
-                NVGpath* paths = &list->paths[cmd->strokeParams.path];
-                float fringe = cmd->strokeParams.fringe * invscale;
-
-                ctx->renderStroke(ctx, &paint, cmdScissor, t,
-                                  fringe, cmd->strokeParams.strokeWidth, paths, cmd->strokeParams.npaths);
+                NVGpath* paths = &list->paths[params->path];
+                float fringe = params->fringe * invscale;
+
+                if (buffer != 0)
+                    ctx->params.renderStrokeBuffer(ctx->params.userPtr, &paint, cmdScissor, t, fringe,
+                                                   params->strokeWidth, buffer, list->vertices, paths,
+                                                   params->npaths, instances, ninstances);
+                else
+                    ctx->renderStroke(ctx, &paint, cmdScissor, t,
+                                      fringe, params->strokeWidth, paths, params->npaths);
             }
 		} break;
 		case NVG_COMMAND_TRIANGLE:
 		{
-            if (cmd->triangleParams.vertices >= 0)
+			NVGtriangleParams* params = (NVGtriangleParams*)nvg__displayListCommandParams(cmd);
+            if (params->vertices >= 0)
             {
-                NVGvertex * vtx = &list->vertices[cmd->triangleParams.vertices];
-                ctx->renderTriangles(ctx, &paint, cmdScissor, t,
-                                     vtx, cmd->triangleParams.nverts);
+                NVGvertex * vtx = &list->vertices[params->vertices];
+
+                if (buffer != 0)
+                    ctx->params.renderTrianglesBuffer(ctx->params.userPtr, &paint, cmdScissor, t, buffer,
+                                                      params->vertices, params->nverts,
+                                                      instances, ninstances);
+                else
+                    ctx->renderTriangles(ctx, &paint, cmdScissor, t,
+                                         vtx, params->nverts);
             }
 		} break;
 		};
 	}
 }
 
+static void nvg__flushInstances(NVGcontext* ctx)
+{
+	NVGdisplayList* list = ctx->instanceList;
+	int i, instances = -1;
+
+	if (list == NULL) return;
+	ctx->instanceList = NULL;
+
+	// A single instance is drawn as usual:
+	if (ctx->ninstances > 1)
+		instances = ctx->params.renderInstances(ctx->params.userPtr, ctx->instances, ctx->ninstances);
+
+	if (instances >= 0)
+	{
+		nvg__drawDisplayList(ctx, list, NULL, NULL, ctx->instanceFringeScale, instances, ctx->ninstances);
+	}
+	else
+	{
+		for (i = 0; i < ctx->ninstances; ++i)
+			nvg__drawDisplayList(ctx, list, &ctx->instances[i], NULL, ctx->instanceFringeScale, 0, 0);
+	}
+
+	ctx->ninstances = 0;
+}
+
+void nvgDrawDisplayList(NVGcontext* ctx, NVGdisplayList* list)
+{
+	NVGstate* state = nvg__getState(ctx);
+	NVGinstance instance;
+	NVGscissor currentScissor = state->scissor;
+
+	nvg__flushInstances(ctx);
+	
+	if (currentScissor.extent[0] >= 0)
+	{
+#if !NVG_TRANSFORM_IN_VERTEX_SHADER
+        float invStateTx[6];
+        nvgTransformInverse(invStateTx, state->xform);
+        nvgTransformMultiply(currentScissor.xform, invStateTx);
+#else
+		nvgTransformMultiply(currentScissor.xform, state->invxform);
+#endif
+	}
+
+	nvg__setInstance(&instance, state);
+	nvg__drawDisplayList(ctx, list, &instance, &currentScissor, 1.0f / nvg__getAverageScale(state->xform), 0, 0);
+}
+
+void nvgDrawDisplayListInstance(NVGcontext* ctx, NVGdisplayList* list)
+{
+	NVGstate* state = nvg__getState(ctx);
+	float fringeScale;
+
+	// Instances are drawn from the back end vertex buffer, without scissor:
+	if (ctx->params.renderInstances == NULL || ctx->displayList != NULL || list->buffer == 0 ||
+		state->scissor.extent[0] >= 0)
+	{
+		nvgDrawDisplayList(ctx, list);
+		return;
+	}
+
+	if (list->nscissors > 0)
+	{
+		nvgDrawDisplayList(ctx, list);
+		return;
+	}
+
+	// All the instances of a batch share the same fringe width:
+	fringeScale = 1.0f / nvg__getAverageScale(state->xform);
+	if (ctx->instanceList != list ||
+		nvg__absf(fringeScale - ctx->instanceFringeScale) > ctx->instanceFringeScale * 1e-3f)
+	{
+		nvg__flushInstances(ctx);
+		ctx->instanceList = list;
+		ctx->instanceFringeScale = fringeScale;
+	}
+
+	if (ctx->ninstances+1 > ctx->cinstances)
+	{
+		NVGinstance* instances;
+		int cinstances = nvg__maxi(ctx->ninstances+1, 64) + ctx->cinstances/2; // 1.5x Overallocate
+		instances = (NVGinstance*)realloc(ctx->instances, sizeof(NVGinstance)*cinstances);
+		if (instances == NULL)
+		{
+			nvgDrawDisplayList(ctx, list);
+			return;
+		}
+		ctx->instances = instances;
+		ctx->cinstances = cinstances;
+	}
+
+	nvg__setInstance(&ctx->instances[ctx->ninstances++], state);
+}
+
+int nvgIsDisplayListOutdated(NVGcontext* ctx, NVGdisplayList* list)
+{
+	// Font images other than the current one are deleted at the end of the frame:
+	return list->fontImage != 0 && list->fontImage != ctx->fontImages[ctx->fontImageIdx];
+}
+
 int nvgFindOutdatedDisplayListResources(NVGcontext * ctx)
 {
 	int r = 0;
@@ -1110,6 +1954,13 @@ void nvgGlobalAlpha(NVGcontext* ctx, float alpha)
 	state->alpha = alpha;
 }
 
+void nvgGlobalTint(NVGcontext* ctx, NVGcolor tint, float factor)
+{
+	NVGstate* state = nvg__getState(ctx);
+	state->tint = tint;
+	state->tintFactor = factor;
+}
+
 void nvgTransform(NVGcontext* ctx, float a, float b, float c, float d, float e, float f)
 {
 	NVGstate* state = nvg__getState(ctx);
@@ -1265,6 +2116,13 @@ void nvgUpdateImage(NVGcontext* ctx, int image, const unsigned char* data)
 	ctx->params.renderUpdateTexture(ctx->params.userPtr, image, 0,0, w,h, data);
 }
 
+void nvgUpdateImageRows(NVGcontext* ctx, int image, int y, int h, const unsigned char* data)
+{
+	int w, ih;
+	ctx->params.renderGetTextureSize(ctx->params.userPtr, image, &w, &ih);
+	ctx->params.renderUpdateTexture(ctx->params.userPtr, image, 0,y, w,h, data);
+}
+
 void nvgImageSize(NVGcontext* ctx, int image, int* w, int* h)
 {
 	ctx->params.renderGetTextureSize(ctx->params.userPtr, image, w, h);
@@ -1748,47 +2606,161 @@ static void nvg__vset(NVGvertex* vtx, float x, float y, float u, float v)
 	vtx->v = v;
 }
 
+#if NVG_SSE2
+
+typedef __m128 nvg__f4;
+
+static nvg__f4 nvg__f4Load(const float* v) { return _mm_loadu_ps(v); }
+static void nvg__f4Store(float* v, nvg__f4 a) { _mm_storeu_ps(v, a); }
+static nvg__f4 nvg__f4Set(float a, float b, float c, float d) { return _mm_setr_ps(a, b, c, d); }
+static nvg__f4 nvg__f4Splat(float a) { return _mm_set1_ps(a); }
+static nvg__f4 nvg__f4Add(nvg__f4 a, nvg__f4 b) { return _mm_add_ps(a, b); }
+static nvg__f4 nvg__f4Mul(nvg__f4 a, nvg__f4 b) { return _mm_mul_ps(a, b); }
+static nvg__f4 nvg__f4Div(nvg__f4 a, nvg__f4 b) { return _mm_div_ps(a, b); }
+static nvg__f4 nvg__f4Min(nvg__f4 a, nvg__f4 b) { return _mm_min_ps(a, b); }
+static nvg__f4 nvg__f4Max(nvg__f4 a, nvg__f4 b) { return _mm_max_ps(a, b); }
+static nvg__f4 nvg__f4Sub(nvg__f4 a, nvg__f4 b) { return _mm_sub_ps(a, b); }
+static nvg__f4 nvg__f4Neg(nvg__f4 a) { return _mm_xor_ps(a, _mm_set1_ps(-0.0f)); }
+// Returns b where a > c, otherwise d.
+static nvg__f4 nvg__f4SelectGt(nvg__f4 a, nvg__f4 c, nvg__f4 b, nvg__f4 d)
+{
+	nvg__f4 mask = _mm_cmpgt_ps(a, c);
+	return _mm_or_ps(_mm_and_ps(mask, b), _mm_andnot_ps(mask, d));
+}
+// (a0,a1,b0,b1), (a0,a1,b2,b3) and (a2,a3,b0,b1).
+static nvg__f4 nvg__f4LoLo(nvg__f4 a, nvg__f4 b) { return _mm_movelh_ps(a, b); }
+static nvg__f4 nvg__f4LoHi(nvg__f4 a, nvg__f4 b) { return _mm_shuffle_ps(a, b, _MM_SHUFFLE(3,2,1,0)); }
+static nvg__f4 nvg__f4HiLo(nvg__f4 a, nvg__f4 b) { return _mm_shuffle_ps(a, b, _MM_SHUFFLE(1,0,3,2)); }
+
+#elif NVG_NEON
+
+typedef float32x4_t nvg__f4;
+
+static nvg__f4 nvg__f4Load(const float* v) { return vld1q_f32(v); }
+static void nvg__f4Store(float* v, nvg__f4 a) { vst1q_f32(v, a); }
+static nvg__f4 nvg__f4Set(float a, float b, float c, float d) { float v[4] = { a, b, c, d }; return vld1q_f32(v); }
+static nvg__f4 nvg__f4Splat(float a) { return vdupq_n_f32(a); }
+static nvg__f4 nvg__f4Add(nvg__f4 a, nvg__f4 b) { return vaddq_f32(a, b); }
+static nvg__f4 nvg__f4Mul(nvg__f4 a, nvg__f4 b) { return vmulq_f32(a, b); }
+static nvg__f4 nvg__f4Sub(nvg__f4 a, nvg__f4 b) { return vsubq_f32(a, b); }
+static nvg__f4 nvg__f4Neg(nvg__f4 a) { return vnegq_f32(a); }
+static nvg__f4 nvg__f4Div(nvg__f4 a, nvg__f4 b)
+{
+#if defined(__aarch64__)
+	return vdivq_f32(a, b);
+#else
+	float va[4], vb[4];
+	vst1q_f32(va, a);
+	vst1q_f32(vb, b);
+	va[0] /= vb[0]; va[1] /= vb[1]; va[2] /= vb[2]; va[3] /= vb[3];
+	return vld1q_f32(va);
+#endif
+}
+// Same as nvg__minf and nvg__maxf, instead of vminq_f32 and vmaxq_f32, which differ with NaNs.
+static nvg__f4 nvg__f4Min(nvg__f4 a, nvg__f4 b) { return vbslq_f32(vcltq_f32(a, b), a, b); }
+static nvg__f4 nvg__f4Max(nvg__f4 a, nvg__f4 b) { return vbslq_f32(vcgtq_f32(a, b), a, b); }
+// Returns b where a > c, otherwise d.
+static nvg__f4 nvg__f4SelectGt(nvg__f4 a, nvg__f4 c, nvg__f4 b, nvg__f4 d) { return vbslq_f32(vcgtq_f32(a, c), b, d); }
+// (a0,a1,b0,b1), (a0,a1,b2,b3) and (a2,a3,b0,b1).
+static nvg__f4 nvg__f4LoLo(nvg__f4 a, nvg__f4 b) { return vcombine_f32(vget_low_f32(a), vget_low_f32(b)); }
+static nvg__f4 nvg__f4LoHi(nvg__f4 a, nvg__f4 b) { return vcombine_f32(vget_low_f32(a), vget_high_f32(b)); }
+static nvg__f4 nvg__f4HiLo(nvg__f4 a, nvg__f4 b) { return vcombine_f32(vget_high_f32(a), vget_low_f32(b)); }
+
+#endif
+
+// Splits the cubic bezier c (x1,y1, x2,y2, x3,y3, x4,y4) in half. left can be c, right can't.
+static void nvg__splitBezier(const float* c, float* left, float* right, int simd)
+{
+#if NVG_SIMD
+	if (simd) {
+		nvg__f4 half = nvg__f4Splat(0.5f);
+		nvg__f4 a = nvg__f4Load(c);		// x1,y1, x2,y2
+		nvg__f4 b = nvg__f4Load(c + 4);	// x3,y3, x4,y4
+		nvg__f4 p12_23 = nvg__f4Mul(nvg__f4Add(a, nvg__f4HiLo(a, b)), half);
+		nvg__f4 p34 = nvg__f4Mul(nvg__f4Add(b, nvg__f4HiLo(b, b)), half);
+		nvg__f4 p123_234 = nvg__f4Mul(nvg__f4Add(p12_23, nvg__f4HiLo(p12_23, p34)), half);
+		nvg__f4 p1234 = nvg__f4Mul(nvg__f4Add(p123_234, nvg__f4HiLo(p123_234, p123_234)), half);
+		nvg__f4Store(left, nvg__f4LoLo(a, p12_23));
+		nvg__f4Store(left + 4, nvg__f4LoLo(p123_234, p1234));
+		nvg__f4Store(right, nvg__f4LoHi(p1234, p123_234));
+		nvg__f4Store(right + 4, nvg__f4LoHi(p34, b));
+		return;
+	}
+#else
+	NVG_NOTUSED(simd);
+#endif
+	{
+		float x12 = (c[0]+c[2])*0.5f;
+		float y12 = (c[1]+c[3])*0.5f;
+		float x23 = (c[2]+c[4])*0.5f;
+		float y23 = (c[3]+c[5])*0.5f;
+		float x34 = (c[4]+c[6])*0.5f;
+		float y34 = (c[5]+c[7])*0.5f;
+		float x123 = (x12+x23)*0.5f;
+		float y123 = (y12+y23)*0.5f;
+		float x234 = (x23+x34)*0.5f;
+		float y234 = (y23+y34)*0.5f;
+		float x1234 = (x123+x234)*0.5f;
+		float y1234 = (y123+y234)*0.5f;
+		// The right half is written first, so left can be c:
+		right[0] = x1234; right[1] = y1234;
+		right[2] = x234; right[3] = y234;
+		right[4] = x34; right[5] = y34;
+		right[6] = c[6]; right[7] = c[7];
+		left[0] = c[0]; left[1] = c[1];
+		left[2] = x12; left[3] = y12;
+		left[4] = x123; left[5] = y123;
+		left[6] = x1234; left[7] = y1234;
+	}
+}
+
+// Same subdivision as the recursive version, with an explicit stack of the pending right halves.
 static void nvg__tesselateBezier(NVGcontext* ctx, float scale,
 								 float x1, float y1, float x2, float y2,
 								 float x3, float y3, float x4, float y4,
 								 int level, int type)
 {
-	float x12,y12,x23,y23,x34,y34,x123,y123,x234,y234,x1234,y1234;
-	float dx,dy,d2,d3;
-	
-	if (level > 10) return;
-
-	x12 = (x1+x2)*0.5f;
-	y12 = (y1+y2)*0.5f;
-	x23 = (x2+x3)*0.5f;
-	y23 = (y2+y3)*0.5f;
-	x34 = (x3+x4)*0.5f;
-	y34 = (y3+y4)*0.5f;
-	x123 = (x12+x23)*0.5f;
-	y123 = (y12+y23)*0.5f;
-
-	dx = x4 - x1;
-	dy = y4 - y1;
-	d2 = nvg__absf(((x2 - x4) * dy - (y2 - y4) * dx));
-	d3 = nvg__absf(((x3 - x4) * dy - (y3 - y4) * dx));
-
-	if ((d2 + d3)*(d2 + d3) < ctx->tessTol * scale * (dx*dx + dy*dy)) {
-		nvg__addPoint(ctx, x4, y4, type);
-		return;
-	}
-
-/*	if (nvg__absf(x1+x3-x2-x2) + nvg__absf(y1+y3-y2-y2) + nvg__absf(x2+x4-x3-x3) + nvg__absf(y2+y4-y3-y3) < ctx->tessTol) {
-		nvg__addPoint(ctx, x4, y4, type);
-		return;
-	}*/
+	float stack[12][8];
+	int stackLevels[12];
+	int stackTypes[12];
+	int nstack = 0;
+	float curve[8];
+	float tol = ctx->tessTol * scale;
+
+	curve[0] = x1; curve[1] = y1;
+	curve[2] = x2; curve[3] = y2;
+	curve[4] = x3; curve[5] = y3;
+	curve[6] = x4; curve[7] = y4;
+
+	for (;;) {
+		if (level <= 10) {
+			float dx = curve[6] - curve[0];
+			float dy = curve[7] - curve[1];
+			float d2 = nvg__absf(((curve[2] - curve[6]) * dy - (curve[3] - curve[7]) * dx));
+			float d3 = nvg__absf(((curve[4] - curve[6]) * dy - (curve[5] - curve[7]) * dx));
+
+			if ((d2 + d3)*(d2 + d3) < tol * (dx*dx + dy*dy)) {
+				nvg__addPoint(ctx, curve[6], curve[7], type);
+			} else {
+				// The left half is tessellated first, without the point type:
+				nvg__splitBezier(curve, curve, stack[nstack], ctx->simd);
+				stackLevels[nstack] = level+1;
+				stackTypes[nstack] = type;
+				nstack++;
+				level++;
+				type = 0;
+				continue;
+			}
+		}
 
-	x234 = (x23+x34)*0.5f;
-	y234 = (y23+y34)*0.5f;
-	x1234 = (x123+x234)*0.5f;
-	y1234 = (y123+y234)*0.5f;
+		if (nstack == 0)
+			break;
 
-	nvg__tesselateBezier(ctx, scale, x1,y1, x12,y12, x123,y123, x1234,y1234, level+1, 0);
-	nvg__tesselateBezier(ctx, scale, x1234,y1234, x234,y234, x34,y34, x4,y4, level+1, type);
+		nstack--;
+		memcpy(curve, stack[nstack], sizeof(curve));
+		level = stackLevels[nstack];
+		type = stackTypes[nstack];
+	}
 }
 
 static void nvg__flattenPaths(NVGcontext* ctx, float scale)
@@ -2173,10 +3145,75 @@ static NVGvertex* nvg__roundCapEnd(NVGvertex* dst, NVGpoint* p,
 }
 
 
+// Calculates the extrusions of the points p1[0..n-1], whose previous points are p0[0..n-1], and stores for
+// each one the squared length of the unscaled extrusion, the turn cross product and the inner miter limit.
+static void nvg__calculateExtrusions(NVGpoint** p0, NVGpoint** p1, int n, float iw,
+									 float* dmr2, float* cross, float* limit, int simd)
+{
+	int i = 0;
+#if NVG_SIMD
+	nvg__f4 half = nvg__f4Splat(0.5f);
+	nvg__f4 one = nvg__f4Splat(1.0f);
+	nvg__f4 minDmr2 = nvg__f4Splat(0.000001f);
+	nvg__f4 maxScale = nvg__f4Splat(600.0f);
+	nvg__f4 minLimit = nvg__f4Splat(1.01f);
+	nvg__f4 iw4 = nvg__f4Splat(iw);
+	for (; simd && i + 4 <= n; i += 4) {
+		NVGpoint** a = p0 + i;
+		NVGpoint** b = p1 + i;
+		nvg__f4 dx0 = nvg__f4Set(a[0]->dx, a[1]->dx, a[2]->dx, a[3]->dx);
+		nvg__f4 dy0 = nvg__f4Set(a[0]->dy, a[1]->dy, a[2]->dy, a[3]->dy);
+		nvg__f4 len0 = nvg__f4Set(a[0]->len, a[1]->len, a[2]->len, a[3]->len);
+		nvg__f4 dx1 = nvg__f4Set(b[0]->dx, b[1]->dx, b[2]->dx, b[3]->dx);
+		nvg__f4 dy1 = nvg__f4Set(b[0]->dy, b[1]->dy, b[2]->dy, b[3]->dy);
+		nvg__f4 len1 = nvg__f4Set(b[0]->len, b[1]->len, b[2]->len, b[3]->len);
+		nvg__f4 dmx = nvg__f4Mul(nvg__f4Add(dy0, dy1), half);
+		nvg__f4 dmy = nvg__f4Mul(nvg__f4Add(nvg__f4Neg(dx0), nvg__f4Neg(dx1)), half);
+		nvg__f4 r2 = nvg__f4Add(nvg__f4Mul(dmx, dmx), nvg__f4Mul(dmy, dmy));
+		nvg__f4 scale = nvg__f4SelectGt(r2, minDmr2, nvg__f4Min(nvg__f4Div(one, r2), maxScale), one);
+		float vdmx[4], vdmy[4];
+		int k;
+		nvg__f4Store(vdmx, nvg__f4Mul(dmx, scale));
+		nvg__f4Store(vdmy, nvg__f4Mul(dmy, scale));
+		nvg__f4Store(dmr2 + i, r2);
+		nvg__f4Store(cross + i, nvg__f4Sub(nvg__f4Mul(dx1, dy0), nvg__f4Mul(dx0, dy1)));
+		nvg__f4Store(limit + i, nvg__f4Max(minLimit, nvg__f4Mul(nvg__f4Min(len0, len1), iw4)));
+		for (k = 0; k < 4; k++) {
+			b[k]->dmx = vdmx[k];
+			b[k]->dmy = vdmy[k];
+		}
+	}
+#else
+	NVG_NOTUSED(simd);
+#endif
+	for (; i < n; i++) {
+		NVGpoint* a = p0[i];
+		NVGpoint* b = p1[i];
+		float dlx0, dly0, dlx1, dly1;
+		dlx0 = a->dy;
+		dly0 = -a->dx;
+		dlx1 = b->dy;
+		dly1 = -b->dx;
+		b->dmx = (dlx0 + dlx1) * 0.5f;
+		b->dmy = (dly0 + dly1) * 0.5f;
+		dmr2[i] = b->dmx*b->dmx + b->dmy*b->dmy;
+		if (dmr2[i] > 0.000001f) {
+			float scale = 1.0f / dmr2[i];
+			if (scale > 600.0f) {
+				scale = 600.0f;
+			}
+			b->dmx *= scale;
+			b->dmy *= scale;
+		}
+		cross[i] = b->dx * a->dy - a->dx * b->dy;
+		limit[i] = nvg__maxf(1.01f, nvg__minf(a->len, b->len) * iw);
+	}
+}
+
 static void nvg__calculateJoins(NVGcontext* ctx, float w, int lineJoin, float miterLimit)
 {
 	NVGpathCache* cache = ctx->cache;
-	int i, j;
+	int i, j, k;
 	float iw = 0.0f;
 
 	if (w > 0.0f) iw = 1.0f / w;
@@ -2185,57 +3222,50 @@ static void nvg__calculateJoins(NVGcontext* ctx, float w, int lineJoin, float mi
 	for (i = 0; i < cache->npaths; i++) {
 		NVGpath* path = &cache->paths[i];
 		NVGpoint* pts = &cache->points[path->first];
-		NVGpoint* p0 = &pts[path->count-1];
-		NVGpoint* p1 = &pts[0];
 		int nleft = 0;
 
 		path->nbevel = 0;
 
-		for (j = 0; j < path->count; j++) {
-			float dlx0, dly0, dlx1, dly1, dmr2, cross, limit;
-			dlx0 = p0->dy;
-			dly0 = -p0->dx;
-			dlx1 = p1->dy;
-			dly1 = -p1->dx;
-			// Calculate extrusions
-			p1->dmx = (dlx0 + dlx1) * 0.5f;
-			p1->dmy = (dly0 + dly1) * 0.5f;
-			dmr2 = p1->dmx*p1->dmx + p1->dmy*p1->dmy;
-			if (dmr2 > 0.000001f) {
-				float scale = 1.0f / dmr2;
-				if (scale > 600.0f) {
-					scale = 600.0f;
-				}
-				p1->dmx *= scale;
-				p1->dmy *= scale;
+		// Extrusions are calculated in batches, then the joins are classified one by one.
+		for (j = 0; j < path->count; j += 16) {
+			NVGpoint* p0[16];
+			NVGpoint* p1[16];
+			float dmr2[16], cross[16], limit[16];
+			int n = nvg__mini(16, path->count - j);
+
+			for (k = 0; k < n; k++) {
+				p0[k] = &pts[j+k > 0 ? j+k-1 : path->count-1];
+				p1[k] = &pts[j+k];
 			}
 
-			// Clear flags, but keep the corner.
-			p1->flags = (p1->flags & NVG_PT_CORNER) ? NVG_PT_CORNER : 0;
+			nvg__calculateExtrusions(p0, p1, n, iw, dmr2, cross, limit, ctx->simd);
 
-			// Keep track of left turns.
-			cross = p1->dx * p0->dy - p0->dx * p1->dy;
-			if (cross > 0.0f) {
-				nleft++;
-				p1->flags |= NVG_PT_LEFT;
-			}
+			for (k = 0; k < n; k++) {
+				NVGpoint* p = p1[k];
 
-			// Calculate if we should use bevel or miter for inner join.
-			limit = nvg__maxf(1.01f, nvg__minf(p0->len, p1->len) * iw);
-			if ((dmr2 * limit*limit) < 1.0f)
-				p1->flags |= NVG_PR_INNERBEVEL;
+				// Clear flags, but keep the corner.
+				p->flags = (p->flags & NVG_PT_CORNER) ? NVG_PT_CORNER : 0;
 
-			// Check to see if the corner needs to be beveled.
-			if (p1->flags & NVG_PT_CORNER) {
-				if ((dmr2 * miterLimit*miterLimit) < 1.0f || lineJoin == NVG_BEVEL || lineJoin == NVG_ROUND) {
-					p1->flags |= NVG_PT_BEVEL;
+				// Keep track of left turns.
+				if (cross[k] > 0.0f) {
+					nleft++;
+					p->flags |= NVG_PT_LEFT;
 				}
-			}
 
-			if ((p1->flags & (NVG_PT_BEVEL | NVG_PR_INNERBEVEL)) != 0)
-				path->nbevel++;
+				// Calculate if we should use bevel or miter for inner join.
+				if ((dmr2[k] * limit[k]*limit[k]) < 1.0f)
+					p->flags |= NVG_PR_INNERBEVEL;
 
-			p0 = p1++;
+				// Check to see if the corner needs to be beveled.
+				if (p->flags & NVG_PT_CORNER) {
+					if ((dmr2[k] * miterLimit*miterLimit) < 1.0f || lineJoin == NVG_BEVEL || lineJoin == NVG_ROUND) {
+						p->flags |= NVG_PT_BEVEL;
+					}
+				}
+
+				if ((p->flags & (NVG_PT_BEVEL | NVG_PR_INNERBEVEL)) != 0)
+					path->nbevel++;
+			}
 		}
 
 		path->convex = (nleft == path->count) ? 1 : 0;
@@ -2761,7 +3791,8 @@ void nvgFill(NVGcontext* ctx)
 	else
 		nvg__expandFill(ctx, 0.0f, NVG_MITER, 2.4f, invscale);
 
-	// Apply global alpha
+	// Apply global tint and alpha
+	nvg__tintPaint(ctx, &fillPaint, state->tint, state->tintFactor);
 	fillPaint.innerColor.a *= state->alpha;
 	fillPaint.outerColor.a *= state->alpha;
 
@@ -2816,7 +3847,8 @@ void nvgStroke(NVGcontext* ctx)
 		strokeWidth = fringeWidth;
 	}
 
-	// Apply global alpha
+	// Apply global tint and alpha
+	nvg__tintPaint(ctx, &strokePaint, state->tint, state->tintFactor);
 	strokePaint.innerColor.a *= state->alpha;
 	strokePaint.outerColor.a *= state->alpha;
 
@@ -2860,7 +3892,8 @@ static void nvg__renderTrianglesSimple(NVGcontext* ctx, const NVGvertex* verts,
 #if	NVG_TRANSFORM_IN_VERTEX_SHADER
 	const float * invxform = state->invxform;
 #endif 
-	// Apply global alpha
+	// Apply global tint and alpha
+	nvg__tintPaint(ctx, &paint, state->tint, state->tintFactor);
 	paint.innerColor.a *= state->alpha;
 	paint.outerColor.a *= state->alpha;
 
@@ -2970,6 +4003,102 @@ void nvgStrokeRectSimple(NVGcontext* ctx, float x1, float y1, float w, float h,
 	}
 }
 
+static void nvg__spriteVset(NVGspriteVertex* vtx, float x, float y, float u, float v, const unsigned char* tint,
+							float alpha)
+{
+	vtx->x = x;
+	vtx->y = y;
+	vtx->u = u;
+	vtx->v = v;
+	memcpy(vtx->tint, tint, sizeof(vtx->tint));
+	vtx->alpha = alpha;
+}
+
+// Display lists and back ends without sprites support get textured triangles with the tint in their paint
+static void nvg__renderSpriteTriangles(NVGcontext* ctx, int image, float x, float y, float w, float h,
+									   const float* uv, NVGcolor tint, float alpha)
+{
+#if	!NVG_TRANSFORM_IN_VERTEX_SHADER
+	NVGstate* state = nvg__getState(ctx);
+#endif
+	NVGpaint paint;
+	float x1 = x, y1 = y, x2 = x + w, y2 = y + h;
+	float x3 = x2, y3 = y1, x4 = x1, y4 = y2;
+
+#if	!NVG_TRANSFORM_IN_VERTEX_SHADER
+	nvgTransformPoint(&x1, &y1, state->xform, x, y);
+	nvgTransformPoint(&x2, &y2, state->xform, x + w, y + h);
+	nvgTransformPoint(&x3, &y3, state->xform, x + w, y);
+	nvgTransformPoint(&x4, &y4, state->xform, x, y + h);
+#endif
+
+	{
+		NVGvertex verts[] =
+		{
+			{x1, y1, uv[0], uv[1]},
+			{x2, y2, uv[2], uv[3]},
+			{x3, y3, uv[2], uv[1]},
+
+			{x1, y1, uv[0], uv[1]},
+			{x4, y4, uv[0], uv[3]},
+			{x2, y2, uv[2], uv[3]}
+		};
+
+		nvg__setPaintColor(&paint, nvgRGBAf(1, 1, 1, alpha));
+		paint.image = image;
+		paint.tint = tint;
+		nvg__renderTrianglesSimple(ctx, verts, NVG_COUNTOF(verts), &paint);
+	}
+}
+
+void nvgSprite(NVGcontext* ctx, int image, float x, float y, float w, float h,
+			   float s0, float t0, float s1, float t1, NVGcolor tint, float tintFactor, float alpha)
+{
+	NVGstate* state = nvg__getState(ctx);
+	NVGspriteVertex verts[6];
+	float corners[8];
+	float uv[4] = { s0, t0, s1, t1 };
+	unsigned char color[4];
+
+	// The tint amount is kept in the tint alpha
+	tint.a = nvg__clampf(tint.a * tintFactor, 0.0f, 1.0f);
+
+	if (ctx->displayList != NULL || ctx->params.renderSprites == NULL) {
+		nvg__renderSpriteTriangles(ctx, image, x, y, w, h, uv, tint, alpha);
+		return;
+	}
+
+	if (state->tintFactor > 0.0f)
+		tint = nvg__combineTint(tint, state->tint, nvg__clampf(state->tint.a * state->tintFactor, 0.0f, 1.0f));
+
+	color[0] = (unsigned char)(nvg__clampf(tint.r, 0.0f, 1.0f) * 255.0f + 0.5f);
+	color[1] = (unsigned char)(nvg__clampf(tint.g, 0.0f, 1.0f) * 255.0f + 0.5f);
+	color[2] = (unsigned char)(nvg__clampf(tint.b, 0.0f, 1.0f) * 255.0f + 0.5f);
+	color[3] = (unsigned char)(tint.a * 255.0f + 0.5f);
+	alpha *= state->alpha;
+
+	// Sprites are always transformed here, so the back end can append them to the previous ones:
+	nvgTransformPoint(&corners[0], &corners[1], state->xform, x, y);
+	nvgTransformPoint(&corners[2], &corners[3], state->xform, x + w, y);
+	nvgTransformPoint(&corners[4], &corners[5], state->xform, x + w, y + h);
+	nvgTransformPoint(&corners[6], &corners[7], state->xform, x, y + h);
+
+	nvg__spriteVset(&verts[0], corners[0], corners[1], s0, t0, color, alpha);
+	nvg__spriteVset(&verts[1], corners[4], corners[5], s1, t1, color, alpha);
+	nvg__spriteVset(&verts[2], corners[2], corners[3], s1, t0, color, alpha);
+	nvg__spriteVset(&verts[3], corners[0], corners[1], s0, t0, color, alpha);
+	nvg__spriteVset(&verts[4], corners[6], corners[7], s0, t1, color, alpha);
+	nvg__spriteVset(&verts[5], corners[4], corners[5], s1, t1, color, alpha);
+
+	nvg__flushInstances(ctx);
+	ctx->params.renderSprites(ctx->params.userPtr, &state->scissor, image, verts, NVG_COUNTOF(verts));
+
+#if DEBUG
+	ctx->drawCallCount++;
+	ctx->textTriCount += 2;
+#endif
+}
+
 // Add fonts
 int nvgCreateFont(NVGcontext* ctx, const char* name, const char* path)
 {
@@ -3100,9 +4229,22 @@ static void nvg__renderText(NVGcontext* ctx, NVGvertex* verts, int nverts)
 #endif
 	NVGscissor scissor = state->scissor;
 
+	// The text color is tinted like a solid color, before the font atlas is set
+	nvg__tintPaint(ctx, &paint, state->tint, state->tintFactor);
+
 	// Render triangles.
 	paint.image = ctx->fontImages[ctx->fontImageIdx];
 
+	// Recorded text depends on the font atlas image:
+	if (ctx->displayList != NULL)
+	{
+		NVGdisplayList* list = ctx->displayList;
+		if (list->fontImage == 0)
+			list->fontImage = paint.image;
+		else if (list->fontImage != paint.image)
+			list->fontImage = -1;
+	}
+
 	// Apply global alpha
 	paint.innerColor.a *= state->alpha;
 	paint.outerColor.a *= state->alpha;
@@ -55,6 +55,7 @@ struct NVGpaint {
 	NVGcolor innerColor;
 	NVGcolor outerColor;
 	int image;
+	NVGcolor tint; // Mixed into the image texels by its alpha.
 };
 typedef struct NVGpaint NVGpaint;
 
@@ -139,17 +140,54 @@ NVGdisplayList* nvgCreateDisplayList(int initalNumCommands);
 void nvgDeleteDisplayList(NVGdisplayList* list);
     
 // Bind the display list; all NanoVG draw commands after this call will be cached. Including scissor and
-// paint. To unbind the display list set list parameter to NULL.
+// paint. To unbind the display list set list parameter to NULL. If the back end supports vertex buffers,
+// the cached vertices are uploaded once when the display list is unbound.
 void nvgBindDisplayList(NVGcontext* ctx, NVGdisplayList* list);
     
 // Clears the cache but does not free or reallocate any memory. The size of cache keeps the same, even if
-// cache grew during previous use.
+// cache grew during previous use. The back end vertex buffer is released.
 void nvgResetDisplayList(NVGdisplayList* list);
+
+// Creates a context which only records display lists, with the same tessellation settings as ctx after
+// nvgBeginFrame is called with the same device pixel ratio. It doesn't use the back end of ctx, so display
+// lists can be recorded in other threads, one recording context per thread. Text can't be recorded.
+NVGcontext* nvgCreateRecordingContext(NVGcontext* ctx);
+
+// Deletes a context created with nvgCreateRecordingContext.
+void nvgDeleteRecordingContext(NVGcontext* ctx);
+
+// Enables or disables the SSE2 or NEON tessellation kernels, which are enabled by default when they are
+// available. Both kernels give identical results, so disabling them is only useful to test them. Recording
+// contexts take the setting of the context they are created from. It has no effect if NVG_NO_SIMD is defined.
+void nvgSimdTessellation(NVGcontext* ctx, int enabled);
+
+// Uploads a display list recorded by a recording context to the back end of ctx, so it can be drawn by ctx.
+void nvgUploadDisplayList(NVGcontext* ctx, NVGdisplayList* list);
+
+// Returns the number of bytes allocated by the display list, including its back end vertex buffer.
+int nvgDisplayListMemory(NVGdisplayList* list);
+
+// Writes the display list to data, which must have the size returned when data is NULL. Returns the number of
+// bytes written, or 0 if the display list has image or text paints, which can't be read by other contexts.
+int nvgWriteDisplayList(NVGcontext* ctx, NVGdisplayList* list, unsigned char* data);
+
+// Replaces the display list with the one written in data by nvgWriteDisplayList, and uploads it to the back end
+// vertex buffer. Returns 0 if data is not valid, is corrupted or was written with other tessellation settings.
+int nvgReadDisplayList(NVGcontext* ctx, NVGdisplayList* list, const unsigned char* data, int size);
     
-// Draws the cached geometry by passing it to the back end. The current transform and global alpha is
-// applied to the display list.
+// Draws the cached geometry by passing it to the back end. The current transform, global alpha and global
+// tint are applied to the display list.
 void nvgDrawDisplayList(NVGcontext* ctx, NVGdisplayList* list);
+
+// Draws the display list like nvgDrawDisplayList, but consecutive draws of the same list may be batched
+// by back ends which support instancing: each command is drawn for all the batched instances before the
+// next command is drawn. Scissored instances are drawn with nvgDrawDisplayList.
+void nvgDrawDisplayListInstance(NVGcontext* ctx, NVGdisplayList* list);
 	
+// Returns 1 if the display list has text laid out in a font atlas image which is not the current one and it
+// must be recorded again, 0 otherwise. Old font atlas images are deleted by nvgEndFrame.
+int nvgIsDisplayListOutdated(NVGcontext* ctx, NVGdisplayList* list);
+
 // Check if the texture atlas changed and we need to recreate display lists. Must be called before nvgEndFrame!
 int nvgFindOutdatedDisplayListResources(NVGcontext * ctx);
 	
@@ -246,6 +284,11 @@ void nvgLineJoin(NVGcontext* ctx, int join);
 // Already transparent paths will get proportionally more transparent as well.
 void nvgGlobalAlpha(NVGcontext* ctx, float alpha);
 
+// Sets the color blended into the paints of the shapes, text, sprites and display lists drawn after it.
+// Each paint color becomes color * (1 - factor) + tint * factor. Image texels keep their alpha, and their
+// color is mixed with the tint color by tint.a * factor in the fragment shader.
+void nvgGlobalTint(NVGcontext* ctx, NVGcolor tint, float factor);
+
 //
 // Transforms
 //
@@ -356,6 +399,9 @@ int nvgCreateImageRGBA(NVGcontext* ctx, int w, int h, int imageFlags, const unsi
 // Updates image data specified by image handle.
 void nvgUpdateImage(NVGcontext* ctx, int image, const unsigned char* data);
 
+// Updates the rows [y, y + h) of the image specified by image handle. data contains the whole image.
+void nvgUpdateImageRows(NVGcontext* ctx, int image, int y, int h, const unsigned char* data);
+
 // Returns the dimensions of a created image.
 void nvgImageSize(NVGcontext* ctx, int image, int* w, int* h);
 
@@ -485,6 +531,14 @@ void nvgStroke(NVGcontext* ctx);
 void nvgFillRectSimple(NVGcontext* ctx, float x, float y, float w, float h, const float * uv);
 void nvgStrokeRectSimple(NVGcontext* ctx, float x, float y, float w, float h, const float * uv);
 
+// Draws the rect (x,y,w,h) textured with the region (s0,t0)-(s1,t1) of the image, given in texture coordinates,
+// without tessellating a path. The texels are mixed with the tint color by tint.a * tintFactor and with the global
+// tint, then multiplied by alpha and the global alpha. Consecutive sprites of the same image and scissor are drawn
+// with one call.
+// The current path is not changed.
+void nvgSprite(NVGcontext* ctx, int image, float x, float y, float w, float h,
+			   float s0, float t0, float s1, float t1, NVGcolor tint, float tintFactor, float alpha);
+
 
 //
 // Text
@@ -622,6 +676,22 @@ struct NVGpath {
 };
 typedef struct NVGpath NVGpath;
 
+struct NVGinstance {
+	float xform[6];
+	NVGcolor tint;
+	float tintFactor;
+	float alpha;
+};
+typedef struct NVGinstance NVGinstance;
+
+// Vertex of the quads drawn by nvgSprite, in window space. The tint color has the tint factor in its alpha.
+struct NVGspriteVertex {
+	float x,y,u,v;
+	unsigned char tint[4];
+	float alpha;
+};
+typedef struct NVGspriteVertex NVGspriteVertex;
+
 struct NVGparams {
 	void* userPtr;
 	int edgeAntiAlias;
@@ -640,6 +710,28 @@ struct NVGparams {
 	void (*renderTriangles)(void* uptr, NVGpaint* paint, NVGscissor* scissor, const float* xform,
                             const NVGvertex* verts, int nverts);
 	void (*renderDelete)(void* uptr);
+
+	// Optional vertex buffers kept by the back end, used to draw display lists without uploading their
+	// vertices each frame. Paths vertices are given as offsets from the verts pointer.
+	int (*renderCreateBuffer)(void* uptr, const NVGvertex* verts, int nverts);
+	void (*renderDeleteBuffer)(void* uptr, int buffer);
+	void (*renderFillBuffer)(void* uptr, NVGpaint* paint, NVGscissor* scissor, const float* xform,
+                             float fringe, int buffer, int quad, const NVGvertex* verts, const NVGpath* paths,
+                             int npaths, int instances, int ninstances);
+	void (*renderStrokeBuffer)(void* uptr, NVGpaint* paint, NVGscissor* scissor, const float* xform,
+                               float fringe, float strokeWidth, int buffer, const NVGvertex* verts,
+                               const NVGpath* paths, int npaths, int instances, int ninstances);
+	void (*renderTrianglesBuffer)(void* uptr, NVGpaint* paint, NVGscissor* scissor, const float* xform,
+                                  int buffer, int offset, int nverts, int instances, int ninstances);
+
+	// Optional instancing support. renderInstances stores the instances for the current frame and returns
+	// their offset, which is passed to the buffer callbacks with the number of instances to draw (0 to draw
+	// without instances). Instanced paints are in local space, with straight colors and no scissor.
+	int (*renderInstances)(void* uptr, const NVGinstance* instances, int ninstances);
+
+	// Optional sprites support. Consecutive sprites of the same image and scissor should be drawn together.
+	// The vertices and the scissor are in window space.
+	void (*renderSprites)(void* uptr, NVGscissor* scissor, int image, const NVGspriteVertex* verts, int nverts);
 };
 typedef struct NVGparams NVGparams;
 
@@ -32,6 +32,9 @@ enum NVGcreateFlags {
 	NVG_STENCIL_STROKES	= 1<<1,
 	// Flag indicating that additional debug checks are done.
 	NVG_DEBUG 			= 1<<2,
+	// Flag indicating if vertices and uniforms are streamed through ring buffers written without
+	// synchronization and fenced per frame, instead of re-specifying the buffers each frame (GL3 only).
+	NVG_STREAMING_BUFFERS	= 1<<3,
 };
 
 #if defined NANOVG_GL2_IMPLEMENTATION
@@ -90,6 +93,28 @@ enum NVGimageFlagsGL {
 int nvglCreateImageFromHandle(NVGcontext* ctx, GLuint textureId, int w, int h, int flags, GLuint target);
 GLuint nvglImageHandle(NVGcontext* ctx, int image);
 
+struct NVGglStats {
+	int fills;
+	int strokes;
+	int triangles;
+	int paths;
+	int vertices;		// Vertices drawn, once per instance.
+	int mergedCalls;	// Calls drawn in the same batch as the previous call, without setting their state.
+	int sortedCalls;	// Calls moved before the calls they don't overlap, next to a call with the same state.
+	int draws;			// GL draw commands.
+};
+typedef struct NVGglStats NVGglStats;
+
+// Returns the stats of the last flushed frame.
+NVGglStats nvglFrameStats(NVGcontext* ctx);
+
+#if defined NANOVG_GL3
+
+// Enables or disables NVG_STREAMING_BUFFERS, taking effect on the next flush.
+void nvglSetStreamingBuffers(NVGcontext* ctx, int enabled);
+
+#endif
+
 
 #ifdef __cplusplus
 }
@@ -103,8 +128,31 @@ GLuint nvglImageHandle(NVGcontext* ctx, int image);
 #include <stdio.h>
 #include <string.h>
 #include <math.h>
+#include <float.h>
 #include "nanovg.h"
 
+// Number of calls after each call searched for calls with the same state
+#define GLNVG_SORT_WINDOW 32
+
+// Number of frames the streaming buffers hold, each one written while the previous ones are drawn
+#define GLNVG_STREAM_FRAMES 3
+
+// Display list instances are drawn with instanced arrays, in local space:
+#if defined NANOVG_GL3 && NANOVG_GL_USE_UNIFORMBUFFER && NVG_TRANSFORM_IN_VERTEX_SHADER
+#  define NANOVG_GL_USE_INSTANCES 1
+#endif
+
+// Sprite attributes, after the instance attributes if there are any, since GLES2 may have just 8 attributes
+#if NANOVG_GL_USE_INSTANCES
+#  define GLNVG_ATTRIB_SPRITETINT 7
+#else
+#  define GLNVG_ATTRIB_SPRITETINT 2
+#endif
+#define GLNVG_ATTRIB_SPRITEALPHA (GLNVG_ATTRIB_SPRITETINT + 1)
+
+// Buffer of the calls which draw the per frame sprite vertices
+#define GLNVG_SPRITE_BUFFER -1
+
 enum GLNVGuniformLoc {
 	GLNVG_LOC_XFORM,
 	GLNVG_LOC_TEX,
@@ -120,7 +168,8 @@ enum GLNVGshaderType {
 	NSVG_SHADER_FILLIMG,
 	NSVG_SHADER_SIMPLE,
 	NSVG_SHADER_IMG,
-	NSVG_SHADER_SOLIDCOLOR
+	NSVG_SHADER_SOLIDCOLOR,
+	NSVG_SHADER_SPRITE
 };
 
 #if NANOVG_GL_USE_UNIFORMBUFFER
@@ -153,6 +202,7 @@ enum GLNVGcallType {
 	GLNVG_CONVEXFILL,
 	GLNVG_STROKE,
 	GLNVG_TRIANGLES,
+	GLNVG_SPRITES,
 };
 
 struct GLNVGcall {
@@ -163,7 +213,11 @@ struct GLNVGcall {
 	int triangleOffset;
 	int triangleCount;
 	int uniformOffset;
+	int buffer; // Buffer returned by renderCreateBuffer, 0 for the per frame vertices, or GLNVG_SPRITE_BUFFER.
+	int instanceOffset;
+	int instanceCount; // 0 for calls drawn without instances.
 	float xform[6];
+	float bounds[4]; // Window space, infinite if they are not known.
 };
 typedef struct GLNVGcall GLNVGcall;
 
@@ -181,6 +235,7 @@ struct GLNVGfragUniforms {
 		float paintMat[12];
 		struct NVGcolor innerCol;
 		struct NVGcolor outerCol;
+		struct NVGcolor tintCol; // Straight color mixed into the image texels by its alpha.
 		float scissorExt[2];
 		float scissorScale[2];
 		float extent[2];
@@ -193,13 +248,14 @@ struct GLNVGfragUniforms {
 	#else
 		// note: after modifying layout or size of uniform array,
 		// don't forget to also update the fragment shader source!
-		#define NANOVG_GL_UNIFORMARRAY_SIZE 11
+		#define NANOVG_GL_UNIFORMARRAY_SIZE 12
 		union {
 			struct {
 				float scissorMat[12]; // matrices are actually 3 vec4s
 				float paintMat[12];
 				struct NVGcolor innerCol;
 				struct NVGcolor outerCol;
+				struct NVGcolor tintCol; // Straight color mixed into the image texels by its alpha.
 				float scissorExt[2];
 				float scissorScale[2];
 				float extent[2];
@@ -216,25 +272,50 @@ struct GLNVGfragUniforms {
 };
 typedef struct GLNVGfragUniforms GLNVGfragUniforms;
 
+#if defined NANOVG_GL3
+// Vertex buffer with its own vertex array, so switching buffers doesn't set the vertex attributes again
+struct GLNVGvertexArray {
+	GLuint buffer;
+	GLuint vertArr;
+	int nextFree;	// Index + 1 of the next free vertex array, if this one is free.
+};
+typedef struct GLNVGvertexArray GLNVGvertexArray;
+#endif
+
 struct GLNVGcontext {
 	GLNVGshader shader;
+#if NANOVG_GL_USE_INSTANCES
+	GLNVGshader instanceShader;
+	GLuint instanceBuf;
+#endif
 	GLNVGtexture* textures;
 	float view[2];
 	int ntextures;
 	int ctextures;
 	int textureId;
 	GLuint vertBuf;
+	GLuint spriteBuf;
 #if defined NANOVG_GL3
 	GLuint vertArr;
+	GLuint spriteArr;
+	GLNVGvertexArray* vertexArrays;
+	int cvertexArrays;
+	int nvertexArrays;
+	int freeVertexArray;	// Index + 1 of the first free vertex array.
 #endif
 #if NANOVG_GL_USE_UNIFORMBUFFER
 	GLuint fragBuf;
+#endif
+#if defined NANOVG_GL3
+	// Pixel buffer through which texture updates are uploaded, so they don't stall on the draws in flight
+	GLuint pixelBuf;
 #endif
 	int fragSize;
 	int flags;
 
 	// Per frame buffers
 	GLNVGcall* calls;
+	int* order; // Draw order of the calls.
 	int ccalls;
 	int ncalls;
 	GLNVGpath* paths;
@@ -243,9 +324,45 @@ struct GLNVGcontext {
 	struct NVGvertex* verts;
 	int cverts;
 	int nverts;
+	NVGspriteVertex* sprites;
+	int csprites;
+	int nsprites;
 	unsigned char* uniforms;
 	int cuniforms;
 	int nuniforms;
+	NVGinstance* instances;
+	int cinstances;
+	int ninstances;
+
+	// Vertex buffers deleted after the next flush, since pending calls can use them
+	GLuint* deletedBuffers;
+	int cdeletedBuffers;
+	int ndeletedBuffers;
+
+	// Ranges drawn by a batch of merged calls
+	GLint* drawFirsts;
+	GLsizei* drawCounts;
+	int cdraws;
+	int ndraws;
+
+	// Byte offsets of the frame data in the dynamic buffers
+	int vertBase;
+	int spriteBase;
+	int fragBase;
+	int instanceBase;
+
+#if defined NANOVG_GL3
+	// Streaming buffers regions, one per frame, and the fences of the frames drawing them
+	GLsync streamFences[GLNVG_STREAM_FRAMES];
+	int streamFrame;
+	int vertRegionSize;
+	int spriteRegionSize;
+	int fragRegionSize;
+	int instanceRegionSize;
+#endif
+
+	NVGglStats frame;
+	NVGglStats lastFrame;
 
 	// cached state
 	#if NANOVG_GL_USE_STATE_FILTER
@@ -452,6 +569,15 @@ static int glnvg__createShader(GLNVGshader* shader, const char* name, const char
 
 	glBindAttribLocation(prog, 0, "vertex");
 	glBindAttribLocation(prog, 1, "tcoord");
+#if NANOVG_GL_USE_INSTANCES
+	glBindAttribLocation(prog, 2, "instanceXform0");
+	glBindAttribLocation(prog, 3, "instanceXform1");
+	glBindAttribLocation(prog, 4, "instanceXform2");
+	glBindAttribLocation(prog, 5, "instanceTint");
+	glBindAttribLocation(prog, 6, "instanceBlend");
+#endif
+	glBindAttribLocation(prog, GLNVG_ATTRIB_SPRITETINT, "spriteTint");
+	glBindAttribLocation(prog, GLNVG_ATTRIB_SPRITEALPHA, "spriteAlpha");
 
 	glLinkProgram(prog);
 	glGetProgramiv(prog, GL_LINK_STATUS, &status);
@@ -493,10 +619,18 @@ static void glnvg__getUniforms(GLNVGshader* shader)
 #endif
 }
 
+#if defined NANOVG_GL3
+static void glnvg__createVertexArray(GLNVGcontext* gl, GLuint* vertArr, GLuint buffer);
+static void glnvg__createSpriteArray(GLNVGcontext* gl);
+#endif
+
 static int glnvg__renderCreate(void* uptr)
 {
 	GLNVGcontext* gl = (GLNVGcontext*)uptr;
 	int align = 4;
+#if NANOVG_GL_USE_INSTANCES
+	char instanceOptions[128];
+#endif
 
 	// TODO: mediump float may not be enough for GLES2 in iOS.
 	// see the following discussion: https://github.com/memononen/nanovg/issues/46
@@ -504,7 +638,7 @@ static int glnvg__renderCreate(void* uptr)
 #if defined NANOVG_GL2
 		"#define NANOVG_GL2 1\n"
 #elif defined NANOVG_GL3
-		"#version 410 core\n"
+		"#version 330 core\n"
 		"#define NANOVG_GL3 1\n"
 #elif defined NANOVG_GLES2
 		"#version 100\n"
@@ -517,7 +651,7 @@ static int glnvg__renderCreate(void* uptr)
 #if NANOVG_GL_USE_UNIFORMBUFFER
 	"#define USE_UNIFORMBUFFER 1\n"
 #else
-	"#define UNIFORMARRAY_SIZE 11\n"
+	"#define UNIFORMARRAY_SIZE 12\n"
 #endif
 	"\n";
 
@@ -528,15 +662,37 @@ static int glnvg__renderCreate(void* uptr)
 		"	in vec2 tcoord;\n"
 		"	out vec2 ftcoord;\n"
 		"	out vec2 fpos;\n"
+		"#ifdef INSTANCED\n"
+		"	in vec2 instanceXform0;\n"
+		"	in vec2 instanceXform1;\n"
+		"	in vec2 instanceXform2;\n"
+		"	in vec4 instanceTint;\n"
+		"	in vec2 instanceBlend;\n" // tint factor, alpha
+		"	out vec4 ftint;\n"
+		"	out vec2 fblend;\n"
+		"#else\n"
+		"	in vec4 spriteTint;\n"
+		"	in float spriteAlpha;\n"
+		"	out vec4 fspriteTint;\n"
+		"	out float fspriteAlpha;\n"
+		"#endif\n"
 		"#else\n"
 		"	uniform vec3 xform[3];\n" //[sx kx tx; ky sy ty; 2/viewSize_width, 2/viewSize_heigt, 1]
 		"	attribute vec2 vertex;\n"
 		"	attribute vec2 tcoord;\n"
+		"	attribute vec4 spriteTint;\n"
+		"	attribute float spriteAlpha;\n"
 		"	varying vec2 ftcoord;\n"
 		"	varying vec2 fpos;\n"
+		"	varying vec4 fspriteTint;\n"
+		"	varying float fspriteAlpha;\n"
 		"#endif\n"
 		"void main(void) {\n"
 		"	ftcoord = tcoord;\n"
+		"#ifndef INSTANCED\n"
+		"	fspriteTint = spriteTint;\n"
+		"	fspriteAlpha = spriteAlpha;\n"
+		"#endif\n"
 #if NVG_TRANSFORM_IN_VERTEX_SHADER
 		"   vec3 v = vec3(vertex, 1.0);\n"
 		"	vec2 pt = vec2(dot(v,xform[0]), dot(v,xform[1]));\n"
@@ -544,6 +700,12 @@ static int glnvg__renderCreate(void* uptr)
         "   vec2 pt = vertex;\n"
 #endif
 		"	fpos = pt;\n"
+		"#ifdef INSTANCED\n"
+		"	// Paints stay in the display list space, the instance transform is applied after them.\n"
+		"	pt = pt.x*instanceXform0 + pt.y*instanceXform1 + instanceXform2;\n"
+		"	ftint = instanceTint;\n"
+		"	fblend = instanceBlend;\n"
+		"#endif\n"
 		"	gl_Position = vec4(pt.x*xform[2].x - 1.0, 1.0 - pt.y*xform[2].y, 0, 1);\n"
 		"}\n";
 
@@ -562,6 +724,7 @@ static int glnvg__renderCreate(void* uptr)
 		"		mat3 paintMat;\n"
 		"		vec4 innerCol;\n"
 		"		vec4 outerCol;\n"
+		"		vec4 tintCol;\n"
 		"		vec2 scissorExt;\n"
 		"		vec2 scissorScale;\n"
 		"		vec2 extent;\n"
@@ -580,26 +743,36 @@ static int glnvg__renderCreate(void* uptr)
 		"	in vec2 ftcoord;\n"
 		"	in vec2 fpos;\n"
 		"	out vec4 outColor;\n"
+		"#ifdef INSTANCED\n"
+		"	in vec4 ftint;\n"
+		"	in vec2 fblend;\n"
+		"#else\n"
+		"	in vec4 fspriteTint;\n"
+		"	in float fspriteAlpha;\n"
+		"#endif\n"
 		"#else\n" // !NANOVG_GL3
 		"	uniform vec4 frag[UNIFORMARRAY_SIZE];\n"
 		"	uniform sampler2D tex;\n"
 		"	varying vec2 ftcoord;\n"
 		"	varying vec2 fpos;\n"
+		"	varying vec4 fspriteTint;\n"
+		"	varying float fspriteAlpha;\n"
 		"#endif\n"
 		"#ifndef USE_UNIFORMBUFFER\n"
 		"	#define scissorMat mat3(frag[0].xyz, frag[1].xyz, frag[2].xyz)\n"
 		"	#define paintMat mat3(frag[3].xyz, frag[4].xyz, frag[5].xyz)\n"
 		"	#define innerCol frag[6]\n"
 		"	#define outerCol frag[7]\n"
-		"	#define scissorExt frag[8].xy\n"
-		"	#define scissorScale frag[8].zw\n"
-		"	#define extent frag[9].xy\n"
-		"	#define radius frag[9].z\n"
-		"	#define feather frag[9].w\n"
-		"	#define strokeMult frag[10].x\n"
-		"	#define strokeThr frag[10].y\n"
-		"	#define texType int(frag[10].z)\n"
-		"	#define type int(frag[10].w)\n"
+		"	#define tintCol frag[8]\n"
+		"	#define scissorExt frag[9].xy\n"
+		"	#define scissorScale frag[9].zw\n"
+		"	#define extent frag[10].xy\n"
+		"	#define radius frag[10].z\n"
+		"	#define feather frag[10].w\n"
+		"	#define strokeMult frag[11].x\n"
+		"	#define strokeThr frag[11].y\n"
+		"	#define texType int(frag[11].z)\n"
+		"	#define type int(frag[11].w)\n"
 		"#endif\n"
 		"\n"
 		"float sdroundrect(vec2 pt, vec2 ext, float rad) {\n"
@@ -620,10 +793,27 @@ static int glnvg__renderCreate(void* uptr)
 		"	return min(1.0, (1.0-abs(ftcoord.x*2.0-1.0))*strokeMult) * min(1.0, ftcoord.y);\n"
 		"}\n"
 		"#endif\n"
+		"#ifdef INSTANCED\n"
+		"// Instances colors are straight, the instance tint and alpha are applied before premultiplying them.\n"
+		"vec4 instanceColor(vec4 color, bool tinted) {\n"
+		"	if (tinted) color = mix(color, ftint, fblend.x);\n"
+		"	color.a *= fblend.y;\n"
+		"	return vec4(color.rgb*color.a, color.a);\n"
+		"}\n"
+		"#endif\n"
 		"\n"
 		"void main(void) {\n"
 		"   vec4 result;\n"
 		"	float scissor = scissorMask(fpos);\n"
+		"#ifdef INSTANCED\n"
+		"	// Image texels are tinted instead of their paint color, but font atlas texels are coverage.\n"
+		"	bool tintTexels = type == 1 || (type == 3 && texType != 2);\n"
+		"	vec4 icol = instanceColor(innerCol, !tintTexels);\n"
+		"	vec4 ocol = instanceColor(outerCol, !tintTexels);\n"
+		"#else\n"
+		"	vec4 icol = innerCol;\n"
+		"	vec4 ocol = outerCol;\n"
+		"#endif\n"
 		"#ifdef EDGE_AA\n"
 		"	float strokeAlpha = strokeMask();\n"
 		"#else\n"
@@ -633,7 +823,7 @@ static int glnvg__renderCreate(void* uptr)
 		"		// Calculate gradient color using box gradient\n"
 		"		vec2 pt = (paintMat * vec3(fpos,1.0)).xy;\n"
 		"		float d = clamp((sdroundrect(pt, extent, radius) + feather*0.5) / feather, 0.0, 1.0);\n"
-		"		vec4 color = mix(innerCol,outerCol,d);\n"
+		"		vec4 color = mix(icol,ocol,d);\n"
 		"		// Combine alpha\n"
 		"		color *= strokeAlpha * scissor;\n"
 		"		result = color;\n"
@@ -650,8 +840,12 @@ static int glnvg__renderCreate(void* uptr)
 		"#endif\n"
 		"		if (texType == 1 || texType == 3) color = vec4(color.xyz*color.w,color.w);"
 		"		if (texType == 2) color = vec4(color.x);"
+		"		color.rgb = mix(color.rgb, tintCol.rgb*color.a, tintCol.a);\n"
+		"#ifdef INSTANCED\n"
+		"		color.rgb = mix(color.rgb, ftint.rgb*color.a, ftint.a*fblend.x);\n"
+		"#endif\n"
 		"		// Apply color tint and alpha.\n"
-		"		color *= innerCol;\n"
+		"		color *= icol;\n"
 		"		// Combine alpha\n"
 		"		color *= strokeAlpha * scissor;\n"
 		"		result = color;\n"
@@ -667,10 +861,28 @@ static int glnvg__renderCreate(void* uptr)
 		"#endif\n"
 		"		if (texType == 1) color = vec4(color.xyz*color.w,color.w);"
 		"		if (texType == 2) color = vec4(color.x);"
+		"		color.rgb = mix(color.rgb, tintCol.rgb*color.a, tintCol.a);\n"
+		"#ifdef INSTANCED\n"
+		"		if (texType != 2) color.rgb = mix(color.rgb, ftint.rgb*color.a, ftint.a*fblend.x);\n"
+		"#endif\n"
 		"		color *= scissor;\n"
-		"		result = color * innerCol;\n"
+		"		result = color * icol;\n"
 		"	} else if (type == 4) {		// Color solid fill\n"
-		"		result = innerCol * scissor;\n"
+		"		result = icol * scissor;\n"
+		"#ifndef INSTANCED\n"
+		"	} else if (type == 5) {		// Sprites, with their tint and alpha in the vertices\n"
+		"#ifdef NANOVG_GL3\n"
+		"		vec4 color;\n"
+		"		if(texType != 3) color = texture(tex, ftcoord);\n"
+		"		else color = texture(texRect,ftcoord*extent);\n"
+		"#else\n"
+		"		vec4 color = texture2D(tex, ftcoord);\n"
+		"#endif\n"
+		"		if (texType == 1 || texType == 3) color = vec4(color.xyz*color.w,color.w);"
+		"		if (texType == 2) color = vec4(color.x);"
+		"		color.rgb = mix(color.rgb, fspriteTint.rgb*color.a, fspriteTint.a);\n"
+		"		result = color * fspriteAlpha * scissor;\n"
+		"#endif\n"
 		"	}\n"
 		"#if defined(EDGE_AA) && defined(EDGE_DISCARD)\n" 
 		"	if (strokeAlpha < strokeThr) discard;\n"
@@ -698,11 +910,35 @@ static int glnvg__renderCreate(void* uptr)
 	glnvg__checkError(gl, "uniform locations", __LINE__);
 	glnvg__getUniforms(&gl->shader);
 
+#if NANOVG_GL_USE_INSTANCES
+	snprintf(instanceOptions, sizeof(instanceOptions), "%s#define INSTANCED 1\n", options != NULL ? options : "");
+	if (glnvg__createShader(&gl->instanceShader, "instance shader", shaderHeader, instanceOptions, fillVertShader,
+							fillFragShader) == 0)
+		return 0;
+
+	glnvg__getUniforms(&gl->instanceShader);
+
+	// The texture units don't change, so they are set just once:
+	glUseProgram(gl->instanceShader.prog);
+	glUniform1i(gl->instanceShader.loc[GLNVG_LOC_TEX], 0);
+	glUniform1i(gl->instanceShader.loc[GLNVG_LOC_TEXRECT], 1);
+	glUseProgram(0);
+	glUniformBlockBinding(gl->instanceShader.prog, gl->instanceShader.loc[GLNVG_LOC_FRAG], GLNVG_FRAG_BINDING);
+
+	glGenBuffers(1, &gl->instanceBuf);
+#endif
+
 	// Create dynamic vertex array
+	glGenBuffers(1, &gl->vertBuf);
 #if defined NANOVG_GL3
-	glGenVertexArrays(1, &gl->vertArr);
+	glnvg__createVertexArray(gl, &gl->vertArr, gl->vertBuf);
+#endif
+
+	// Create dynamic sprite vertex array
+	glGenBuffers(1, &gl->spriteBuf);
+#if defined NANOVG_GL3
+	glnvg__createSpriteArray(gl);
 #endif
-	glGenBuffers(1, &gl->vertBuf);
 
 #if NANOVG_GL_USE_UNIFORMBUFFER
 	// Create UBOs
@@ -842,6 +1078,20 @@ static int glnvg__renderUpdateTexture(void* uptr, int image, int x, int y, int w
 	w = tex->width;
 #endif
 
+#if defined NANOVG_GL3
+	// The updated rows are copied to an orphaned pixel buffer, and the texture is updated from it.
+	{
+		int rowSize = tex->width * (tex->type == NVG_TEXTURE_RGBA ? 4 : 1);
+		if (gl->pixelBuf == 0)
+			glGenBuffers(1, &gl->pixelBuf);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, gl->pixelBuf);
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, rowSize * h, NULL, GL_STREAM_DRAW);
+		glBufferSubData(GL_PIXEL_UNPACK_BUFFER, 0, rowSize * h, data + rowSize * y);
+		glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+		data = NULL;
+	}
+#endif
+
 	if (tex->type == NVG_TEXTURE_RGBA)
 		glTexSubImage2D(GL_TEXTURE_2D, 0, x,y, w,h, GL_RGBA, GL_UNSIGNED_BYTE, data);
 	else
@@ -851,6 +1101,10 @@ static int glnvg__renderUpdateTexture(void* uptr, int image, int x, int y, int w
 		glTexSubImage2D(GL_TEXTURE_2D, 0, x,y, w,h, GL_RED, GL_UNSIGNED_BYTE, data);
 #endif
 
+#if defined NANOVG_GL3
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+#endif
+
 	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
 #ifndef NANOVG_GLES2
 	glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
@@ -858,6 +1112,13 @@ static int glnvg__renderUpdateTexture(void* uptr, int image, int x, int y, int w
 	glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
 #endif
 
+	// Mipmaps are built again once the last rows are updated, so images can be updated in bands.
+#if !defined(NANOVG_GL2)
+	if ((tex->flags & NVG_IMAGE_GENERATE_MIPMAPS) && y + h == tex->height) {
+		glGenerateMipmap(GL_TEXTURE_2D);
+	}
+#endif
+
 	glnvg__bindTexture(gl, 0,GL_TEXTURE_2D);
 
 	return 1;
@@ -956,6 +1217,7 @@ static int glnvg__convertPaint(GLNVGcontext* gl, GLNVGfragUniforms* frag, NVGpai
 			nvgTransformInverse(invxform, t);
 		}
 		frag->type = NSVG_SHADER_FILLIMG;
+		frag->tintCol = paint->tint;
 
 		if (tex->type == NVG_TEXTURE_RGBA)
 			frag->texType = (tex->flags & NVG_IMAGE_PREMULTIPLIED) ? 0 : 1;
@@ -974,6 +1236,11 @@ static int glnvg__convertPaint(GLNVGcontext* gl, GLNVGfragUniforms* frag, NVGpai
 
 	glnvg__xformToMat3x4(frag->paintMat, invxform);
 
+	// Single color paints don't depend on the paint transform, so calls with other transforms can be merged
+	if (frag->type == NSVG_SHADER_FILLGRAD &&
+		memcmp(&paint->innerColor, &paint->outerColor, sizeof(NVGcolor)) == 0)
+		memset(frag->paintMat, 0, sizeof(frag->paintMat));
+
 	return 1;
 }
 
@@ -982,7 +1249,8 @@ static GLNVGfragUniforms* nvg__fragUniformPtr(GLNVGcontext* gl, int i);
 static void glnvg__setUniforms(GLNVGcontext* gl, int uniformOffset, int image)
 {
 #if NANOVG_GL_USE_UNIFORMBUFFER
-	glBindBufferRange(GL_UNIFORM_BUFFER, GLNVG_FRAG_BINDING, gl->fragBuf, uniformOffset, sizeof(GLNVGfragUniforms));
+	glBindBufferRange(GL_UNIFORM_BUFFER, GLNVG_FRAG_BINDING, gl->fragBuf, gl->fragBase + uniformOffset,
+					  sizeof(GLNVGfragUniforms));
 #else
 	GLNVGfragUniforms* frag = nvg__fragUniformPtr(gl, uniformOffset);
 	glUniform4fv(gl->shader.loc[GLNVG_LOC_FRAG], NANOVG_GL_UNIFORMARRAY_SIZE, &(frag->uniformArray[0][0]));
@@ -1004,6 +1272,22 @@ static void glnvg__renderViewport(void* uptr, int width, int height)
 	gl->view[1] = (float)height;
 }
 
+static void glnvg__drawArrays(GLNVGcontext* gl, GLNVGcall* call, GLenum mode, GLint first, GLsizei count)
+{
+	gl->frame.draws++;
+	gl->frame.vertices += count * glnvg__maxi(call->instanceCount, 1);
+
+#if NANOVG_GL_USE_INSTANCES
+	if (call->instanceCount > 0) {
+		glDrawArraysInstanced(mode, first, count, call->instanceCount);
+		return;
+	}
+#else
+	NVG_NOTUSED(call);
+#endif
+	glDrawArrays(mode, first, count);
+}
+
 static void glnvg__fill(GLNVGcontext* gl, GLNVGcall* call)
 {
 	GLNVGpath* paths = &gl->paths[call->pathOffset];
@@ -1023,7 +1307,7 @@ static void glnvg__fill(GLNVGcontext* gl, GLNVGcall* call)
 	glStencilOpSeparate(GL_BACK, GL_KEEP, GL_KEEP, GL_DECR_WRAP);
 	glDisable(GL_CULL_FACE);
 	for (i = 0; i < npaths; i++)
-		glDrawArrays(GL_TRIANGLE_FAN, paths[i].fillOffset, paths[i].fillCount);
+		glnvg__drawArrays(gl, call, GL_TRIANGLE_FAN, paths[i].fillOffset, paths[i].fillCount);
 	//glEnable(GL_CULL_FACE);
 
 	// Draw anti-aliased pixels
@@ -1037,34 +1321,39 @@ static void glnvg__fill(GLNVGcontext* gl, GLNVGcall* call)
 		glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
 		// Draw fringes
 		for (i = 0; i < npaths; i++)
-			glDrawArrays(GL_TRIANGLE_STRIP, paths[i].strokeOffset, paths[i].strokeCount);
+			glnvg__drawArrays(gl, call, GL_TRIANGLE_STRIP, paths[i].strokeOffset, paths[i].strokeCount);
 	}
 
 	// Draw fill
 	glnvg__stencilFunc(gl, GL_NOTEQUAL, 0x0, 0xff);
 	glStencilOp(GL_ZERO, GL_ZERO, GL_ZERO);
-	glDrawArrays(GL_TRIANGLES, call->triangleOffset, call->triangleCount);
+	glnvg__drawArrays(gl, call, GL_TRIANGLES, call->triangleOffset, call->triangleCount);
 
 	glDisable(GL_STENCIL_TEST);
 }
 
-static void glnvg__convexFill(GLNVGcontext* gl, GLNVGcall* call)
+static void glnvg__convexFillPaths(GLNVGcontext* gl, GLNVGcall* call)
 {
 	GLNVGpath* paths = &gl->paths[call->pathOffset];
 	int i, npaths = call->pathCount;
 
-	glnvg__setUniforms(gl, call->uniformOffset, call->image);
-	glnvg__checkError(gl, "convex fill", __LINE__);
-
 	for (i = 0; i < npaths; i++)
-		glDrawArrays(GL_TRIANGLE_FAN, paths[i].fillOffset, paths[i].fillCount);
+		glnvg__drawArrays(gl, call, GL_TRIANGLE_FAN, paths[i].fillOffset, paths[i].fillCount);
 	if (gl->flags & NVG_ANTIALIAS) {
 		// Draw fringes
 		for (i = 0; i < npaths; i++)
-			glDrawArrays(GL_TRIANGLE_STRIP, paths[i].strokeOffset, paths[i].strokeCount);
+			glnvg__drawArrays(gl, call, GL_TRIANGLE_STRIP, paths[i].strokeOffset, paths[i].strokeCount);
 	}
 }
 
+static void glnvg__convexFill(GLNVGcontext* gl, GLNVGcall* call)
+{
+	glnvg__setUniforms(gl, call->uniformOffset, call->image);
+	glnvg__checkError(gl, "convex fill", __LINE__);
+
+	glnvg__convexFillPaths(gl, call);
+}
+
 static void glnvg__stroke(GLNVGcontext* gl, GLNVGcall* call)
 {
 	GLNVGpath* paths = &gl->paths[call->pathOffset];
@@ -1081,14 +1370,14 @@ static void glnvg__stroke(GLNVGcontext* gl, GLNVGcall* call)
 		glnvg__setUniforms(gl, call->uniformOffset + gl->fragSize, call->image);
 		glnvg__checkError(gl, "stroke fill 0", __LINE__);
 		for (i = 0; i < npaths; i++)
-			glDrawArrays(GL_TRIANGLE_STRIP, paths[i].strokeOffset, paths[i].strokeCount);
+			glnvg__drawArrays(gl, call, GL_TRIANGLE_STRIP, paths[i].strokeOffset, paths[i].strokeCount);
 
 		// Draw anti-aliased pixels.
 		glnvg__setUniforms(gl, call->uniformOffset, call->image);
 		glnvg__stencilFunc(gl, GL_EQUAL, 0x00, 0xff);
 		glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
 		for (i = 0; i < npaths; i++)
-			glDrawArrays(GL_TRIANGLE_STRIP, paths[i].strokeOffset, paths[i].strokeCount);
+			glnvg__drawArrays(gl, call, GL_TRIANGLE_STRIP, paths[i].strokeOffset, paths[i].strokeCount);
 
 		// Clear stencil buffer.		
 		glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
@@ -1096,7 +1385,7 @@ static void glnvg__stroke(GLNVGcontext* gl, GLNVGcall* call)
 		glStencilOp(GL_ZERO, GL_ZERO, GL_ZERO);
 		glnvg__checkError(gl, "stroke fill 1", __LINE__);
 		for (i = 0; i < npaths; i++)
-			glDrawArrays(GL_TRIANGLE_STRIP, paths[i].strokeOffset, paths[i].strokeCount);
+			glnvg__drawArrays(gl, call, GL_TRIANGLE_STRIP, paths[i].strokeOffset, paths[i].strokeCount);
 		glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
 
 		glDisable(GL_STENCIL_TEST);
@@ -1108,7 +1397,7 @@ static void glnvg__stroke(GLNVGcontext* gl, GLNVGcall* call)
 		glnvg__checkError(gl, "stroke fill", __LINE__);
 		// Draw Strokes
 		for (i = 0; i < npaths; i++)
-			glDrawArrays(GL_TRIANGLE_STRIP, paths[i].strokeOffset, paths[i].strokeCount);
+			glnvg__drawArrays(gl, call, GL_TRIANGLE_STRIP, paths[i].strokeOffset, paths[i].strokeCount);
 	}
 }
 
@@ -1117,22 +1406,483 @@ static void glnvg__triangles(GLNVGcontext* gl, GLNVGcall* call)
 	glnvg__setUniforms(gl, call->uniformOffset, call->image);
 	glnvg__checkError(gl, "triangles fill", __LINE__);
 
-	glDrawArrays(GL_TRIANGLES, call->triangleOffset, call->triangleCount);
+	glnvg__drawArrays(gl, call, GL_TRIANGLES, call->triangleOffset, call->triangleCount);
+}
+
+static void glnvg__initBounds(float* bounds)
+{
+	bounds[0] = bounds[1] = FLT_MAX;
+	bounds[2] = bounds[3] = -FLT_MAX;
+}
+
+static void glnvg__unionBounds(float* bounds, const float* other)
+{
+	if (other[0] < bounds[0]) bounds[0] = other[0];
+	if (other[1] < bounds[1]) bounds[1] = other[1];
+	if (other[2] > bounds[2]) bounds[2] = other[2];
+	if (other[3] > bounds[3]) bounds[3] = other[3];
+}
+
+static void glnvg__vertexBounds(float* bounds, const NVGvertex* verts, int nverts)
+{
+	int i;
+	for (i = 0; i < nverts; i++) {
+		if (verts[i].x < bounds[0]) bounds[0] = verts[i].x;
+		if (verts[i].y < bounds[1]) bounds[1] = verts[i].y;
+		if (verts[i].x > bounds[2]) bounds[2] = verts[i].x;
+		if (verts[i].y > bounds[3]) bounds[3] = verts[i].y;
+	}
+}
+
+// Sets the window space bounds of the call from the bounds of its vertices
+static void glnvg__setCallBounds(GLNVGcall* call, const float* bounds)
+{
+	float corners[8];
+	int i;
+
+	glnvg__initBounds(call->bounds);
+	if (bounds[0] > bounds[2] || bounds[1] > bounds[3]) return;
+
+	nvgTransformPoint(&corners[0], &corners[1], call->xform, bounds[0], bounds[1]);
+	nvgTransformPoint(&corners[2], &corners[3], call->xform, bounds[2], bounds[1]);
+	nvgTransformPoint(&corners[4], &corners[5], call->xform, bounds[2], bounds[3]);
+	nvgTransformPoint(&corners[6], &corners[7], call->xform, bounds[0], bounds[3]);
+	for (i = 0; i < 4; i++) {
+		float point[4] = { corners[i*2], corners[i*2+1], corners[i*2], corners[i*2+1] };
+		glnvg__unionBounds(call->bounds, point);
+	}
+}
+
+// Bounds which share an edge overlap too, since they can touch the same pixels
+static int glnvg__overlap(const float* a, const float* b)
+{
+	return a[0] <= b[2] && b[0] <= a[2] && a[1] <= b[3] && b[1] <= a[3];
+}
+
+static int glnvg__sameState(const GLNVGcall* a, const GLNVGcall* b)
+{
+	return a->image == b->image && a->buffer == b->buffer && (a->instanceCount > 0) == (b->instanceCount > 0);
+}
+
+// Calls with the same type, transform, uniforms and buffers are drawn with the state of the first one.
+// Fills which use the stencil buffer must be drawn one by one.
+static int glnvg__mergeable(GLNVGcontext* gl, const GLNVGcall* a, const GLNVGcall* b)
+{
+	if (a->type != b->type || a->type == GLNVG_FILL || (a->type == GLNVG_STROKE && (gl->flags & NVG_STENCIL_STROKES)))
+		return 0;
+
+	if (a->instanceCount > 0 || b->instanceCount > 0 || a->buffer != b->buffer || a->image != b->image)
+		return 0;
+
+	return memcmp(a->xform, b->xform, sizeof(a->xform)) == 0 &&
+		memcmp(nvg__fragUniformPtr(gl, a->uniformOffset), nvg__fragUniformPtr(gl, b->uniformOffset),
+			   sizeof(GLNVGfragUniforms)) == 0;
+}
+
+// Moves calls before the calls they don't overlap, next to a previous call with the same program,
+// vertex buffer and texture, or next to a previous call they can be merged with
+static void glnvg__sortCalls(GLNVGcontext* gl)
+{
+	float skipped[4];
+	int i, j, k, next, index;
+
+	for (i = 0; i < gl->ncalls; i++)
+		gl->order[i] = i;
+
+	for (i = 0; i < gl->ncalls - 1; i++) {
+		GLNVGcall* call = &gl->calls[gl->order[i]];
+		int sorted = glnvg__sameState(call, &gl->calls[gl->order[i+1]]);
+		if (sorted && glnvg__mergeable(gl, call, &gl->calls[gl->order[i+1]]))
+			continue;
+
+		glnvg__initBounds(skipped);
+		next = i + 1;
+		for (j = i + 1; j < gl->ncalls && j <= i + GLNVG_SORT_WINDOW; j++) {
+			GLNVGcall* other = &gl->calls[gl->order[j]];
+			int candidate = sorted ? glnvg__mergeable(gl, call, other) : glnvg__sameState(call, other);
+			if (candidate && !glnvg__overlap(other->bounds, skipped)) {
+				if (j > next) {
+					index = gl->order[j];
+					for (k = j; k > next; k--)
+						gl->order[k] = gl->order[k-1];
+					gl->order[next] = index;
+					gl->frame.sortedCalls++;
+				}
+				next++;
+			} else {
+				glnvg__unionBounds(skipped, other->bounds);
+				if (skipped[0] == -FLT_MAX && skipped[2] == FLT_MAX) break;
+			}
+		}
+	}
+}
+
+static int glnvg__allocDraws(GLNVGcontext* gl, int n)
+{
+	gl->ndraws = 0;
+	if (n > gl->cdraws) {
+		GLint* drawFirsts;
+		GLsizei* drawCounts;
+		int cdraws = glnvg__maxi(n, 64) + gl->cdraws/2; // 1.5x Overallocate
+		drawFirsts = (GLint*)realloc(gl->drawFirsts, sizeof(GLint) * cdraws);
+		if (drawFirsts == NULL) return 0;
+		gl->drawFirsts = drawFirsts;
+		drawCounts = (GLsizei*)realloc(gl->drawCounts, sizeof(GLsizei) * cdraws);
+		if (drawCounts == NULL) return 0;
+		gl->drawCounts = drawCounts;
+		gl->cdraws = cdraws;
+	}
+	return 1;
+}
+
+static void glnvg__addDraw(GLNVGcontext* gl, GLint first, GLsizei count, int join)
+{
+	if (count <= 0) return;
+
+	// Contiguous triangle lists are drawn as one
+	if (join && gl->ndraws > 0 && gl->drawFirsts[gl->ndraws-1] + gl->drawCounts[gl->ndraws-1] == first) {
+		gl->drawCounts[gl->ndraws-1] += count;
+		return;
+	}
+
+	gl->drawFirsts[gl->ndraws] = first;
+	gl->drawCounts[gl->ndraws] = count;
+	gl->ndraws++;
+}
+
+static void glnvg__multiDrawArrays(GLNVGcontext* gl, GLenum mode)
+{
+	int i;
+
+	for (i = 0; i < gl->ndraws; i++)
+		gl->frame.vertices += gl->drawCounts[i];
+
+#if defined NANOVG_GL2 || defined NANOVG_GL3
+	if (gl->ndraws > 0) {
+		glMultiDrawArrays(mode, gl->drawFirsts, gl->drawCounts, gl->ndraws);
+		gl->frame.draws++;
+	}
+#else
+	for (i = 0; i < gl->ndraws; i++)
+		glDrawArrays(mode, gl->drawFirsts[i], gl->drawCounts[i]);
+	gl->frame.draws += gl->ndraws;
+#endif
+
+	gl->ndraws = 0;
+}
+
+static void glnvg__countCalls(GLNVGcontext* gl, const int* order, int ncalls)
+{
+	int i;
+	for (i = 0; i < ncalls; i++) {
+		GLNVGcall* call = &gl->calls[order[i]];
+		int ninstances = glnvg__maxi(call->instanceCount, 1);
+		if (call->type == GLNVG_FILL || call->type == GLNVG_CONVEXFILL)
+			gl->frame.fills += ninstances;
+		else if (call->type == GLNVG_STROKE)
+			gl->frame.strokes += ninstances;
+		else if (call->type == GLNVG_TRIANGLES || call->type == GLNVG_SPRITES)
+			gl->frame.triangles += ninstances;
+		gl->frame.paths += call->pathCount * ninstances;
+	}
+}
+
+static void glnvg__drawCall(GLNVGcontext* gl, GLNVGcall* call)
+{
+	if (call->type == GLNVG_FILL)
+		glnvg__fill(gl, call);
+	else if (call->type == GLNVG_CONVEXFILL)
+		glnvg__convexFill(gl, call);
+	else if (call->type == GLNVG_STROKE)
+		glnvg__stroke(gl, call);
+	else if (call->type == GLNVG_TRIANGLES || call->type == GLNVG_SPRITES)
+		glnvg__triangles(gl, call);
+}
+
+static void glnvg__drawBatch(GLNVGcontext* gl, const int* order, int ncalls)
+{
+	GLNVGcall* call = &gl->calls[order[0]];
+	float bounds[4];
+	int i, j, ndraws = 0, disjoint = 1;
+
+	for (i = 0; i < ncalls; i++)
+		ndraws += call->type == GLNVG_TRIANGLES || call->type == GLNVG_SPRITES ? 1 : gl->calls[order[i]].pathCount;
+
+	if (!glnvg__allocDraws(gl, ndraws)) {
+		for (i = 0; i < ncalls; i++)
+			glnvg__drawCall(gl, &gl->calls[order[i]]);
+		return;
+	}
+
+	glnvg__setUniforms(gl, call->uniformOffset, call->image);
+	glnvg__checkError(gl, "batch", __LINE__);
+
+	if (call->type == GLNVG_TRIANGLES || call->type == GLNVG_SPRITES) {
+		for (i = 0; i < ncalls; i++) {
+			GLNVGcall* other = &gl->calls[order[i]];
+			glnvg__addDraw(gl, other->triangleOffset, other->triangleCount, 1);
+		}
+		glnvg__multiDrawArrays(gl, GL_TRIANGLES);
+	} else if (call->type == GLNVG_STROKE) {
+		for (i = 0; i < ncalls; i++) {
+			GLNVGcall* other = &gl->calls[order[i]];
+			for (j = 0; j < other->pathCount; j++)
+				glnvg__addDraw(gl, gl->paths[other->pathOffset + j].strokeOffset,
+							   gl->paths[other->pathOffset + j].strokeCount, 0);
+		}
+		glnvg__multiDrawArrays(gl, GL_TRIANGLE_STRIP);
+	} else {
+		// The fans of all the fills can be drawn before their fringes only if they don't overlap
+		glnvg__initBounds(bounds);
+		for (i = 0; i < ncalls && disjoint; i++) {
+			GLNVGcall* other = &gl->calls[order[i]];
+			disjoint = !glnvg__overlap(other->bounds, bounds);
+			glnvg__unionBounds(bounds, other->bounds);
+		}
+
+		if (!disjoint) {
+			for (i = 0; i < ncalls; i++)
+				glnvg__convexFillPaths(gl, &gl->calls[order[i]]);
+			return;
+		}
+
+		for (i = 0; i < ncalls; i++) {
+			GLNVGcall* other = &gl->calls[order[i]];
+			for (j = 0; j < other->pathCount; j++)
+				glnvg__addDraw(gl, gl->paths[other->pathOffset + j].fillOffset,
+							   gl->paths[other->pathOffset + j].fillCount, 0);
+		}
+		glnvg__multiDrawArrays(gl, GL_TRIANGLE_FAN);
+
+		if (gl->flags & NVG_ANTIALIAS) {
+			for (i = 0; i < ncalls; i++) {
+				GLNVGcall* other = &gl->calls[order[i]];
+				for (j = 0; j < other->pathCount; j++)
+					glnvg__addDraw(gl, gl->paths[other->pathOffset + j].strokeOffset,
+								   gl->paths[other->pathOffset + j].strokeCount, 0);
+			}
+			glnvg__multiDrawArrays(gl, GL_TRIANGLE_STRIP);
+		}
+	}
+}
+
+static void glnvg__vertexAttribPointers(int base)
+{
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(NVGvertex), (const GLvoid*)(size_t)base);
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(NVGvertex), (const GLvoid*)(base + 2*sizeof(float)));
+}
+
+static void glnvg__spriteAttribPointers(int base)
+{
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(NVGspriteVertex), (const GLvoid*)(size_t)base);
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(NVGspriteVertex), (const GLvoid*)(base + 2*sizeof(float)));
+	glVertexAttribPointer(GLNVG_ATTRIB_SPRITETINT, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(NVGspriteVertex),
+						  (const GLvoid*)(base + 4*sizeof(float)));
+	glVertexAttribPointer(GLNVG_ATTRIB_SPRITEALPHA, 1, GL_FLOAT, GL_FALSE, sizeof(NVGspriteVertex),
+						  (const GLvoid*)(base + 4*sizeof(float) + 4));
+}
+
+#if NANOVG_GL_USE_INSTANCES
+static void glnvg__instanceAttribPointers(int instanceBase, int offset)
+{
+	size_t base = instanceBase + offset * sizeof(NVGinstance);
+	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(NVGinstance), (const GLvoid*)(base + 0*sizeof(float)));
+	glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, sizeof(NVGinstance), (const GLvoid*)(base + 2*sizeof(float)));
+	glVertexAttribPointer(4, 2, GL_FLOAT, GL_FALSE, sizeof(NVGinstance), (const GLvoid*)(base + 4*sizeof(float)));
+	glVertexAttribPointer(5, 4, GL_FLOAT, GL_FALSE, sizeof(NVGinstance), (const GLvoid*)(base + 6*sizeof(float)));
+	glVertexAttribPointer(6, 2, GL_FLOAT, GL_FALSE, sizeof(NVGinstance), (const GLvoid*)(base + 10*sizeof(float)));
+}
+#endif
+
+#if defined NANOVG_GL3
+static void glnvg__createVertexArray(GLNVGcontext* gl, GLuint* vertArr, GLuint buffer)
+{
+#if NANOVG_GL_USE_INSTANCES
+	int i;
+#endif
+	NVG_NOTUSED(gl);
+
+	// The enabled attributes and their divisors are kept by the vertex array
+	glGenVertexArrays(1, vertArr);
+	glBindVertexArray(*vertArr);
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	glEnableVertexAttribArray(0);
+	glEnableVertexAttribArray(1);
+	glnvg__vertexAttribPointers(0);
+#if NANOVG_GL_USE_INSTANCES
+	glBindBuffer(GL_ARRAY_BUFFER, gl->instanceBuf);
+	for (i = 2; i <= 6; i++) {
+		glEnableVertexAttribArray(i);
+		glVertexAttribDivisor(i, 1);
+	}
+	glnvg__instanceAttribPointers(0, 0);
+#endif
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+static void glnvg__createSpriteArray(GLNVGcontext* gl)
+{
+	glGenVertexArrays(1, &gl->spriteArr);
+	glBindVertexArray(gl->spriteArr);
+	glBindBuffer(GL_ARRAY_BUFFER, gl->spriteBuf);
+	glEnableVertexAttribArray(0);
+	glEnableVertexAttribArray(1);
+	glEnableVertexAttribArray(GLNVG_ATTRIB_SPRITETINT);
+	glEnableVertexAttribArray(GLNVG_ATTRIB_SPRITEALPHA);
+	glnvg__spriteAttribPointers(0);
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+static GLNVGvertexArray* glnvg__allocVertexArray(GLNVGcontext* gl)
+{
+	GLNVGvertexArray* vertexArray;
+
+	if (gl->freeVertexArray != 0) {
+		vertexArray = &gl->vertexArrays[gl->freeVertexArray - 1];
+		gl->freeVertexArray = vertexArray->nextFree;
+	} else {
+		if (gl->nvertexArrays+1 > gl->cvertexArrays) {
+			GLNVGvertexArray* vertexArrays;
+			int cvertexArrays = glnvg__maxi(gl->nvertexArrays+1, 64) + gl->cvertexArrays/2; // 1.5x Overallocate
+			vertexArrays = (GLNVGvertexArray*)realloc(gl->vertexArrays, sizeof(GLNVGvertexArray) * cvertexArrays);
+			if (vertexArrays == NULL) return NULL;
+			gl->vertexArrays = vertexArrays;
+			gl->cvertexArrays = cvertexArrays;
+		}
+		vertexArray = &gl->vertexArrays[gl->nvertexArrays++];
+	}
+
+	memset(vertexArray, 0, sizeof(*vertexArray));
+	return vertexArray;
+}
+#endif
+
+// Binds the vertices of a buffer returned by renderCreateBuffer, the frame vertices if it is 0,
+// or the frame sprite vertices if it is GLNVG_SPRITE_BUFFER.
+static void glnvg__bindVertexBuffer(GLNVGcontext* gl, int buffer)
+{
+#if defined NANOVG_GL3
+	if (buffer == GLNVG_SPRITE_BUFFER)
+		glBindVertexArray(gl->spriteArr);
+	else
+		glBindVertexArray(buffer != 0 ? gl->vertexArrays[buffer - 1].vertArr : gl->vertArr);
+#else
+	if (buffer == GLNVG_SPRITE_BUFFER) {
+		glBindBuffer(GL_ARRAY_BUFFER, gl->spriteBuf);
+		glEnableVertexAttribArray(GLNVG_ATTRIB_SPRITETINT);
+		glEnableVertexAttribArray(GLNVG_ATTRIB_SPRITEALPHA);
+		glnvg__spriteAttribPointers(gl->spriteBase);
+		return;
+	}
+
+	glDisableVertexAttribArray(GLNVG_ATTRIB_SPRITETINT);
+	glDisableVertexAttribArray(GLNVG_ATTRIB_SPRITEALPHA);
+	glBindBuffer(GL_ARRAY_BUFFER, buffer != 0 ? (GLuint)buffer : gl->vertBuf);
+	glnvg__vertexAttribPointers(buffer != 0 ? 0 : gl->vertBase);
+#endif
+}
+
+static void glnvg__deleteBuffers(GLNVGcontext* gl)
+{
+#if defined NANOVG_GL3
+	int i;
+	for (i = 0; i < gl->ndeletedBuffers; i++) {
+		GLNVGvertexArray* vertexArray = &gl->vertexArrays[gl->deletedBuffers[i] - 1];
+		glDeleteVertexArrays(1, &vertexArray->vertArr);
+		glDeleteBuffers(1, &vertexArray->buffer);
+		vertexArray->vertArr = 0;
+		vertexArray->buffer = 0;
+		vertexArray->nextFree = gl->freeVertexArray;
+		gl->freeVertexArray = gl->deletedBuffers[i];
+	}
+	gl->ndeletedBuffers = 0;
+#else
+	if (gl->ndeletedBuffers > 0) {
+		glDeleteBuffers(gl->ndeletedBuffers, gl->deletedBuffers);
+		gl->ndeletedBuffers = 0;
+	}
+#endif
+}
+
+#if defined NANOVG_GL3
+static void glnvg__waitStreamFrame(GLNVGcontext* gl)
+{
+	GLsync fence = gl->streamFences[gl->streamFrame];
+	GLenum result;
+	if (fence == NULL) return;
+
+	// The frame drawn GLNVG_STREAM_FRAMES flushes ago is usually done, so this rarely blocks
+	do {
+		result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+	} while (result == GL_TIMEOUT_EXPIRED);
+
+	glDeleteSync(fence);
+	gl->streamFences[gl->streamFrame] = NULL;
 }
 
+// Writes the data in the region of the current frame of the buffer bound to target, and returns its offset.
+static int glnvg__streamData(GLNVGcontext* gl, GLenum target, int* regionSize, const void* data, int size,
+							 int align)
+{
+	int offset;
+	void* ptr;
+	if (size == 0) return 0;
+
+	if (size > *regionSize) {
+		// Orphan the buffer, pending draws keep reading the old storage
+		*regionSize = glnvg__maxi(size, 4096) + *regionSize/2; // 1.5x Overallocate
+		*regionSize = (*regionSize + align - 1) / align * align;
+		glBufferData(target, *regionSize * GLNVG_STREAM_FRAMES, NULL, GL_STREAM_DRAW);
+	}
+
+	offset = gl->streamFrame * *regionSize;
+	ptr = glMapBufferRange(target, offset, size,
+						   GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+	if (ptr != NULL) {
+		memcpy(ptr, data, size);
+		if (glUnmapBuffer(target) == GL_TRUE)
+			return offset;
+	}
+
+	// The mapping failed or its contents were lost
+	glBufferSubData(target, offset, size, data);
+	return offset;
+}
+
+static void glnvg__deleteStreamFences(GLNVGcontext* gl)
+{
+	int i;
+	for (i = 0; i < GLNVG_STREAM_FRAMES; i++) {
+		if (gl->streamFences[i] != NULL) {
+			glDeleteSync(gl->streamFences[i]);
+			gl->streamFences[i] = NULL;
+		}
+	}
+}
+#endif
+
 static void glnvg__renderCancel(void* uptr) {
 	GLNVGcontext* gl = (GLNVGcontext*)uptr;
+	glnvg__deleteBuffers(gl);
+	memset(&gl->frame, 0, sizeof(gl->frame));
 	gl->nverts = 0;
+	gl->nsprites = 0;
 	gl->npaths = 0;
 	gl->ncalls = 0;
 	gl->nuniforms = 0;
+	gl->ninstances = 0;
 }
 
 static void glnvg__renderFlush(void* uptr)
 {
 	GLNVGcontext* gl = (GLNVGcontext*)uptr;
 	float xform[9];
-	int i;
+	const float* boundXform = NULL;
+	int boundBuffer;
+	GLNVGshader* shader = &gl->shader;
+	int i, next;
 	
 	if (gl->ncalls > 0) {
 
@@ -1168,22 +1918,87 @@ static void glnvg__renderFlush(void* uptr)
 		gl->stencilFuncMask = 0xffffffff;
 		#endif
 
-#if NANOVG_GL_USE_UNIFORMBUFFER
+		gl->vertBase = 0;
+		gl->spriteBase = 0;
+		gl->fragBase = 0;
+		gl->instanceBase = 0;
+
+#if defined NANOVG_GL3
+		if (gl->flags & NVG_STREAMING_BUFFERS) {
+			gl->streamFrame = (gl->streamFrame + 1) % GLNVG_STREAM_FRAMES;
+			glnvg__waitStreamFrame(gl);
+		}
+#endif
+
+#if NANOVG_GL_USE_UNIFORMBUFFER
 		// Upload ubo for frag shaders
 		glBindBuffer(GL_UNIFORM_BUFFER, gl->fragBuf);
-		glBufferData(GL_UNIFORM_BUFFER, gl->nuniforms * gl->fragSize, gl->uniforms, GL_STREAM_DRAW);
+		if (gl->flags & NVG_STREAMING_BUFFERS) {
+			gl->fragBase = glnvg__streamData(gl, GL_UNIFORM_BUFFER, &gl->fragRegionSize, gl->uniforms,
+											 gl->nuniforms * gl->fragSize, gl->fragSize);
+		} else {
+			glBufferData(GL_UNIFORM_BUFFER, gl->nuniforms * gl->fragSize, gl->uniforms, GL_STREAM_DRAW);
+			gl->fragRegionSize = 0;
+		}
+#endif
+
+		// Upload sprite vertex data
+		if (gl->nsprites > 0) {
+#if defined NANOVG_GL3
+			glBindVertexArray(gl->spriteArr);
+			glBindBuffer(GL_ARRAY_BUFFER, gl->spriteBuf);
+			if (gl->flags & NVG_STREAMING_BUFFERS) {
+				gl->spriteBase = glnvg__streamData(gl, GL_ARRAY_BUFFER, &gl->spriteRegionSize, gl->sprites,
+												   gl->nsprites * sizeof(NVGspriteVertex), sizeof(NVGspriteVertex));
+			} else {
+				glBufferData(GL_ARRAY_BUFFER, gl->nsprites * sizeof(NVGspriteVertex), gl->sprites, GL_STREAM_DRAW);
+				gl->spriteRegionSize = 0;
+			}
+			glnvg__spriteAttribPointers(gl->spriteBase);
+#else
+			glBindBuffer(GL_ARRAY_BUFFER, gl->spriteBuf);
+			glBufferData(GL_ARRAY_BUFFER, gl->nsprites * sizeof(NVGspriteVertex), gl->sprites, GL_STREAM_DRAW);
 #endif
+		}
 
 		// Upload vertex data
 #if defined NANOVG_GL3
 		glBindVertexArray(gl->vertArr);
 #endif
 		glBindBuffer(GL_ARRAY_BUFFER, gl->vertBuf);
-		glBufferData(GL_ARRAY_BUFFER, gl->nverts * sizeof(NVGvertex), gl->verts, GL_STREAM_DRAW);
+		if (gl->nverts > 0) {
+#if defined NANOVG_GL3
+			if (gl->flags & NVG_STREAMING_BUFFERS) {
+				gl->vertBase = glnvg__streamData(gl, GL_ARRAY_BUFFER, &gl->vertRegionSize, gl->verts,
+												 gl->nverts * sizeof(NVGvertex), sizeof(NVGvertex));
+			} else {
+				glBufferData(GL_ARRAY_BUFFER, gl->nverts * sizeof(NVGvertex), gl->verts, GL_STREAM_DRAW);
+				gl->vertRegionSize = 0;
+			}
+#else
+			glBufferData(GL_ARRAY_BUFFER, gl->nverts * sizeof(NVGvertex), gl->verts, GL_STREAM_DRAW);
+#endif
+		}
+#if !defined NANOVG_GL3
 		glEnableVertexAttribArray(0);
 		glEnableVertexAttribArray(1);
-		glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(NVGvertex), (const GLvoid*)(size_t)0);
-		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(NVGvertex), (const GLvoid*)(0 + 2*sizeof(float)));
+#endif
+		glnvg__vertexAttribPointers(gl->vertBase);
+		boundBuffer = 0;
+
+#if NANOVG_GL_USE_INSTANCES
+		// Upload instance data, read once per instance by the instance shader
+		if (gl->ninstances > 0) {
+			glBindBuffer(GL_ARRAY_BUFFER, gl->instanceBuf);
+			if (gl->flags & NVG_STREAMING_BUFFERS) {
+				gl->instanceBase = glnvg__streamData(gl, GL_ARRAY_BUFFER, &gl->instanceRegionSize, gl->instances,
+													 gl->ninstances * sizeof(NVGinstance), sizeof(NVGinstance));
+			} else {
+				glBufferData(GL_ARRAY_BUFFER, gl->ninstances * sizeof(NVGinstance), gl->instances, GL_STREAM_DRAW);
+				gl->instanceRegionSize = 0;
+			}
+		}
+#endif
 		
 		// Set view and texture just once per frame.
 		glUniform1i(gl->shader.loc[GLNVG_LOC_TEX], 0);
@@ -1203,30 +2018,64 @@ static void glnvg__renderFlush(void* uptr)
 	glUniform3fv(gl->shader.loc[GLNVG_LOC_XFORM], 3, xform);
 #endif
 
-		for (i = 0; i < gl->ncalls; i++) {
-			GLNVGcall* call = &gl->calls[i];
+		glnvg__sortCalls(gl);
+
+		for (i = 0; i < gl->ncalls; i = next) {
+			GLNVGcall* call = &gl->calls[gl->order[i]];
+
+			if (call->buffer != boundBuffer) {
+				glnvg__bindVertexBuffer(gl, call->buffer);
+				boundBuffer = call->buffer;
+			}
+
+#if NANOVG_GL_USE_INSTANCES
+			if ((call->instanceCount > 0) != (shader == &gl->instanceShader)) {
+				shader = call->instanceCount > 0 ? &gl->instanceShader : &gl->shader;
+				glUseProgram(shader->prog);
+				boundXform = NULL;
+			}
+
+			if (call->instanceCount > 0) {
+				glBindBuffer(GL_ARRAY_BUFFER, gl->instanceBuf);
+				glnvg__instanceAttribPointers(gl->instanceBase, call->instanceOffset);
+			}
+#endif
 
 #if NVG_TRANSFORM_IN_VERTEX_SHADER
-			//transpose for matrix form
-			xform[0] = call->xform[0]; xform[1] = call->xform[2]; xform[2] = call->xform[4];
-			xform[3] = call->xform[1]; xform[4] = call->xform[3]; xform[5] = call->xform[5];
-			glUniform3fv(gl->shader.loc[GLNVG_LOC_XFORM], 3, xform);
-#endif
-			
-			if (call->type == GLNVG_FILL)
-				glnvg__fill(gl, call);
-			else if (call->type == GLNVG_CONVEXFILL)
-				glnvg__convexFill(gl, call);
-			else if (call->type == GLNVG_STROKE)
-				glnvg__stroke(gl, call);
-			else if (call->type == GLNVG_TRIANGLES)
-				glnvg__triangles(gl, call);
+			if (boundXform == NULL || memcmp(boundXform, call->xform, sizeof(call->xform)) != 0) {
+				//transpose for matrix form
+				xform[0] = call->xform[0]; xform[1] = call->xform[2]; xform[2] = call->xform[4];
+				xform[3] = call->xform[1]; xform[4] = call->xform[3]; xform[5] = call->xform[5];
+				glUniform3fv(shader->loc[GLNVG_LOC_XFORM], 3, xform);
+				boundXform = call->xform;
+			}
+#endif
+
+			next = i + 1;
+			while (next < gl->ncalls && glnvg__mergeable(gl, call, &gl->calls[gl->order[next]]))
+				next++;
+
+			glnvg__countCalls(gl, &gl->order[i], next - i);
+
+			if (next - i > 1) {
+				glnvg__drawBatch(gl, &gl->order[i], next - i);
+				gl->frame.mergedCalls += next - i - 1;
+			} else {
+				glnvg__drawCall(gl, call);
+			}
 		}
 
+#if !defined NANOVG_GL3
 		glDisableVertexAttribArray(0);
 		glDisableVertexAttribArray(1);
-#if defined NANOVG_GL3
+		glDisableVertexAttribArray(GLNVG_ATTRIB_SPRITETINT);
+		glDisableVertexAttribArray(GLNVG_ATTRIB_SPRITEALPHA);
+#else
 		glBindVertexArray(0);
+
+		// Fence the regions written this frame, so they aren't written again while they are drawn
+		if (gl->flags & NVG_STREAMING_BUFFERS)
+			gl->streamFences[gl->streamFrame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
 #endif	
 		glDisable(GL_CULL_FACE);
 			glBindBuffer(GL_ARRAY_BUFFER, 0);
@@ -1234,11 +2083,18 @@ static void glnvg__renderFlush(void* uptr)
 		glnvg__bindTexture(gl, 0, GL_TEXTURE_2D);
 	}
 
+	glnvg__deleteBuffers(gl);
+
+	gl->lastFrame = gl->frame;
+	memset(&gl->frame, 0, sizeof(gl->frame));
+
 	// Reset calls
 	gl->nverts = 0;
+	gl->nsprites = 0;
 	gl->npaths = 0;
 	gl->ncalls = 0;
 	gl->nuniforms = 0;
+	gl->ninstances = 0;
 }
 
 static int glnvg__maxVertCount(const NVGpath* paths, int npaths)
@@ -1256,14 +2112,20 @@ static GLNVGcall* glnvg__allocCall(GLNVGcontext* gl)
 	GLNVGcall* ret = NULL;
 	if (gl->ncalls+1 > gl->ccalls) {
 		GLNVGcall* calls;
+		int* order;
 		int ccalls = glnvg__maxi(gl->ncalls+1, 128) + gl->ccalls/2; // 1.5x Overallocate
 		calls = (GLNVGcall*)realloc(gl->calls, sizeof(GLNVGcall) * ccalls);
 		if (calls == NULL) return NULL;
 		gl->calls = calls;
+		order = (int*)realloc(gl->order, sizeof(int) * ccalls);
+		if (order == NULL) return NULL;
+		gl->order = order;
 		gl->ccalls = ccalls;
 	}
 	ret = &gl->calls[gl->ncalls++];
 	memset(ret, 0, sizeof(GLNVGcall));
+	ret->bounds[0] = ret->bounds[1] = -FLT_MAX;
+	ret->bounds[2] = ret->bounds[3] = FLT_MAX;
 	return ret;
 }
 
@@ -1299,6 +2161,22 @@ static int glnvg__allocVerts(GLNVGcontext* gl, int n)
 	return ret;
 }
 
+static int glnvg__allocSprites(GLNVGcontext* gl, int n)
+{
+	int ret = 0;
+	if (gl->nsprites+n > gl->csprites) {
+		NVGspriteVertex* sprites;
+		int csprites = glnvg__maxi(gl->nsprites + n, 4096) + gl->csprites/2; // 1.5x Overallocate
+		sprites = (NVGspriteVertex*)realloc(gl->sprites, sizeof(NVGspriteVertex) * csprites);
+		if (sprites == NULL) return -1;
+		gl->sprites = sprites;
+		gl->csprites = csprites;
+	}
+	ret = gl->nsprites;
+	gl->nsprites += n;
+	return ret;
+}
+
 static int glnvg__allocFragUniforms(GLNVGcontext* gl, int n)
 {
 	int ret = 0, structSize = gl->fragSize;
@@ -1320,6 +2198,23 @@ static GLNVGfragUniforms* nvg__fragUniformPtr(GLNVGcontext* gl, int i)
 	return (GLNVGfragUniforms*)&gl->uniforms[i];
 }
 
+// Per frame vertices are copied in window space, so calls with other transforms can be merged
+static void glnvg__copyVerts(NVGvertex* dst, const NVGvertex* src, int nverts, const float* xform)
+{
+#if NVG_TRANSFORM_IN_VERTEX_SHADER
+	int i;
+	for (i = 0; i < nverts; i++) {
+		dst[i].x = src[i].x*xform[0] + src[i].y*xform[2] + xform[4];
+		dst[i].y = src[i].x*xform[1] + src[i].y*xform[3] + xform[5];
+		dst[i].u = src[i].u;
+		dst[i].v = src[i].v;
+	}
+#else
+	NVG_NOTUSED(xform);
+	memcpy(dst, src, sizeof(NVGvertex) * nverts);
+#endif
+}
+
 static void glnvg__vset(NVGvertex* vtx, float x, float y, float u, float v)
 {
 	vtx->x = x;
@@ -1328,13 +2223,76 @@ static void glnvg__vset(NVGvertex* vtx, float x, float y, float u, float v)
 	vtx->v = v;
 }
 
+static int glnvg__fillUniforms(GLNVGcontext* gl, GLNVGcall* call, NVGpaint* paint, NVGscissor* scissor,
+							   const float* xform, float fringe)
+{
+	GLNVGfragUniforms* frag;
+
+	// Setup uniforms for draw calls
+	if (call->type == GLNVG_FILL) {
+		call->uniformOffset = glnvg__allocFragUniforms(gl, 2);
+		if (call->uniformOffset == -1) return -1;
+		// Simple shader for stencil
+		frag = nvg__fragUniformPtr(gl, call->uniformOffset);
+		memset(frag, 0, sizeof(*frag));
+		frag->strokeThr = -1.0f;
+		frag->type = NSVG_SHADER_SIMPLE;
+		// Fill shader
+		glnvg__convertPaint(gl, nvg__fragUniformPtr(gl, call->uniformOffset + gl->fragSize), paint, scissor, xform, fringe, fringe, -1.0f);
+	} else {
+		call->uniformOffset = glnvg__allocFragUniforms(gl, 1);
+		if (call->uniformOffset == -1) return -1;
+		// Fill shader
+		glnvg__convertPaint(gl, nvg__fragUniformPtr(gl, call->uniformOffset), paint, scissor, xform, fringe, fringe, -1.0f);
+	}
+
+	return 0;
+}
+
+static int glnvg__strokeUniforms(GLNVGcontext* gl, GLNVGcall* call, NVGpaint* paint, NVGscissor* scissor,
+								 const float* xform, float fringe, float strokeWidth)
+{
+	if (gl->flags & NVG_STENCIL_STROKES) {
+		// Fill shader
+		call->uniformOffset = glnvg__allocFragUniforms(gl, 2);
+		if (call->uniformOffset == -1) return -1;
+
+		glnvg__convertPaint(gl, nvg__fragUniformPtr(gl, call->uniformOffset), paint, scissor, xform, strokeWidth, fringe, -1.0f);
+		glnvg__convertPaint(gl, nvg__fragUniformPtr(gl, call->uniformOffset + gl->fragSize), paint, scissor, xform, strokeWidth, fringe, 1.0f - 0.5f/255.0f);
+
+	} else {
+		// Fill shader
+		call->uniformOffset = glnvg__allocFragUniforms(gl, 1);
+		if (call->uniformOffset == -1) return -1;
+		glnvg__convertPaint(gl, nvg__fragUniformPtr(gl, call->uniformOffset), paint, scissor, xform, strokeWidth, fringe, -1.0f);
+	}
+
+	return 0;
+}
+
+static int glnvg__trianglesUniforms(GLNVGcontext* gl, GLNVGcall* call, NVGpaint* paint, NVGscissor* scissor,
+									const float* xform)
+{
+	GLNVGfragUniforms* frag;
+
+	// Fill shader
+	call->uniformOffset = glnvg__allocFragUniforms(gl, 1);
+	if (call->uniformOffset == -1) return -1;
+	frag = nvg__fragUniformPtr(gl, call->uniformOffset);
+	glnvg__convertPaint(gl, frag, paint, scissor, xform, 1.0f, 1.0f, -1.0f);
+	frag->type = paint->image != 0 ? NSVG_SHADER_IMG : NSVG_SHADER_SOLIDCOLOR;
+	memset(frag->paintMat, 0, sizeof(frag->paintMat));
+
+	return 0;
+}
+
 static void glnvg__renderFill(void* uptr, NVGpaint* paint, NVGscissor* scissor, const float* xform, float fringe,
 							  const float* bounds, const NVGpath* paths, int npaths)
 {
 	GLNVGcontext* gl = (GLNVGcontext*)uptr;
 	GLNVGcall* call = glnvg__allocCall(gl);
 	NVGvertex* quad;
-	GLNVGfragUniforms* frag;
+	float vertexBounds[4];
 	int i, maxverts, offset;
 
 	if (call == NULL) return;
@@ -1345,7 +2303,7 @@ static void glnvg__renderFill(void* uptr, NVGpaint* paint, NVGscissor* scissor,
 	call->pathCount = npaths;
 	call->image = paint->image;
 
-	memcpy(call->xform, xform, sizeof(float) * 6);
+	nvgTransformIdentity(call->xform);
 
 	if (npaths == 1 && paths[0].convex)
 		call->type = GLNVG_CONVEXFILL;
@@ -1355,6 +2313,7 @@ static void glnvg__renderFill(void* uptr, NVGpaint* paint, NVGscissor* scissor,
 	offset = glnvg__allocVerts(gl, maxverts);
 	if (offset == -1) goto error;
 
+	glnvg__initBounds(vertexBounds);
 	for (i = 0; i < npaths; i++) {
 		GLNVGpath* copy = &gl->paths[call->pathOffset + i];
 		const NVGpath* path = &paths[i];
@@ -1362,13 +2321,15 @@ static void glnvg__renderFill(void* uptr, NVGpaint* paint, NVGscissor* scissor,
 		if (path->nfill > 0) {
 			copy->fillOffset = offset;
 			copy->fillCount = path->nfill;
-			memcpy(&gl->verts[offset], path->fill, sizeof(NVGvertex) * path->nfill);
+			glnvg__copyVerts(&gl->verts[offset], path->fill, path->nfill, xform);
+			glnvg__vertexBounds(vertexBounds, &gl->verts[offset], path->nfill);
 			offset += path->nfill;
 		}
 		if (path->nstroke > 0) {
 			copy->strokeOffset = offset;
 			copy->strokeCount = path->nstroke;
-			memcpy(&gl->verts[offset], path->stroke, sizeof(NVGvertex) * path->nstroke);
+			glnvg__copyVerts(&gl->verts[offset], path->stroke, path->nstroke, xform);
+			glnvg__vertexBounds(vertexBounds, &gl->verts[offset], path->nstroke);
 			offset += path->nstroke;
 		}
 	}
@@ -1384,24 +2345,11 @@ static void glnvg__renderFill(void* uptr, NVGpaint* paint, NVGscissor* scissor,
 	glnvg__vset(&quad[3], bounds[0], bounds[3], 0.5f, 1.0f);
 	glnvg__vset(&quad[4], bounds[2], bounds[1], 0.5f, 1.0f);
 	glnvg__vset(&quad[5], bounds[0], bounds[1], 0.5f, 1.0f);
+	glnvg__copyVerts(quad, quad, 6, xform);
+	glnvg__vertexBounds(vertexBounds, quad, 6);
+	glnvg__setCallBounds(call, vertexBounds);
 
-	// Setup uniforms for draw calls
-	if (call->type == GLNVG_FILL) {
-		call->uniformOffset = glnvg__allocFragUniforms(gl, 2);
-		if (call->uniformOffset == -1) goto error;
-		// Simple shader for stencil
-		frag = nvg__fragUniformPtr(gl, call->uniformOffset);
-		memset(frag, 0, sizeof(*frag));
-		frag->strokeThr = -1.0f;
-		frag->type = NSVG_SHADER_SIMPLE;
-		// Fill shader
-		glnvg__convertPaint(gl, nvg__fragUniformPtr(gl, call->uniformOffset + gl->fragSize), paint, scissor, xform, fringe, fringe, -1.0f);
-	} else {
-		call->uniformOffset = glnvg__allocFragUniforms(gl, 1);
-		if (call->uniformOffset == -1) goto error;
-		// Fill shader
-		glnvg__convertPaint(gl, nvg__fragUniformPtr(gl, call->uniformOffset), paint, scissor, xform, fringe, fringe, -1.0f);
-	}
+	if (glnvg__fillUniforms(gl, call, paint, scissor, xform, fringe) == -1) goto error;
 
 	return;
 
@@ -1416,6 +2364,7 @@ static void glnvg__renderStroke(void* uptr, NVGpaint* paint, NVGscissor* scissor
 {
 	GLNVGcontext* gl = (GLNVGcontext*)uptr;
 	GLNVGcall* call = glnvg__allocCall(gl);
+	float vertexBounds[4];
 	int i, maxverts, offset;
 
 	if (call == NULL) return;
@@ -1426,13 +2375,14 @@ static void glnvg__renderStroke(void* uptr, NVGpaint* paint, NVGscissor* scissor
 	call->pathCount = npaths;
 	call->image = paint->image;
 
-	memcpy(call->xform, xform, sizeof(float) * 6);
+	nvgTransformIdentity(call->xform);
 
 	// Allocate vertices for all the paths.
 	maxverts = glnvg__maxVertCount(paths, npaths);
 	offset = glnvg__allocVerts(gl, maxverts);
 	if (offset == -1) goto error;
 
+	glnvg__initBounds(vertexBounds);
 	for (i = 0; i < npaths; i++) {
 		GLNVGpath* copy = &gl->paths[call->pathOffset + i];
 		const NVGpath* path = &paths[i];
@@ -1440,25 +2390,14 @@ static void glnvg__renderStroke(void* uptr, NVGpaint* paint, NVGscissor* scissor
 		if (path->nstroke) {
 			copy->strokeOffset = offset;
 			copy->strokeCount = path->nstroke;
-			memcpy(&gl->verts[offset], path->stroke, sizeof(NVGvertex) * path->nstroke);
+			glnvg__copyVerts(&gl->verts[offset], path->stroke, path->nstroke, xform);
+			glnvg__vertexBounds(vertexBounds, &gl->verts[offset], path->nstroke);
 			offset += path->nstroke;
 		}
 	}
+	glnvg__setCallBounds(call, vertexBounds);
 
-	if (gl->flags & NVG_STENCIL_STROKES) {
-		// Fill shader
-		call->uniformOffset = glnvg__allocFragUniforms(gl, 2);
-		if (call->uniformOffset == -1) goto error;
-
-		glnvg__convertPaint(gl, nvg__fragUniformPtr(gl, call->uniformOffset), paint, scissor, xform, strokeWidth, fringe, -1.0f);
-		glnvg__convertPaint(gl, nvg__fragUniformPtr(gl, call->uniformOffset + gl->fragSize), paint, scissor, xform, strokeWidth, fringe, 1.0f - 0.5f/255.0f);
-
-	} else {
-		// Fill shader
-		call->uniformOffset = glnvg__allocFragUniforms(gl, 1);
-		if (call->uniformOffset == -1) goto error;
-		glnvg__convertPaint(gl, nvg__fragUniformPtr(gl, call->uniformOffset), paint, scissor, xform, strokeWidth, fringe, -1.0f);
-	}
+	if (glnvg__strokeUniforms(gl, call, paint, scissor, xform, fringe, strokeWidth) == -1) goto error;
 
 	return;
 
@@ -1473,28 +2412,26 @@ static void glnvg__renderTriangles(void* uptr, NVGpaint* paint, NVGscissor* scis
 {
 	GLNVGcontext* gl = (GLNVGcontext*)uptr;
 	GLNVGcall* call = glnvg__allocCall(gl);
-	GLNVGfragUniforms* frag;
+	float vertexBounds[4];
 
 	if (call == NULL) return;
 
 	call->type = GLNVG_TRIANGLES;
 	call->image = paint->image;
 
-	memcpy(call->xform, xform, sizeof(float) * 6);
+	nvgTransformIdentity(call->xform);
 
 	// Allocate vertices for all the paths.
 	call->triangleOffset = glnvg__allocVerts(gl, nverts);
 	if (call->triangleOffset == -1) goto error;
 	call->triangleCount = nverts;
 
-	memcpy(&gl->verts[call->triangleOffset], verts, sizeof(NVGvertex) * nverts);
+	glnvg__copyVerts(&gl->verts[call->triangleOffset], verts, nverts, xform);
+	glnvg__initBounds(vertexBounds);
+	glnvg__vertexBounds(vertexBounds, &gl->verts[call->triangleOffset], nverts);
+	glnvg__setCallBounds(call, vertexBounds);
 
-	// Fill shader
-	call->uniformOffset = glnvg__allocFragUniforms(gl, 1);
-	if (call->uniformOffset == -1) goto error;
-	frag = nvg__fragUniformPtr(gl, call->uniformOffset);
-	glnvg__convertPaint(gl, frag, paint, scissor, xform, 1.0f, 1.0f, -1.0f);
-	frag->type = paint->image != 0 ? NSVG_SHADER_IMG : NSVG_SHADER_SOLIDCOLOR;
+	if (glnvg__trianglesUniforms(gl, call, paint, scissor, xform) == -1) goto error;
 
 	return;
 
@@ -1504,6 +2441,304 @@ error:
 	if (gl->ncalls > 0) gl->ncalls--;
 }
 
+// Sprites are drawn with a paint of their whole texture, so the uniforms of sprites with the same texture and
+// scissor are the same.
+static int glnvg__spriteUniforms(GLNVGcontext* gl, GLNVGfragUniforms* frag, GLNVGtexture* tex,
+								 NVGscissor* scissor)
+{
+	NVGpaint paint;
+	float xform[6];
+
+	memset(&paint, 0, sizeof(paint));
+	nvgTransformIdentity(paint.xform);
+	nvgTransformIdentity(xform);
+	paint.image = tex->id;
+	paint.innerColor = paint.outerColor = nvgRGBAf(1, 1, 1, 1);
+	paint.extent[0] = (float)tex->width;
+	paint.extent[1] = (float)tex->height;
+
+	if (!glnvg__convertPaint(gl, frag, &paint, scissor, xform, 1.0f, 1.0f, -1.0f)) return 0;
+	frag->type = NSVG_SHADER_SPRITE;
+	memset(frag->paintMat, 0, sizeof(frag->paintMat));
+	return 1;
+}
+
+static void glnvg__renderSprites(void* uptr, NVGscissor* scissor, int image, const NVGspriteVertex* verts,
+								 int nverts)
+{
+	GLNVGcontext* gl = (GLNVGcontext*)uptr;
+	GLNVGtexture* tex = glnvg__findTexture(gl, image);
+	GLNVGfragUniforms frag;
+	GLNVGcall* call;
+	float vertexBounds[4];
+	int i, offset;
+
+	if (tex == NULL || !glnvg__spriteUniforms(gl, &frag, tex, scissor)) return;
+
+	offset = glnvg__allocSprites(gl, nverts);
+	if (offset == -1) return;
+
+	memcpy(&gl->sprites[offset], verts, sizeof(NVGspriteVertex) * nverts);
+	glnvg__initBounds(vertexBounds);
+	for (i = 0; i < nverts; i++) {
+		NVGspriteVertex* vertex = &gl->sprites[offset + i];
+		if (tex->flags & NVG_IMAGE_FLIPY) vertex->v = 1.0f - vertex->v;
+		if (vertex->x < vertexBounds[0]) vertexBounds[0] = vertex->x;
+		if (vertex->y < vertexBounds[1]) vertexBounds[1] = vertex->y;
+		if (vertex->x > vertexBounds[2]) vertexBounds[2] = vertex->x;
+		if (vertex->y > vertexBounds[3]) vertexBounds[3] = vertex->y;
+	}
+
+	// Sprites drawn right after sprites with the same texture and scissor extend their call
+	call = gl->ncalls > 0 ? &gl->calls[gl->ncalls-1] : NULL;
+	if (call != NULL && call->type == GLNVG_SPRITES && call->image == image &&
+		call->triangleOffset + call->triangleCount == offset &&
+		memcmp(nvg__fragUniformPtr(gl, call->uniformOffset), &frag, sizeof(frag)) == 0) {
+		call->triangleCount += nverts;
+		glnvg__unionBounds(call->bounds, vertexBounds);
+		return;
+	}
+
+	call = glnvg__allocCall(gl);
+	if (call == NULL) goto error;
+
+	call->type = GLNVG_SPRITES;
+	call->image = image;
+	call->buffer = GLNVG_SPRITE_BUFFER;
+	call->triangleOffset = offset;
+	call->triangleCount = nverts;
+	nvgTransformIdentity(call->xform);
+	glnvg__setCallBounds(call, vertexBounds);
+
+	call->uniformOffset = glnvg__allocFragUniforms(gl, 1);
+	if (call->uniformOffset == -1) goto error;
+	memcpy(nvg__fragUniformPtr(gl, call->uniformOffset), &frag, sizeof(frag));
+
+	return;
+
+error:
+	// Roll back the call and its vertices to prevent drawing them.
+	if (call != NULL && gl->ncalls > 0) gl->ncalls--;
+	gl->nsprites = offset;
+}
+
+static int glnvg__renderCreateBuffer(void* uptr, const NVGvertex* verts, int nverts)
+{
+	GLuint buffer = 0;
+#if defined NANOVG_GL3
+	GLNVGcontext* gl = (GLNVGcontext*)uptr;
+	GLNVGvertexArray* vertexArray = glnvg__allocVertexArray(gl);
+	if (vertexArray == NULL) return 0;
+#else
+	NVG_NOTUSED(uptr);
+#endif
+
+	glGenBuffers(1, &buffer);
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	glBufferData(GL_ARRAY_BUFFER, nverts * sizeof(NVGvertex), verts, GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+#if defined NANOVG_GL3
+	// The returned buffer is the index + 1 of its vertex array
+	vertexArray->buffer = buffer;
+	glnvg__createVertexArray(gl, &vertexArray->vertArr, buffer);
+	return (int)(vertexArray - gl->vertexArrays) + 1;
+#else
+	return (int)buffer;
+#endif
+}
+
+static void glnvg__renderDeleteBuffer(void* uptr, int buffer)
+{
+	GLNVGcontext* gl = (GLNVGcontext*)uptr;
+
+	if (gl->ndeletedBuffers+1 > gl->cdeletedBuffers) {
+		GLuint* deletedBuffers;
+		int cdeletedBuffers = glnvg__maxi(gl->ndeletedBuffers+1, 64) + gl->cdeletedBuffers/2; // 1.5x Overallocate
+		deletedBuffers = (GLuint*)realloc(gl->deletedBuffers, sizeof(GLuint) * cdeletedBuffers);
+		if (deletedBuffers == NULL) return;
+		gl->deletedBuffers = deletedBuffers;
+		gl->cdeletedBuffers = cdeletedBuffers;
+	}
+
+	gl->deletedBuffers[gl->ndeletedBuffers++] = (GLuint)buffer;
+}
+
+static void glnvg__instanceColors(GLNVGcontext* gl, GLNVGcall* call, NVGpaint* paint, int nuniforms)
+{
+	int i;
+
+	// The instance shader tints and premultiplies the paint colors
+	for (i = 0; i < nuniforms; i++) {
+		GLNVGfragUniforms* frag = nvg__fragUniformPtr(gl, call->uniformOffset + i*gl->fragSize);
+		if (frag->type != NSVG_SHADER_SIMPLE) {
+			frag->innerCol = paint->innerColor;
+			frag->outerCol = paint->outerColor;
+		}
+	}
+}
+
+#if NANOVG_GL_USE_INSTANCES
+static int glnvg__renderInstances(void* uptr, const NVGinstance* instances, int ninstances)
+{
+	GLNVGcontext* gl = (GLNVGcontext*)uptr;
+	int ret = gl->ninstances;
+
+	if (gl->ninstances+ninstances > gl->cinstances) {
+		NVGinstance* newInstances;
+		int cinstances = glnvg__maxi(gl->ninstances+ninstances, 256) + gl->cinstances/2; // 1.5x Overallocate
+		newInstances = (NVGinstance*)realloc(gl->instances, sizeof(NVGinstance) * cinstances);
+		if (newInstances == NULL) return -1;
+		gl->instances = newInstances;
+		gl->cinstances = cinstances;
+	}
+
+	memcpy(&gl->instances[gl->ninstances], instances, sizeof(NVGinstance) * ninstances);
+	gl->ninstances += ninstances;
+	return ret;
+}
+#endif
+
+static void glnvg__renderFillBuffer(void* uptr, NVGpaint* paint, NVGscissor* scissor, const float* xform, float fringe,
+									int buffer, int quad, const NVGvertex* verts, const NVGpath* paths, int npaths,
+									int instances, int ninstances)
+{
+	GLNVGcontext* gl = (GLNVGcontext*)uptr;
+	GLNVGcall* call;
+	int i;
+
+	// The stencil of each instance must be cleared before drawing the next one
+	if (ninstances > 1 && (npaths != 1 || !paths[0].convex)) {
+		for (i = 0; i < ninstances; i++)
+			glnvg__renderFillBuffer(uptr, paint, scissor, xform, fringe, buffer, quad, verts, paths, npaths,
+									instances + i, 1);
+		return;
+	}
+
+	call = glnvg__allocCall(gl);
+	if (call == NULL) return;
+
+	call->type = GLNVG_FILL;
+	call->buffer = buffer;
+	call->instanceOffset = instances;
+	call->instanceCount = ninstances;
+	call->pathOffset = glnvg__allocPaths(gl, npaths);
+	if (call->pathOffset == -1) goto error;
+	call->pathCount = npaths;
+	call->image = paint->image;
+
+	memcpy(call->xform, xform, sizeof(float) * 6);
+
+	if (npaths == 1 && paths[0].convex)
+		call->type = GLNVG_CONVEXFILL;
+
+	// The vertices are already in the buffer, only their offsets are needed.
+	for (i = 0; i < npaths; i++) {
+		GLNVGpath* copy = &gl->paths[call->pathOffset + i];
+		const NVGpath* path = &paths[i];
+		memset(copy, 0, sizeof(GLNVGpath));
+		if (path->nfill > 0) {
+			copy->fillOffset = (int)(path->fill - verts);
+			copy->fillCount = path->nfill;
+		}
+		if (path->nstroke > 0) {
+			copy->strokeOffset = (int)(path->stroke - verts);
+			copy->strokeCount = path->nstroke;
+		}
+	}
+
+	call->triangleOffset = quad;
+	call->triangleCount = 6;
+
+	if (glnvg__fillUniforms(gl, call, paint, scissor, xform, fringe) == -1) goto error;
+	if (ninstances > 0)
+		glnvg__instanceColors(gl, call, paint, call->type == GLNVG_FILL ? 2 : 1);
+
+	return;
+
+error:
+	if (gl->ncalls > 0) gl->ncalls--;
+}
+
+static void glnvg__renderStrokeBuffer(void* uptr, NVGpaint* paint, NVGscissor* scissor, const float* xform, float fringe,
+									  float strokeWidth, int buffer, const NVGvertex* verts, const NVGpath* paths, int npaths,
+									  int instances, int ninstances)
+{
+	GLNVGcontext* gl = (GLNVGcontext*)uptr;
+	GLNVGcall* call;
+	int i;
+
+	// The stencil of each instance must be cleared before drawing the next one
+	if (ninstances > 1 && (gl->flags & NVG_STENCIL_STROKES)) {
+		for (i = 0; i < ninstances; i++)
+			glnvg__renderStrokeBuffer(uptr, paint, scissor, xform, fringe, strokeWidth, buffer, verts, paths, npaths,
+									  instances + i, 1);
+		return;
+	}
+
+	call = glnvg__allocCall(gl);
+	if (call == NULL) return;
+
+	call->type = GLNVG_STROKE;
+	call->buffer = buffer;
+	call->instanceOffset = instances;
+	call->instanceCount = ninstances;
+	call->pathOffset = glnvg__allocPaths(gl, npaths);
+	if (call->pathOffset == -1) goto error;
+	call->pathCount = npaths;
+	call->image = paint->image;
+
+	memcpy(call->xform, xform, sizeof(float) * 6);
+
+	for (i = 0; i < npaths; i++) {
+		GLNVGpath* copy = &gl->paths[call->pathOffset + i];
+		const NVGpath* path = &paths[i];
+		memset(copy, 0, sizeof(GLNVGpath));
+		if (path->nstroke) {
+			copy->strokeOffset = (int)(path->stroke - verts);
+			copy->strokeCount = path->nstroke;
+		}
+	}
+
+	if (glnvg__strokeUniforms(gl, call, paint, scissor, xform, fringe, strokeWidth) == -1) goto error;
+	if (ninstances > 0)
+		glnvg__instanceColors(gl, call, paint, (gl->flags & NVG_STENCIL_STROKES) ? 2 : 1);
+
+	return;
+
+error:
+	if (gl->ncalls > 0) gl->ncalls--;
+}
+
+static void glnvg__renderTrianglesBuffer(void* uptr, NVGpaint* paint, NVGscissor* scissor, const float* xform,
+										 int buffer, int offset, int nverts, int instances, int ninstances)
+{
+	GLNVGcontext* gl = (GLNVGcontext*)uptr;
+	GLNVGcall* call = glnvg__allocCall(gl);
+
+	if (call == NULL) return;
+
+	call->type = GLNVG_TRIANGLES;
+	call->buffer = buffer;
+	call->instanceOffset = instances;
+	call->instanceCount = ninstances;
+	call->image = paint->image;
+
+	memcpy(call->xform, xform, sizeof(float) * 6);
+
+	call->triangleOffset = offset;
+	call->triangleCount = nverts;
+
+	if (glnvg__trianglesUniforms(gl, call, paint, scissor, xform) == -1) goto error;
+	if (ninstances > 0)
+		glnvg__instanceColors(gl, call, paint, 1);
+
+	return;
+
+error:
+	if (gl->ncalls > 0) gl->ncalls--;
+}
+
 static void glnvg__renderDelete(void* uptr)
 {
 	GLNVGcontext* gl = (GLNVGcontext*)uptr;
@@ -1511,17 +2746,37 @@ static void glnvg__renderDelete(void* uptr)
 	if (gl == NULL) return;
 
 	glnvg__deleteShader(&gl->shader);
+#if NANOVG_GL_USE_INSTANCES
+	glnvg__deleteShader(&gl->instanceShader);
+	if (gl->instanceBuf != 0)
+		glDeleteBuffers(1, &gl->instanceBuf);
+#endif
 
 #if NANOVG_GL3
+	glnvg__deleteStreamFences(gl);
 #if NANOVG_GL_USE_UNIFORMBUFFER
 	if (gl->fragBuf != 0)
 		glDeleteBuffers(1, &gl->fragBuf);
 #endif
 	if (gl->vertArr != 0)
 		glDeleteVertexArrays(1, &gl->vertArr);
+	if (gl->spriteArr != 0)
+		glDeleteVertexArrays(1, &gl->spriteArr);
 #endif
 	if (gl->vertBuf != 0)
 		glDeleteBuffers(1, &gl->vertBuf);
+	if (gl->spriteBuf != 0)
+		glDeleteBuffers(1, &gl->spriteBuf);
+#if defined NANOVG_GL3
+	if (gl->pixelBuf != 0)
+		glDeleteBuffers(1, &gl->pixelBuf);
+#endif
+
+	glnvg__deleteBuffers(gl);
+	free(gl->deletedBuffers);
+#if defined NANOVG_GL3
+	free(gl->vertexArrays);
+#endif
 
 	for (i = 0; i < gl->ntextures; i++) {
 		if (gl->textures[i].tex != 0 && (gl->textures[i].flags & NVG_IMAGE_NODELETE) == 0)
@@ -1531,8 +2786,13 @@ static void glnvg__renderDelete(void* uptr)
 
 	free(gl->paths);
 	free(gl->verts);
+	free(gl->sprites);
 	free(gl->uniforms);
+	free(gl->instances);
 	free(gl->calls);
+	free(gl->order);
+	free(gl->drawFirsts);
+	free(gl->drawCounts);
 
 	free(gl);
 }
@@ -1567,6 +2827,15 @@ NVGcontext* nvgCreateGLES3(int flags)
 	params.renderStroke = glnvg__renderStroke;
 	params.renderTriangles = glnvg__renderTriangles;
 	params.renderDelete = glnvg__renderDelete;
+	params.renderCreateBuffer = glnvg__renderCreateBuffer;
+	params.renderDeleteBuffer = glnvg__renderDeleteBuffer;
+	params.renderFillBuffer = glnvg__renderFillBuffer;
+	params.renderStrokeBuffer = glnvg__renderStrokeBuffer;
+	params.renderTrianglesBuffer = glnvg__renderTrianglesBuffer;
+	params.renderSprites = glnvg__renderSprites;
+#if NANOVG_GL_USE_INSTANCES
+	params.renderInstances = glnvg__renderInstances;
+#endif
 	params.userPtr = gl;
 	params.edgeAntiAlias = flags & NVG_ANTIALIAS ? 1 : 0;
 
@@ -1620,4 +2889,21 @@ GLuint nvglImageHandle(NVGcontext* ctx, int image)
 	return tex->tex;
 }
 
+NVGglStats nvglFrameStats(NVGcontext* ctx)
+{
+	GLNVGcontext* gl = (GLNVGcontext*)nvgInternalParams(ctx)->userPtr;
+	return gl->lastFrame;
+}
+
+#if defined NANOVG_GL3
+void nvglSetStreamingBuffers(NVGcontext* ctx, int enabled)
+{
+	GLNVGcontext* gl = (GLNVGcontext*)nvgInternalParams(ctx)->userPtr;
+	if (enabled)
+		gl->flags |= NVG_STREAMING_BUFFERS;
+	else
+		gl->flags &= ~NVG_STREAMING_BUFFERS;
+}
+#endif
+
 #endif /* NANOVG_GL_IMPLEMENTATION */
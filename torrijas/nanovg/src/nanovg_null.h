@@ -0,0 +1,333 @@
+//
+// Copyright (c) 2009-2013 Mikko Mononen memon@inside.org
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+//
+#ifndef NANOVG_NULL_H
+#define NANOVG_NULL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Headless render back-end: it keeps track of textures and counts the geometry
+// submitted by NanoVG, but it doesn't issue any graphics API call.
+// Flags are the create flags declared in nanovg_gl.h, which must be included first.
+
+struct NVGnullStats {
+	int fills;
+	int strokes;
+	int triangles;
+	int paths;
+	int vertices;
+};
+typedef struct NVGnullStats NVGnullStats;
+
+NVGcontext* nvgCreateNull(int flags);
+void nvgDeleteNull(NVGcontext* ctx);
+
+// Returns the stats of the last flushed frame.
+NVGnullStats nvgNullFrameStats(NVGcontext* ctx);
+
+// Returns the stats accumulated since the context was created.
+NVGnullStats nvgNullTotalStats(NVGcontext* ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NANOVG_NULL_H */
+
+#ifdef NANOVG_NULL_IMPLEMENTATION
+
+#include <stdlib.h>
+#include <string.h>
+#include "nanovg.h"
+
+struct NULLNVGtexture {
+	int id;
+	int type;
+	int width, height;
+	int flags;
+};
+typedef struct NULLNVGtexture NULLNVGtexture;
+
+struct NULLNVGcontext {
+	NULLNVGtexture* textures;
+	int ntextures;
+	int ctextures;
+	int textureId;
+	int flags;
+	NVGnullStats frame;
+	NVGnullStats lastFrame;
+	NVGnullStats total;
+};
+typedef struct NULLNVGcontext NULLNVGcontext;
+
+static int nullnvg__maxi(int a, int b) { return a > b ? a : b; }
+
+static NULLNVGtexture* nullnvg__allocTexture(NULLNVGcontext* nl)
+{
+	NULLNVGtexture* tex = NULL;
+	int i;
+
+	for (i = 0; i < nl->ntextures; i++) {
+		if (nl->textures[i].id == 0) {
+			tex = &nl->textures[i];
+			break;
+		}
+	}
+	if (tex == NULL) {
+		if (nl->ntextures+1 > nl->ctextures) {
+			NULLNVGtexture* textures;
+			int ctextures = nullnvg__maxi(nl->ntextures+1, 4) +  nl->ctextures/2; // 1.5x Overallocate
+			textures = (NULLNVGtexture*)realloc(nl->textures, sizeof(NULLNVGtexture)*ctextures);
+			if (textures == NULL) return NULL;
+			nl->textures = textures;
+			nl->ctextures = ctextures;
+		}
+		tex = &nl->textures[nl->ntextures++];
+	}
+
+	memset(tex, 0, sizeof(*tex));
+	tex->id = ++nl->textureId;
+
+	return tex;
+}
+
+static NULLNVGtexture* nullnvg__findTexture(NULLNVGcontext* nl, int id)
+{
+	int i;
+	for (i = 0; i < nl->ntextures; i++)
+		if (nl->textures[i].id == id)
+			return &nl->textures[i];
+	return NULL;
+}
+
+static void nullnvg__addStats(NVGnullStats* stats, int fills, int strokes, int triangles, int paths, int vertices)
+{
+	stats->fills += fills;
+	stats->strokes += strokes;
+	stats->triangles += triangles;
+	stats->paths += paths;
+	stats->vertices += vertices;
+}
+
+static void nullnvg__count(NULLNVGcontext* nl, int fills, int strokes, int triangles, int paths, int vertices)
+{
+	nullnvg__addStats(&nl->frame, fills, strokes, triangles, paths, vertices);
+	nullnvg__addStats(&nl->total, fills, strokes, triangles, paths, vertices);
+}
+
+static int nullnvg__renderCreate(void* uptr)
+{
+	NVG_NOTUSED(uptr);
+	return 1;
+}
+
+static int nullnvg__renderCreateTexture(void* uptr, int type, int w, int h, int imageFlags, const unsigned char* data)
+{
+	NULLNVGcontext* nl = (NULLNVGcontext*)uptr;
+	NULLNVGtexture* tex = nullnvg__allocTexture(nl);
+	NVG_NOTUSED(data);
+
+	if (tex == NULL) return 0;
+
+	tex->type = type;
+	tex->width = w;
+	tex->height = h;
+	tex->flags = imageFlags;
+
+	return tex->id;
+}
+
+static int nullnvg__renderDeleteTexture(void* uptr, int image)
+{
+	NULLNVGcontext* nl = (NULLNVGcontext*)uptr;
+	NULLNVGtexture* tex = nullnvg__findTexture(nl, image);
+	if (tex == NULL) return 0;
+	memset(tex, 0, sizeof(*tex));
+	return 1;
+}
+
+static int nullnvg__renderUpdateTexture(void* uptr, int image, int x, int y, int w, int h, const unsigned char* data)
+{
+	NULLNVGcontext* nl = (NULLNVGcontext*)uptr;
+	NULLNVGtexture* tex = nullnvg__findTexture(nl, image);
+	NVG_NOTUSED(x);
+	NVG_NOTUSED(y);
+	NVG_NOTUSED(w);
+	NVG_NOTUSED(h);
+	NVG_NOTUSED(data);
+	return tex != NULL;
+}
+
+static int nullnvg__renderGetTextureSize(void* uptr, int image, int* w, int* h)
+{
+	NULLNVGcontext* nl = (NULLNVGcontext*)uptr;
+	NULLNVGtexture* tex = nullnvg__findTexture(nl, image);
+	if (tex == NULL) return 0;
+	*w = tex->width;
+	*h = tex->height;
+	return 1;
+}
+
+static void nullnvg__renderViewport(void* uptr, int width, int height)
+{
+	NULLNVGcontext* nl = (NULLNVGcontext*)uptr;
+	NVG_NOTUSED(width);
+	NVG_NOTUSED(height);
+	memset(&nl->frame, 0, sizeof(nl->frame));
+}
+
+static void nullnvg__renderCancel(void* uptr)
+{
+	NULLNVGcontext* nl = (NULLNVGcontext*)uptr;
+	memset(&nl->frame, 0, sizeof(nl->frame));
+}
+
+static void nullnvg__renderFlush(void* uptr)
+{
+	NULLNVGcontext* nl = (NULLNVGcontext*)uptr;
+	nl->lastFrame = nl->frame;
+	memset(&nl->frame, 0, sizeof(nl->frame));
+}
+
+static void nullnvg__renderFill(void* uptr, NVGpaint* paint, NVGscissor* scissor, const float* xform, float fringe,
+								const float* bounds, const NVGpath* paths, int npaths)
+{
+	NULLNVGcontext* nl = (NULLNVGcontext*)uptr;
+	int i, nverts = 0;
+	NVG_NOTUSED(paint);
+	NVG_NOTUSED(scissor);
+	NVG_NOTUSED(xform);
+	NVG_NOTUSED(fringe);
+	NVG_NOTUSED(bounds);
+
+	for (i = 0; i < npaths; i++)
+		nverts += paths[i].nfill + paths[i].nstroke;
+
+	// Bounding quad used to cover the stencil of non convex fills.
+	if (npaths != 1 || !paths[0].convex)
+		nverts += 6;
+
+	nullnvg__count(nl, 1, 0, 0, npaths, nverts);
+}
+
+static void nullnvg__renderStroke(void* uptr, NVGpaint* paint, NVGscissor* scissor, const float* xform, float fringe,
+								  float strokeWidth, const NVGpath* paths, int npaths)
+{
+	NULLNVGcontext* nl = (NULLNVGcontext*)uptr;
+	int i, nverts = 0;
+	NVG_NOTUSED(paint);
+	NVG_NOTUSED(scissor);
+	NVG_NOTUSED(xform);
+	NVG_NOTUSED(fringe);
+	NVG_NOTUSED(strokeWidth);
+
+	for (i = 0; i < npaths; i++)
+		nverts += paths[i].nstroke;
+
+	nullnvg__count(nl, 0, 1, 0, npaths, nverts);
+}
+
+static void nullnvg__renderTriangles(void* uptr, NVGpaint* paint, NVGscissor* scissor, const float* xform,
+									 const NVGvertex* verts, int nverts)
+{
+	NULLNVGcontext* nl = (NULLNVGcontext*)uptr;
+	NVG_NOTUSED(paint);
+	NVG_NOTUSED(scissor);
+	NVG_NOTUSED(xform);
+	NVG_NOTUSED(verts);
+
+	nullnvg__count(nl, 0, 0, 1, 0, nverts);
+}
+
+static void nullnvg__renderSprites(void* uptr, NVGscissor* scissor, int image, const NVGspriteVertex* verts,
+								   int nverts)
+{
+	NULLNVGcontext* nl = (NULLNVGcontext*)uptr;
+	NVG_NOTUSED(scissor);
+	NVG_NOTUSED(image);
+	NVG_NOTUSED(verts);
+
+	nullnvg__count(nl, 0, 0, 1, 0, nverts);
+}
+
+static void nullnvg__renderDelete(void* uptr)
+{
+	NULLNVGcontext* nl = (NULLNVGcontext*)uptr;
+	if (nl == NULL) return;
+
+	free(nl->textures);
+	free(nl);
+}
+
+NVGcontext* nvgCreateNull(int flags)
+{
+	NVGparams params;
+	NVGcontext* ctx = NULL;
+	NULLNVGcontext* nl = (NULLNVGcontext*)malloc(sizeof(NULLNVGcontext));
+	if (nl == NULL) goto error;
+	memset(nl, 0, sizeof(NULLNVGcontext));
+
+	memset(&params, 0, sizeof(params));
+	params.renderCreate = nullnvg__renderCreate;
+	params.renderCreateTexture = nullnvg__renderCreateTexture;
+	params.renderDeleteTexture = nullnvg__renderDeleteTexture;
+	params.renderUpdateTexture = nullnvg__renderUpdateTexture;
+	params.renderGetTextureSize = nullnvg__renderGetTextureSize;
+	params.renderViewport = nullnvg__renderViewport;
+	params.renderCancel = nullnvg__renderCancel;
+	params.renderFlush = nullnvg__renderFlush;
+	params.renderFill = nullnvg__renderFill;
+	params.renderStroke = nullnvg__renderStroke;
+	params.renderTriangles = nullnvg__renderTriangles;
+	params.renderSprites = nullnvg__renderSprites;
+	params.renderDelete = nullnvg__renderDelete;
+	params.userPtr = nl;
+	params.edgeAntiAlias = flags & NVG_ANTIALIAS ? 1 : 0;
+
+	nl->flags = flags;
+
+	ctx = nvgCreateInternal(&params);
+	if (ctx == NULL) goto error;
+
+	return ctx;
+
+error:
+	// 'nl' is freed by nvgDeleteInternal.
+	if (ctx != NULL) nvgDeleteInternal(ctx);
+	return NULL;
+}
+
+void nvgDeleteNull(NVGcontext* ctx)
+{
+	nvgDeleteInternal(ctx);
+}
+
+NVGnullStats nvgNullFrameStats(NVGcontext* ctx)
+{
+	NULLNVGcontext* nl = (NULLNVGcontext*)nvgInternalParams(ctx)->userPtr;
+	return nl->lastFrame;
+}
+
+NVGnullStats nvgNullTotalStats(NVGcontext* ctx)
+{
+	NULLNVGcontext* nl = (NULLNVGcontext*)nvgInternalParams(ctx)->userPtr;
+	return nl->total;
+}
+
+#endif /* NANOVG_NULL_IMPLEMENTATION */
@@ -0,0 +1,177 @@
+//
+// Copyright (c) 2015 Gustavo Valiente gustavovalient@gmail.com
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+//
+
+#include "private/trjatlaspacker.h"
+
+#include <algorithm>
+#include <climits>
+#include "trjdebug.h"
+
+namespace trj
+{
+
+namespace priv
+{
+
+AtlasPacker::AtlasPacker(int width, int height) :
+    mWidth(width),
+    mHeight(height)
+{
+    TRJ_ASSERT(width > 0, "Invalid width");
+    TRJ_ASSERT(height > 0, "Invalid height");
+
+    clear();
+}
+
+int AtlasPacker::getCoveredArea() const noexcept
+{
+    int coveredArea = 0;
+    for(const Segment& segment : mSegments)
+    {
+        coveredArea += segment.width * segment.y;
+    }
+
+    return coveredArea;
+}
+
+bool AtlasPacker::insert(int width, int height, int& x, int& y)
+{
+    TRJ_ASSERT(width > 0, "Invalid width");
+    TRJ_ASSERT(height > 0, "Invalid height");
+
+    int bestIndex = -1;
+    int bestTop = INT_MAX;
+    int bestWidth = INT_MAX;
+    int bestY = 0;
+    int numSegments = mSegments.size();
+
+    for(int index = 0; index < numSegments; ++index)
+    {
+        int fitY;
+        if(fit(index, width, height, fitY))
+        {
+            // Ties are placed on the narrowest segment, so wide gaps are kept for wide rects:
+            int top = fitY + height;
+            int segmentWidth = mSegments[index].width;
+            if(top < bestTop || (top == bestTop && segmentWidth < bestWidth))
+            {
+                bestIndex = index;
+                bestTop = top;
+                bestWidth = segmentWidth;
+                bestY = fitY;
+            }
+        }
+    }
+
+    if(bestIndex < 0)
+    {
+        return false;
+    }
+
+    x = mSegments[bestIndex].x;
+    y = bestY;
+    addSegment(bestIndex, x, y + height, width);
+    mUsedArea += width * height;
+    return true;
+}
+
+void AtlasPacker::clear()
+{
+    mSegments.clear();
+    mSegments.push_back(Segment{0, 0, mWidth});
+    mUsedArea = 0;
+}
+
+bool AtlasPacker::fit(int index, int width, int height, int& y) const
+{
+    int x = mSegments[index].x;
+    if(x + width > mWidth)
+    {
+        return false;
+    }
+
+    // The rect lies on the highest segment below it:
+    int remainingWidth = width;
+    y = 0;
+
+    while(remainingWidth > 0)
+    {
+        const Segment& segment = mSegments[index];
+        y = std::max(y, segment.y);
+
+        if(y + height > mHeight)
+        {
+            return false;
+        }
+
+        remainingWidth -= segment.width;
+        ++index;
+    }
+
+    return true;
+}
+
+void AtlasPacker::addSegment(int index, int x, int y, int width)
+{
+    mSegments.insert(mSegments.begin() + index, Segment{x, y, width});
+
+    // The segments below the new one are shrunk or removed:
+    for(int nextIndex = index + 1; nextIndex < int(mSegments.size()); )
+    {
+        Segment& segment = mSegments[nextIndex];
+        const Segment& previousSegment = mSegments[nextIndex - 1];
+        int previousEnd = previousSegment.x + previousSegment.width;
+
+        if(segment.x >= previousEnd)
+        {
+            break;
+        }
+
+        int shrink = previousEnd - segment.x;
+        segment.x += shrink;
+        segment.width -= shrink;
+
+        if(segment.width > 0)
+        {
+            break;
+        }
+
+        mSegments.erase(mSegments.begin() + nextIndex);
+    }
+
+    // Neighbour segments at the same height are merged:
+    for(int mergeIndex = 0; mergeIndex + 1 < int(mSegments.size()); )
+    {
+        Segment& segment = mSegments[mergeIndex];
+        const Segment& nextSegment = mSegments[mergeIndex + 1];
+
+        if(segment.y == nextSegment.y)
+        {
+            segment.width += nextSegment.width;
+            mSegments.erase(mSegments.begin() + mergeIndex + 1);
+        }
+        else
+        {
+            ++mergeIndex;
+        }
+    }
+}
+
+}
+
+}
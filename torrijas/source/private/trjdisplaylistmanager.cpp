@@ -18,8 +18,20 @@
 
 #include "private/trjdisplaylistmanager.h"
 
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
 #include "nanovg.h"
+#include "trjfile.h"
+#include "trjfolder.h"
 #include "trjdebug.h"
+#include "private/trjhash.h"
+#include "private/trjimagemanager.h"
+#include "private/trjmappedfile.h"
 
 namespace trj
 {
@@ -29,46 +41,390 @@ namespace priv
 
 DisplayListManager* DisplayListManager::smInstance = nullptr;
 
+namespace
+{
+    int getSizeClass(std::size_t numBytes, int numSizeClasses) noexcept
+    {
+        int sizeClass = 0;
+        while(numBytes > 1 && sizeClass < numSizeClasses - 1)
+        {
+            numBytes >>= 1;
+            ++sizeClass;
+        }
+
+        return sizeClass;
+    }
+}
+
+DisplayListManager::DisplayListManager(std::size_t budget, int evictionFrames, const String& folderPath) :
+    mBudget(budget),
+    mEvictionFrames(evictionFrames)
+{
+    // Render caches aren't written if the folder can't be created:
+    if(! folderPath.isEmpty() && ! File::isFilePath(folderPath))
+    {
+        Folder folder(folderPath);
+        if(folder.exists() || folder.create())
+        {
+            mFolderPath = folder.getPath();
+        }
+    }
+
+    smInstance = this;
+}
+
 DisplayListManager::~DisplayListManager()
 {
-    #ifdef TRJ_CFG_ENABLE_RENDER_CACHE
-        for(NVGdisplayList* displayList : mDisplayLists)
+    for(RenderCache* renderCache : mRenderCaches)
+    {
+        if(renderCache->displayList)
+        {
+            nvgDeleteDisplayList(renderCache->displayList);
+        }
+
+        delete renderCache;
+    }
+
+    for(auto& displayListPool : mDisplayListPools)
+    {
+        for(NVGdisplayList* displayList : displayListPool)
         {
             nvgDeleteDisplayList(displayList);
         }
-    #endif
+    }
 
     smInstance = nullptr;
 }
 
 #ifdef TRJ_CFG_ENABLE_RENDER_CACHE
 
-NVGdisplayList& DisplayListManager::pull()
+RenderCache& DisplayListManager::pull()
 {
-    auto& displayLists = smInstance->mDisplayLists;
-    NVGdisplayList* displayList;
-    if(displayLists.empty())
+    auto& freeRenderCaches = smInstance->mFreeRenderCaches;
+    RenderCache* renderCache;
+    if(freeRenderCaches.empty())
     {
-        displayList = nvgCreateDisplayList(-1);
-        TRJ_ASSERT(displayList, "Display list build failed");
+        renderCache = new RenderCache();
+        smInstance->mRenderCaches.push_back(renderCache);
     }
     else
     {
-        displayList = displayLists.back();
-        displayLists.pop_back();
+        renderCache = freeRenderCaches.back();
+        freeRenderCaches.pop_back();
+        renderCache->numReferences = 1;
     }
 
-    return *displayList;
+    // Render caches pulled and not drawn yet aren't evicted right away:
+    renderCache->lastFrame = smInstance->mFrame;
+    reset(*renderCache);
+    return *renderCache;
 }
 
-void DisplayListManager::push(NVGdisplayList& displayList)
+void DisplayListManager::push(RenderCache& renderCache)
 {
-    nvgResetDisplayList(&displayList);
-    smInstance->mDisplayLists.push_back(&displayList);
+    TRJ_ASSERT(renderCache.numReferences > 0, "Render cache already released");
+
+    // Render caches shared by several nodes are released by the last one:
+    if(--renderCache.numReferences == 0)
+    {
+        smInstance->release(renderCache);
+        renderCache.numRecordedBytes = 0;
+        smInstance->mFreeRenderCaches.push_back(&renderCache);
+    }
+}
+
+void DisplayListManager::reset(RenderCache& renderCache)
+{
+    if(renderCache.displayList)
+    {
+        nvgResetDisplayList(renderCache.displayList);
+        return;
+    }
+
+    // The smallest pooled display list with at least the size of the last record is pulled.
+    // If there's none, the biggest smaller one is pulled and grows while it is recorded:
+    auto& displayListPools = smInstance->mDisplayListPools;
+    int sizeClass = getSizeClass(renderCache.numRecordedBytes, smNumSizeClasses);
+    NVGdisplayList* displayList = nullptr;
+    for(int index = sizeClass; index < smNumSizeClasses && ! displayList; ++index)
+    {
+        if(! displayListPools[index].empty())
+        {
+            displayList = displayListPools[index].back();
+            displayListPools[index].pop_back();
+        }
+    }
+
+    for(int index = sizeClass - 1; index >= 0 && ! displayList; --index)
+    {
+        if(! displayListPools[index].empty())
+        {
+            displayList = displayListPools[index].back();
+            displayListPools[index].pop_back();
+        }
+    }
+
+    std::size_t numBytes;
+    if(displayList)
+    {
+        numBytes = std::size_t(nvgDisplayListMemory(displayList));
+        smInstance->mNumPooledBytes -= numBytes;
+    }
+    else
+    {
+        displayList = nvgCreateDisplayList(smInitialNumCommands);
+        TRJ_ASSERT(displayList, "Display list build failed");
+        numBytes = std::size_t(nvgDisplayListMemory(displayList));
+    }
+
+    renderCache.displayList = displayList;
+    renderCache.numBytes = numBytes;
+    smInstance->mNumBytes += numBytes;
+}
+
+void DisplayListManager::recorded(NVGcontext& nanoVgContext, RenderCache& renderCache)
+{
+    std::size_t numBytes = std::size_t(nvgDisplayListMemory(renderCache.displayList));
+    smInstance->mNumBytes += numBytes - renderCache.numBytes;
+    renderCache.numBytes = numBytes;
+    renderCache.numRecordedBytes = numBytes;
+    ++smInstance->mNumRecords;
+
+    if(renderCache.key && ! smInstance->mFolderPath.isEmpty())
+    {
+        smInstance->save(nanoVgContext, renderCache);
+    }
+}
+
+bool DisplayListManager::load(NVGcontext& nanoVgContext, RenderCache& renderCache)
+{
+    if(! renderCache.key || smInstance->mFolderPath.isEmpty())
+    {
+        return false;
+    }
+
+    MappedFile mappedFile(smInstance->getFilePath(renderCache));
+    if(mappedFile.isEmpty() || mappedFile.getSize() > INT_MAX ||
+            ! nvgReadDisplayList(&nanoVgContext, renderCache.displayList, mappedFile.getData(),
+                    static_cast<int>(mappedFile.getSize())))
+    {
+        return false;
+    }
+
+    std::size_t numBytes = std::size_t(nvgDisplayListMemory(renderCache.displayList));
+    smInstance->mNumBytes += numBytes - renderCache.numBytes;
+    renderCache.numBytes = numBytes;
+    renderCache.numRecordedBytes = numBytes;
+    renderCache.atlasPageGenerations.clear();
+    ++smInstance->mNumLoads;
+    return true;
+}
+
+String DisplayListManager::getFilePath(const RenderCache& renderCache) const
+{
+    // The key check is in the file name too, so files of colliding keys aren't read:
+    std::ostringstream stream;
+    stream << mFolderPath.getCharArray() << std::hex << std::setfill('0') << std::setw(16) << renderCache.key <<
+            std::setw(16) << renderCache.keyCheck << ".trjdl";
+    return stream.str();
+}
+
+void DisplayListManager::save(NVGcontext& nanoVgContext, const RenderCache& renderCache) const
+{
+    int size = nvgWriteDisplayList(&nanoVgContext, renderCache.displayList, nullptr);
+    if(! size)
+    {
+        return;
+    }
+
+    std::vector<unsigned char> data(static_cast<std::size_t>(size));
+    nvgWriteDisplayList(&nanoVgContext, renderCache.displayList, data.data());
+
+    // The file is written with another name first, so a partially written file is never read:
+    String filePath = getFilePath(renderCache);
+    String temporaryFilePath = filePath + ".tmp";
+    {
+        std::ofstream fileStream(temporaryFilePath.getCharArray(), std::ios::binary | std::ios::trunc);
+        fileStream.write(reinterpret_cast<const char*>(data.data()), size);
+        if(! fileStream.good())
+        {
+            fileStream.close();
+            File(temporaryFilePath).remove();
+            return;
+        }
+    }
+
+    File(filePath).remove();
+    std::rename(temporaryFilePath.getCharArray(), filePath.getCharArray());
+}
+
+Hash DisplayListManager::getKey(const Hash& contentHash, float scaleX, float scaleY) noexcept
+{
+    // Degenerate scales have no logarithm, so their render caches aren't shared:
+    if(scaleX == 0 || scaleY == 0 || ! std::isfinite(scaleX) || ! std::isfinite(scaleY))
+    {
+        return Hash();
+    }
+
+    // Scales are quantized in 1/256 octave steps, so float noise doesn't prevent sharing:
+    Hash key = contentHash;
+    hashCombine(key, static_cast<long>(std::lround(std::log2(std::abs(scaleX)) * 256)));
+    hashCombine(key, static_cast<long>(std::lround(std::log2(std::abs(scaleY)) * 256)));
+
+    // Zero is reserved for render caches without key:
+    if(! key.value)
+    {
+        key.value = 1;
+    }
+
+    return key;
+}
+
+RenderCache* DisplayListManager::find(const Hash& key)
+{
+    auto& sharedRenderCaches = smInstance->mSharedRenderCaches;
+    auto iterator = sharedRenderCaches.find(key.value);
+    if(iterator == sharedRenderCaches.end())
+    {
+        return nullptr;
+    }
+
+    // A key collision is recorded in a render cache of its own:
+    RenderCache* renderCache = iterator->second;
+    if(renderCache->keyCheck != key.check)
+    {
+        return nullptr;
+    }
+
+    share(*renderCache);
+    return renderCache;
+}
+
+void DisplayListManager::insert(RenderCache& renderCache, const Hash& key)
+{
+    TRJ_ASSERT(key.value, "Invalid key");
+    TRJ_ASSERT(! renderCache.key, "Render cache already inserted");
+
+    auto result = smInstance->mSharedRenderCaches.emplace(key.value, &renderCache);
+    if(result.second)
+    {
+        renderCache.key = key.value;
+        renderCache.keyCheck = key.check;
+    }
+}
+
+bool DisplayListManager::isOutdated(NVGcontext& nanoVgContext, RenderCache& renderCache)
+{
+    // Render caches recorded before their atlas pages were repacked could draw images from their old rects:
+    if(! nvgIsDisplayListOutdated(&nanoVgContext, renderCache.displayList) &&
+            ! ImageManager::isAtlasOutdated(renderCache.atlasPageGenerations))
+    {
+        return false;
+    }
+
+    if(renderCache.key)
+    {
+        smInstance->mSharedRenderCaches.erase(renderCache.key);
+        renderCache.key = 0;
+    }
+
+    return true;
 }
 
 #endif
 
+void DisplayListManager::release(RenderCache& renderCache)
+{
+    if(renderCache.key)
+    {
+        mSharedRenderCaches.erase(renderCache.key);
+        renderCache.key = 0;
+    }
+
+    renderCache.recorded = false;
+
+    if(NVGdisplayList* displayList = renderCache.displayList)
+    {
+        nvgResetDisplayList(displayList);
+        mNumBytes -= renderCache.numBytes;
+        renderCache.displayList = nullptr;
+        renderCache.numBytes = 0;
+
+        std::size_t numBytes = std::size_t(nvgDisplayListMemory(displayList));
+        mDisplayListPools[getSizeClass(numBytes, smNumSizeClasses)].push_back(displayList);
+        mNumPooledBytes += numBytes;
+    }
+}
+
+void DisplayListManager::update()
+{
+    if(mNumBytes + mNumPooledBytes > mBudget)
+    {
+        trimPools();
+
+        if(mNumBytes > mBudget)
+        {
+            evictIdleRenderCaches();
+            trimPools();
+        }
+    }
+
+    mStats = RenderCacheStats(mNumBytes, mNumPooledBytes, int(mRenderCaches.size() - mFreeRenderCaches.size()),
+            mNumDraws, mNumRecords, mNumEvictions, mNumLoads);
+    mNumDraws = 0;
+    mNumRecords = 0;
+    mNumEvictions = 0;
+    mNumLoads = 0;
+    ++mFrame;
+}
+
+void DisplayListManager::trimPools()
+{
+    // The biggest display lists are deleted first:
+    for(int index = smNumSizeClasses - 1; index >= 0 && mNumBytes + mNumPooledBytes > mBudget; --index)
+    {
+        auto& displayListPool = mDisplayListPools[index];
+        while(! displayListPool.empty() && mNumBytes + mNumPooledBytes > mBudget)
+        {
+            NVGdisplayList* displayList = displayListPool.back();
+            displayListPool.pop_back();
+            mNumPooledBytes -= std::size_t(nvgDisplayListMemory(displayList));
+            nvgDeleteDisplayList(displayList);
+        }
+    }
+}
+
+void DisplayListManager::evictIdleRenderCaches()
+{
+    // Render caches not drawn for the last frames are evicted, the least recently drawn first.
+    // Their nodes keep them, so they are recorded again when the nodes are drawn:
+    std::vector<RenderCache*> idleRenderCaches;
+    long lastIdleFrame = mFrame - mEvictionFrames;
+    for(RenderCache* renderCache : mRenderCaches)
+    {
+        if(renderCache->numReferences > 0 && renderCache->displayList && renderCache->lastFrame < lastIdleFrame)
+        {
+            idleRenderCaches.push_back(renderCache);
+        }
+    }
+
+    std::sort(idleRenderCaches.begin(), idleRenderCaches.end(), [](const RenderCache* a, const RenderCache* b)
+    {
+        return a->lastFrame < b->lastFrame;
+    });
+
+    for(RenderCache* renderCache : idleRenderCaches)
+    {
+        if(mNumBytes <= mBudget)
+        {
+            break;
+        }
+
+        release(*renderCache);
+        ++mNumEvictions;
+    }
+}
+
 }
 
 }
@@ -18,12 +18,18 @@
 
 #include "private/trjimagemanager.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iterator>
 #include "nanovg.h"
 #include "stb_image.h"
 #include "trjapplication.h"
 #include "trjimagedata.h"
+#include "trjrect.h"
 #include "trjexception.h"
 #include "trjdebug.h"
+#include "private/trjqoi.h"
 
 namespace trj
 {
@@ -31,6 +37,11 @@ namespace trj
 namespace priv
 {
 
+namespace
+{
+    thread_local std::vector<unsigned int>* tAtlasPageGenerations = nullptr;
+}
+
 ImageManager* ImageManager::smInstance = nullptr;
 
 ImageManager::ImageManager()
@@ -43,6 +54,8 @@ ImageManager::ImageManager()
 
 ImageManager::~ImageManager()
 {
+    stopThreads();
+
     TRJ_ASSERT(mEntries.empty(), "ImageManager still contains images");
 
     smInstance = nullptr;
@@ -59,6 +72,16 @@ int ImageManager::addImage(const unsigned char* data, int width, int height, int
     TRJ_ASSERT(width > 0, "Invalid width");
     TRJ_ASSERT(height > 0, "Invalid height");
 
+    // Flipped images can't be packed, since the whole page would be flipped. Repeat flags are kept in case
+    // the image is moved out of the atlas later:
+    ImageManager& manager = *smInstance;
+    int ownTextureFlags = NVG_IMAGE_GENERATE_MIPMAPS | NVG_IMAGE_FLIPY;
+    if(manager.mAtlasEnabled && ! (flags & ownTextureFlags) && width <= smMaxAtlasImageSize &&
+            height <= smMaxAtlasImageSize)
+    {
+        return manager.addAtlasImage(data, width, height, flags);
+    }
+
     NVGcontext& nanoVgContext = Application::getNanoVgContext();
     int image = nvgCreateImageRGBA(&nanoVgContext, width, height, flags, data);
     if(! image)
@@ -66,7 +89,7 @@ int ImageManager::addImage(const unsigned char* data, int width, int height, int
         throw Exception(__FILE__, __LINE__, "Image load failed");
     }
 
-    smInstance->mEntries.insert(std::make_pair(image, Entry{nullptr, 1}));
+    manager.mEntries.insert(std::make_pair(image, Entry{nullptr, image, flags, 1, true, false, nullptr, 0, 0, 0, 0}));
     return image;
 }
 
@@ -78,10 +101,484 @@ int ImageManager::addImage(Node& node, int width, int height, const Color& backg
     int image;
     void* frameBuffer = Application::getFrameBuffer(node, backgroundColor, flags, width, height, image);
 
-    smInstance->mEntries.insert(std::make_pair(image, Entry{frameBuffer, 1}));
+    smInstance->mEntries.insert(std::make_pair(image, Entry{frameBuffer, image, flags, 1, true, false, nullptr, 0, 0, 0, 0}));
+    return image;
+}
+
+int ImageManager::addImageAsync(const String& filePath, int flags)
+{
+    // Only the header is read here, so the texture can be built with the image size:
+    int width, height, numComponents;
+    if(! qoi::getFileSize(filePath, width, height) &&
+            ! stbi_info(filePath.getCharArray(), &width, &height, &numComponents))
+    {
+        throw Exception(__FILE__, __LINE__, "Image file load failed");
+    }
+
+    NVGcontext& nanoVgContext = Application::getNanoVgContext();
+    int image = nvgCreateImageRGBA(&nanoVgContext, width, height, flags, nullptr);
+    if(! image)
+    {
+        throw Exception(__FILE__, __LINE__, "Image load failed");
+    }
+
+    ImageManager& manager = *smInstance;
+    manager.mEntries.insert(std::make_pair(image, Entry{nullptr, image, flags, 1, false, false, nullptr, 0, 0, 0, 0}));
+
+    // Threads are started with the first asynchronous load:
+    if(manager.mThreads.empty())
+    {
+        for(int index = 0; index < manager.mNumThreads; ++index)
+        {
+            manager.mThreads.emplace_back(&ImageManager::runThread, &manager);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(manager.mMutex);
+        manager.mPendingLoads.push_back(Load{image, filePath, Ptr<ImageData>(), 0});
+    }
+
+    manager.mCondition.notify_one();
+    return image;
+}
+
+bool ImageManager::isImageLoaded(int image)
+{
+    auto it = smInstance->mEntries.find(image);
+
+    TRJ_ASSERT(it != smInstance->mEntries.end(), "Image doesn't exist");
+
+    return it->second.loaded;
+}
+
+bool ImageManager::isImageLoadFailed(int image)
+{
+    auto it = smInstance->mEntries.find(image);
+
+    TRJ_ASSERT(it != smInstance->mEntries.end(), "Image doesn't exist");
+
+    return it->second.loadFailed;
+}
+
+void ImageManager::getImageSize(int image, int& width, int& height)
+{
+    auto it = smInstance->mEntries.find(image);
+
+    TRJ_ASSERT(it != smInstance->mEntries.end(), "Image doesn't exist");
+
+    const Entry& entry = it->second;
+    if(entry.page)
+    {
+        width = entry.width;
+        height = entry.height;
+    }
+    else
+    {
+        NVGcontext& nanoVgContext = Application::getNanoVgContext();
+        nvgImageSize(&nanoVgContext, entry.texture, &width, &height);
+    }
+}
+
+int ImageManager::getTexture(int image, const Rect& rect, float angle, Rect& textureRect)
+{
+    auto it = smInstance->mEntries.find(image);
+
+    TRJ_ASSERT(it != smInstance->mEntries.end(), "Image doesn't exist");
+
+    const Entry& entry = it->second;
+    if(! entry.page)
+    {
+        textureRect = rect;
+        return entry.texture;
+    }
+
+    // The page generation is added only once per page to the render cache being recorded:
+    if(tAtlasPageGenerations && std::find(tAtlasPageGenerations->begin(), tAtlasPageGenerations->end(),
+            entry.page->generation) == tAtlasPageGenerations->end())
+    {
+        tAtlasPageGenerations->push_back(entry.page->generation);
+    }
+
+    // The page origin is moved back by the image position, rotated as the pattern:
+    float scaleX = rect.getWidth() / entry.width;
+    float scaleY = rect.getHeight() / entry.height;
+    float offsetX = -entry.x * scaleX;
+    float offsetY = -entry.y * scaleY;
+    float cosAngle = std::cos(angle);
+    float sinAngle = std::sin(angle);
+    textureRect = Rect(rect.getX() + (cosAngle * offsetX) - (sinAngle * offsetY),
+            rect.getY() + (sinAngle * offsetX) + (cosAngle * offsetY), smPageSize * scaleX, smPageSize * scaleY);
+    return entry.page->texture;
+}
+
+bool ImageManager::isAtlasEnabled() noexcept
+{
+    return smInstance->mAtlasEnabled;
+}
+
+void ImageManager::setAtlasEnabled(bool enabled) noexcept
+{
+    smInstance->mAtlasEnabled = enabled;
+}
+
+void ImageManager::beginRecord(std::vector<unsigned int>& atlasPageGenerations) noexcept
+{
+    atlasPageGenerations.clear();
+    tAtlasPageGenerations = &atlasPageGenerations;
+}
+
+void ImageManager::endRecord() noexcept
+{
+    tAtlasPageGenerations = nullptr;
+}
+
+bool ImageManager::isAtlasOutdated(const std::vector<unsigned int>& atlasPageGenerations) noexcept
+{
+    auto& pages = smInstance->mPages;
+    for(unsigned int generation : atlasPageGenerations)
+    {
+        auto it = std::find_if(pages.begin(), pages.end(), [generation](const Ptr<Page>& page)
+        {
+            return page->generation == generation;
+        });
+
+        if(it == pages.end())
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void ImageManager::update()
+{
+    ImageManager& manager = *smInstance;
+    auto& uploads = manager.mUploads;
+
+    // Pages are repacked once less than half of the area below their skyline is used:
+    for(Ptr<Page>& page : manager.mPages)
+    {
+        if(page->fragmented)
+        {
+            page->fragmented = false;
+
+            if(page->packer.getUsedArea() * 2 < page->packer.getCoveredArea())
+            {
+                manager.repackPage(*page);
+            }
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(manager.mMutex);
+        std::move(manager.mDecodedLoads.begin(), manager.mDecodedLoads.end(), std::back_inserter(uploads));
+        manager.mDecodedLoads.clear();
+    }
+
+    // At least one row is uploaded per frame, even if it is bigger than the budget:
+    NVGcontext& nanoVgContext = Application::getNanoVgContext();
+    std::size_t budget = manager.mUploadBudget;
+
+    while(! uploads.empty() && budget)
+    {
+        Load& load = uploads.front();
+        auto it = manager.mEntries.find(load.image);
+        if(it == manager.mEntries.end())
+        {
+            // The image was removed before being loaded:
+            uploads.pop_front();
+            continue;
+        }
+
+        // The image of a failed load is kept unloaded, so it is never drawn:
+        if(! load.imageData)
+        {
+            it->second.loadFailed = true;
+            uploads.pop_front();
+            continue;
+        }
+
+        const ImageData& imageData = *load.imageData;
+        std::size_t stride = imageData.getStride();
+        int numRows = std::min(imageData.getHeight() - load.uploadedRows,
+                std::max(1, static_cast<int>(budget / stride)));
+        nvgUpdateImageRows(&nanoVgContext, load.image, load.uploadedRows, numRows, imageData.getData());
+        load.uploadedRows += numRows;
+        budget -= std::min(budget, numRows * stride);
+
+        if(load.uploadedRows == imageData.getHeight())
+        {
+            it->second.loaded = true;
+            uploads.pop_front();
+        }
+    }
+}
+
+int ImageManager::getNumThreads() noexcept
+{
+    return smInstance->mNumThreads;
+}
+
+void ImageManager::setNumThreads(int numThreads)
+{
+    TRJ_ASSERT(numThreads > 0, "Invalid num threads");
+
+    // The new threads are started now if there are pending loads, otherwise with the next asynchronous load:
+    ImageManager& manager = *smInstance;
+    manager.stopThreads();
+    manager.mNumThreads = numThreads;
+
+    if(! manager.mPendingLoads.empty())
+    {
+        for(int index = 0; index < numThreads; ++index)
+        {
+            manager.mThreads.emplace_back(&ImageManager::runThread, &manager);
+        }
+    }
+}
+
+std::size_t ImageManager::getUploadBudget() noexcept
+{
+    return smInstance->mUploadBudget;
+}
+
+void ImageManager::setUploadBudget(std::size_t uploadBudget)
+{
+    TRJ_ASSERT(uploadBudget > 0, "Invalid upload budget");
+
+    smInstance->mUploadBudget = uploadBudget;
+}
+
+int ImageManager::addAtlasImage(const unsigned char* data, int width, int height, int flags)
+{
+    NVGcontext& nanoVgContext = Application::getNanoVgContext();
+    Page* page = nullptr;
+    int x = 0;
+    int y = 0;
+
+    // Pages are never repeated, so images which only differ in their repeat flags share them:
+    int pageFlags = flags & ~(NVG_IMAGE_REPEATX | NVG_IMAGE_REPEATY);
+    for(Ptr<Page>& candidatePage : mPages)
+    {
+        if(candidatePage->flags == pageFlags &&
+                insertAtlasImage(*candidatePage, data, width, height, width * 4, x, y))
+        {
+            page = candidatePage.get();
+            break;
+        }
+    }
+
+    if(! page)
+    {
+        int texture = nvgCreateImageRGBA(&nanoVgContext, smPageSize, smPageSize, pageFlags, nullptr);
+        if(! texture)
+        {
+            throw Exception(__FILE__, __LINE__, "Image load failed");
+        }
+
+        mPages.push_back(Ptr<Page>(new Page{ AtlasPacker(smPageSize, smPageSize),
+                std::vector<unsigned char>(smPageSize * smPageSize * 4), texture, pageFlags, ++mAtlasGeneration, false }));
+        page = mPages.back().get();
+
+        if(! insertAtlasImage(*page, data, width, height, width * 4, x, y))
+        {
+            TRJ_ERROR("Atlas image insert failed");
+        }
+    }
+
+    // Only the rows of the image and its border are uploaded:
+    nvgUpdateImageRows(&nanoVgContext, page->texture, y - smAtlasBorder, height + (smAtlasBorder * 2),
+            page->pixels.data());
+
+    int image = mNextAtlasImage--;
+    mEntries.insert(std::make_pair(image, Entry{nullptr, 0, flags, 1, true, false, page, x, y, width, height}));
     return image;
 }
 
+bool ImageManager::insertAtlasImage(Page& page, const unsigned char* data, int width, int height, int stride,
+        int& x, int& y)
+{
+    int borderX, borderY;
+    if(! page.packer.insert(width + (smAtlasBorder * 2), height + (smAtlasBorder * 2), borderX, borderY))
+    {
+        return false;
+    }
+
+    x = borderX + smAtlasBorder;
+    y = borderY + smAtlasBorder;
+
+    // Edge pixels are duplicated in the border, so filtering doesn't sample the neighbour images:
+    int pageStride = smPageSize * 4;
+    for(int row = -smAtlasBorder; row < height + smAtlasBorder; ++row)
+    {
+        const unsigned char* sourceRow = data + (std::min(std::max(row, 0), height - 1) * stride);
+        unsigned char* pageRow = page.pixels.data() + ((y + row) * pageStride) + (x * 4);
+        memcpy(pageRow, sourceRow, width * 4);
+
+        for(int column = 1; column <= smAtlasBorder; ++column)
+        {
+            memcpy(pageRow - (column * 4), sourceRow, 4);
+            memcpy(pageRow + ((width + column - 1) * 4), sourceRow + ((width - 1) * 4), 4);
+        }
+    }
+
+    return true;
+}
+
+void ImageManager::removeAtlasImage(Entry& entry)
+{
+    Page* page = entry.page;
+    page->packer.remove(entry.width + (smAtlasBorder * 2), entry.height + (smAtlasBorder * 2));
+
+    if(page->packer.getUsedArea())
+    {
+        page->fragmented = true;
+        return;
+    }
+
+    NVGcontext& nanoVgContext = Application::getNanoVgContext();
+    nvgDeleteImage(&nanoVgContext, page->texture);
+
+    auto it = std::find_if(mPages.begin(), mPages.end(), [page](const Ptr<Page>& other)
+    {
+        return other.get() == page;
+    });
+
+    mPages.erase(it);
+}
+
+void ImageManager::moveAtlasImageOut(Entry& entry)
+{
+    const Page& page = *entry.page;
+    int width = entry.width;
+    int height = entry.height;
+    int pageStride = smPageSize * 4;
+    std::vector<unsigned char> pixels(width * height * 4);
+
+    for(int row = 0; row < height; ++row)
+    {
+        memcpy(pixels.data() + (row * width * 4), page.pixels.data() + ((entry.y + row) * pageStride) +
+                (entry.x * 4), width * 4);
+    }
+
+    // The image keeps its handle, and its own texture is built with its original flags:
+    NVGcontext& nanoVgContext = Application::getNanoVgContext();
+    int texture = nvgCreateImageRGBA(&nanoVgContext, width, height, entry.flags, pixels.data());
+    if(! texture)
+    {
+        throw Exception(__FILE__, __LINE__, "Image load failed");
+    }
+
+    removeAtlasImage(entry);
+    entry.page = nullptr;
+    entry.texture = texture;
+}
+
+void ImageManager::repackPage(Page& page)
+{
+    std::vector<Entry*> entries;
+    for(auto& pair : mEntries)
+    {
+        if(pair.second.page == &page)
+        {
+            entries.push_back(&pair.second);
+        }
+    }
+
+    // Taller images are packed first, so the skyline stays flat:
+    std::sort(entries.begin(), entries.end(), [](const Entry* a, const Entry* b)
+    {
+        return a->height > b->height || (a->height == b->height && a->width > b->width);
+    });
+
+    std::vector<unsigned char> oldPixels(std::move(page.pixels));
+    AtlasPacker oldPacker = page.packer;
+    std::vector<std::pair<int, int>> positions;
+    int pageStride = smPageSize * 4;
+    page.pixels.assign(oldPixels.size(), 0);
+    page.packer.clear();
+
+    for(const Entry* entry : entries)
+    {
+        int x, y;
+        const unsigned char* data = oldPixels.data() + (entry->y * pageStride) + (entry->x * 4);
+        if(! insertAtlasImage(page, data, entry->width, entry->height, pageStride, x, y))
+        {
+            // The old layout is kept if the images don't fit in the new order:
+            page.pixels = std::move(oldPixels);
+            page.packer = oldPacker;
+            return;
+        }
+
+        positions.push_back(std::make_pair(x, y));
+    }
+
+    for(std::size_t index = 0; index < entries.size(); ++index)
+    {
+        entries[index]->x = positions[index].first;
+        entries[index]->y = positions[index].second;
+    }
+
+    NVGcontext& nanoVgContext = Application::getNanoVgContext();
+    nvgUpdateImage(&nanoVgContext, page.texture, page.pixels.data());
+    page.generation = ++mAtlasGeneration;
+}
+
+void ImageManager::runThread()
+{
+    while(true)
+    {
+        Load load;
+
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mCondition.wait(lock, [this]{ return mExit || ! mPendingLoads.empty(); });
+
+            if(mExit)
+            {
+                return;
+            }
+
+            load = std::move(mPendingLoads.front());
+            mPendingLoads.pop_front();
+        }
+
+        // Failed loads are reported in the main thread, with a null image data:
+        try
+        {
+            load.imageData.reset(new ImageData(load.filePath));
+        }
+        catch(const Exception&)
+        {
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mDecodedLoads.push_back(std::move(load));
+        }
+    }
+}
+
+void ImageManager::stopThreads() noexcept
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mExit = true;
+    }
+
+    mCondition.notify_all();
+
+    for(std::thread& thread : mThreads)
+    {
+        thread.join();
+    }
+
+    mThreads.clear();
+    mExit = false;
+}
+
 void ImageManager::addImageRef(int image)
 {
     auto it = smInstance->mEntries.find(image);
@@ -92,6 +589,17 @@ void ImageManager::addImageRef(int image)
     entry.count++;
 }
 
+void ImageManager::addPatternImageRef(int image)
+{
+    addImageRef(image);
+
+    Entry& entry = smInstance->mEntries.find(image)->second;
+    if(entry.page)
+    {
+        smInstance->moveAtlasImageOut(entry);
+    }
+}
+
 void ImageManager::removeImageRef(int image)
 {
     auto it = smInstance->mEntries.find(image);
@@ -107,10 +615,14 @@ void ImageManager::removeImageRef(int image)
         {
             Application::deleteFrameBuffer(entry.frameBuffer);
         }
+        else if(entry.page)
+        {
+            smInstance->removeAtlasImage(entry);
+        }
         else
         {
             NVGcontext& nanoVgContext = Application::getNanoVgContext();
-            nvgDeleteImage(&nanoVgContext, it->first);
+            nvgDeleteImage(&nanoVgContext, entry.texture);
         }
 
         smInstance->mEntries.erase(it);
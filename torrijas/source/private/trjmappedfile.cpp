@@ -0,0 +1,113 @@
+//
+// Copyright (c) 2015 Gustavo Valiente gustavovalient@gmail.com
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+//
+
+#include "private/trjmappedfile.h"
+
+#include "trjstring.h"
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+#endif
+
+namespace trj
+{
+
+namespace priv
+{
+
+MappedFile::MappedFile(const String& path)
+{
+    #ifdef _WIN32
+        HANDLE fileHandle = CreateFileA(path.getCharArray(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                FILE_ATTRIBUTE_NORMAL, NULL);
+        if(fileHandle == INVALID_HANDLE_VALUE)
+        {
+            return;
+        }
+
+        LARGE_INTEGER fileSize;
+        HANDLE mappingHandle = NULL;
+        if(GetFileSizeEx(fileHandle, &fileSize) && fileSize.QuadPart > 0)
+        {
+            mappingHandle = CreateFileMappingA(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+        }
+
+        if(! mappingHandle)
+        {
+            CloseHandle(fileHandle);
+            return;
+        }
+
+        void* data = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+        if(! data)
+        {
+            CloseHandle(mappingHandle);
+            CloseHandle(fileHandle);
+            return;
+        }
+
+        mFileHandle = fileHandle;
+        mMappingHandle = mappingHandle;
+        mData = static_cast<const unsigned char*>(data);
+        mSize = static_cast<std::size_t>(fileSize.QuadPart);
+    #else
+        int fileDescriptor = open(path.getCharArray(), O_RDONLY);
+        if(fileDescriptor < 0)
+        {
+            return;
+        }
+
+        struct stat fileStat;
+        if(! fstat(fileDescriptor, &fileStat) && fileStat.st_size > 0)
+        {
+            void* data = mmap(nullptr, static_cast<std::size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE,
+                    fileDescriptor, 0);
+            if(data != MAP_FAILED)
+            {
+                mData = static_cast<const unsigned char*>(data);
+                mSize = static_cast<std::size_t>(fileStat.st_size);
+            }
+        }
+
+        // The mapping stays valid after the file is closed:
+        close(fileDescriptor);
+    #endif
+}
+
+MappedFile::~MappedFile()
+{
+    if(mData)
+    {
+        #ifdef _WIN32
+            UnmapViewOfFile(mData);
+            CloseHandle(mMappingHandle);
+            CloseHandle(mFileHandle);
+        #else
+            munmap(const_cast<unsigned char*>(mData), mSize);
+        #endif
+    }
+}
+
+}
+
+}
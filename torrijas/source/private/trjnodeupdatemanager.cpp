@@ -0,0 +1,420 @@
+//
+// Copyright (c) 2015 Gustavo Valiente gustavovalient@gmail.com
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+//
+
+#include "private/trjnodeupdatemanager.h"
+
+#include <algorithm>
+#include "trjnode.h"
+#include "trjdebug.h"
+#include "private/trjspatialindex.h"
+
+namespace trj
+{
+
+namespace priv
+{
+
+namespace
+{
+    constexpr int kChunkSize = 256;
+
+    // Shorter runs aren't worth waking up the threads:
+    constexpr int kMinParallelNodes = kChunkSize * 2;
+}
+
+NodeUpdateManager* NodeUpdateManager::smInstance = nullptr;
+
+NodeUpdateManager::~NodeUpdateManager()
+{
+    stopThreads();
+
+    for(Node* node : mNodes)
+    {
+        if(node)
+        {
+            node->mUpdateIndex = -1;
+        }
+    }
+
+    smInstance = nullptr;
+}
+
+void NodeUpdateManager::addNode(Node& node)
+{
+    TRJ_ASSERT(node.mUpdateIndex < 0, "Node is already registered");
+
+    if(smInstance)
+    {
+        auto& nodes = smInstance->mNodes;
+        node.mUpdateIndex = nodes.size();
+        nodes.push_back(&node);
+    }
+}
+
+void NodeUpdateManager::removeNode(Node& node) noexcept
+{
+    TRJ_ASSERT(node.mUpdateIndex >= 0, "Node is not registered");
+
+    // Entries are emptied instead of erased, so nodes can be removed while they are updated:
+    if(smInstance)
+    {
+        smInstance->mNodes[node.mUpdateIndex] = nullptr;
+        ++smInstance->mNumRemovedNodes;
+    }
+
+    node.mUpdateIndex = -1;
+}
+
+void NodeUpdateManager::updateNodes(const Node& rootNode, float elapsedTime)
+{
+    NodeUpdateManager& manager = *smInstance;
+    auto& nodes = manager.mNodes;
+
+    manager.mRootNode = &rootNode;
+    manager.mElapsedTime = elapsedTime;
+
+    // Nodes registered while updating are updated in the same frame:
+    for(std::size_t index = 0; index < nodes.size(); )
+    {
+        std::size_t endIndex = index + 1;
+
+        if(! manager.mThreads.empty())
+        {
+            endIndex = index;
+
+            while(endIndex < nodes.size() && manager.isParallelUpdate(nodes[endIndex]))
+            {
+                ++endIndex;
+            }
+
+            if(endIndex - index >= (std::size_t) kMinParallelNodes)
+            {
+                manager.updateNodesInParallel(index, endIndex);
+                index = endIndex;
+                continue;
+            }
+
+            endIndex = std::max(endIndex, index + 1);
+        }
+
+        for(; index < endIndex; ++index)
+        {
+            manager.updateNode(index);
+        }
+    }
+
+    if(manager.mNumRemovedNodes)
+    {
+        manager.removeEmptyEntries();
+    }
+}
+
+int NodeUpdateManager::getNumThreads() noexcept
+{
+    return smInstance->mThreads.size() + 1;
+}
+
+void NodeUpdateManager::setNumThreads(int numThreads)
+{
+    TRJ_ASSERT(numThreads > 0, "Invalid num threads");
+
+    NodeUpdateManager& manager = *smInstance;
+    manager.stopThreads();
+    manager.mWorkers.clear();
+
+    if(numThreads > 1)
+    {
+        for(int index = 0; index < numThreads; ++index)
+        {
+            manager.mWorkers.push_back(Ptr<Worker>(new Worker()));
+        }
+
+        for(int index = 1; index < numThreads; ++index)
+        {
+            manager.mThreads.emplace_back(&NodeUpdateManager::runThread, &manager, index, manager.mPhase);
+        }
+    }
+}
+
+bool NodeUpdateManager::getActionsState(const Node& node, float& actionsSpeed, bool& actionsPaused) const noexcept
+{
+    const Node* topNode = &node;
+    actionsSpeed = 1;
+    actionsPaused = false;
+
+    for(const Node* ancestor = &node; ancestor; ancestor = ancestor->mParent)
+    {
+        actionsSpeed *= ancestor->mActionsSpeed;
+        actionsPaused |= ancestor->mActionsPaused;
+        topNode = ancestor;
+    }
+
+    // Nodes outside the application tree aren't updated:
+    return topNode == mRootNode;
+}
+
+bool NodeUpdateManager::isParallelUpdate(const Node* node) const noexcept
+{
+    if(! node)
+    {
+        return true;
+    }
+
+    if(node->mUpdateEnabled)
+    {
+        return false;
+    }
+
+    for(const auto& action : node->mActions)
+    {
+        if(action->hasCallBacks())
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void NodeUpdateManager::updateNode(int nodeIndex)
+{
+    Node* node = mNodes[nodeIndex];
+    float actionsSpeed;
+    bool actionsPaused;
+
+    if(node && getActionsState(*node, actionsSpeed, actionsPaused))
+    {
+        node->update(mElapsedTime, mElapsedTime * actionsSpeed, actionsPaused);
+    }
+}
+
+void NodeUpdateManager::updateNodesInParallel(int firstNode, int endNode)
+{
+    int numWorkers = mWorkers.size();
+    mFirstNode = firstNode;
+    mEndNode = endNode;
+    mNumChunks = (endNode - firstNode + kChunkSize - 1) / kChunkSize;
+
+    if((int) mChunks.size() < mNumChunks)
+    {
+        mChunks.resize(mNumChunks);
+    }
+
+    for(int index = 0; index < numWorkers; ++index)
+    {
+        Worker& worker = *mWorkers[index];
+        worker.nextChunk.store((mNumChunks * index) / numWorkers);
+        worker.endChunk = (mNumChunks * (index + 1)) / numWorkers;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        ++mPhase;
+        mNumPendingThreads = mThreads.size();
+    }
+
+    mStartCondition.notify_all();
+    runWorker(0);
+
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mEndCondition.wait(lock, [this]{ return mNumPendingThreads == 0; });
+    }
+
+    for(int chunkIndex = 0; chunkIndex < mNumChunks; ++chunkIndex)
+    {
+        commitChunkInvalidations(mChunks[chunkIndex]);
+    }
+
+    for(int chunkIndex = 0; chunkIndex < mNumChunks; ++chunkIndex)
+    {
+        commitChunkNodes(mChunks[chunkIndex]);
+    }
+}
+
+void NodeUpdateManager::runWorker(int workerIndex)
+{
+    int numWorkers = mWorkers.size();
+
+    // Once its own chunks are done, a worker steals chunks from the other ones:
+    for(int offset = 0; offset < numWorkers; ++offset)
+    {
+        Worker& worker = *mWorkers[(workerIndex + offset) % numWorkers];
+
+        for(int chunkIndex = worker.nextChunk++; chunkIndex < worker.endChunk; chunkIndex = worker.nextChunk++)
+        {
+            runChunk(chunkIndex);
+        }
+    }
+}
+
+void NodeUpdateManager::runChunk(int chunkIndex)
+{
+    Chunk& chunk = mChunks[chunkIndex];
+    int firstNodeIndex = mFirstNode + chunkIndex * kChunkSize;
+    int lastNodeIndex = std::min(firstNodeIndex + kChunkSize, mEndNode);
+
+    for(int nodeIndex = firstNodeIndex; nodeIndex < lastNodeIndex; ++nodeIndex)
+    {
+        Node* node = mNodes[nodeIndex];
+        float actionsSpeed;
+        bool actionsPaused;
+
+        if(node && getActionsState(*node, actionsSpeed, actionsPaused))
+        {
+            node->mInvalidationsDeferred = true;
+            node->updateActions(mElapsedTime * actionsSpeed, actionsPaused);
+            node->mInvalidationsDeferred = false;
+
+            // The node fields are updated here, and the shared ones when committing:
+            if(node->mTransformInvalidationDeferred)
+            {
+                node->mTransformInvalidationDeferred = false;
+
+                if(Node* parent = node->mParent)
+                {
+                    if(parent->mSpatialIndex && ! node->mSpatialIndexItemDirty)
+                    {
+                        node->mSpatialIndexItemDirty = true;
+                        chunk.dirtySpatialIndexItems.push_back(DirtySpatialIndexItem{ parent->mSpatialIndex, node });
+                    }
+
+                    if(chunk.invalidatedParents.empty() || chunk.invalidatedParents.back() != parent)
+                    {
+                        chunk.invalidatedParents.push_back(parent);
+                    }
+                }
+            }
+
+            if(node->mBoundingBoxInvalidationDeferred)
+            {
+                node->mBoundingBoxInvalidationDeferred = false;
+                chunk.invalidatedNodes.push_back(node);
+            }
+
+            // Nodes without actions left are unregistered when committing:
+            if(node->mActions.empty())
+            {
+                chunk.committedNodes.push_back(nodeIndex);
+            }
+        }
+    }
+}
+
+void NodeUpdateManager::commitChunkInvalidations(Chunk& chunk)
+{
+    for(const DirtySpatialIndexItem& item : chunk.dirtySpatialIndexItems)
+    {
+        item.spatialIndex->addDirtyNode(*item.node);
+    }
+
+    for(Node* parent : chunk.invalidatedParents)
+    {
+        parent->invalidateSubtreeBoundingBox();
+        parent->invalidateDescendantWorldTransforms();
+    }
+
+    for(Node* node : chunk.invalidatedNodes)
+    {
+        node->invalidateSubtreeBoundingBox();
+    }
+
+    chunk.dirtySpatialIndexItems.clear();
+    chunk.invalidatedParents.clear();
+    chunk.invalidatedNodes.clear();
+}
+
+void NodeUpdateManager::commitChunkNodes(Chunk& chunk)
+{
+    for(int nodeIndex : chunk.committedNodes)
+    {
+        if(Node* node = mNodes[nodeIndex])
+        {
+            node->commitUpdate(mElapsedTime);
+        }
+    }
+
+    chunk.committedNodes.clear();
+}
+
+void NodeUpdateManager::runThread(int workerIndex, unsigned int phase)
+{
+    while(true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mStartCondition.wait(lock, [this, phase]{ return mExit || mPhase != phase; });
+
+            if(mExit)
+            {
+                return;
+            }
+
+            phase = mPhase;
+        }
+
+        runWorker(workerIndex);
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            --mNumPendingThreads;
+        }
+
+        mEndCondition.notify_one();
+    }
+}
+
+void NodeUpdateManager::stopThreads() noexcept
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mExit = true;
+    }
+
+    mStartCondition.notify_all();
+
+    for(std::thread& thread : mThreads)
+    {
+        thread.join();
+    }
+
+    mThreads.clear();
+    mExit = false;
+}
+
+void NodeUpdateManager::removeEmptyEntries() noexcept
+{
+    int numNodes = 0;
+
+    for(Node* node : mNodes)
+    {
+        if(node)
+        {
+            node->mUpdateIndex = numNodes;
+            mNodes[numNodes] = node;
+            ++numNodes;
+        }
+    }
+
+    mNodes.resize(numNodes);
+    mNumRemovedNodes = 0;
+}
+
+}
+
+}
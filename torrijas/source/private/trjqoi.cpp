@@ -0,0 +1,322 @@
+//
+// Copyright (c) 2015 Gustavo Valiente gustavovalient@gmail.com
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+//
+
+#include "private/trjqoi.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include "trjstring.h"
+
+namespace trj
+{
+
+namespace priv
+{
+
+namespace qoi
+{
+
+namespace
+{
+    constexpr unsigned char opIndex = 0x00;
+    constexpr unsigned char opDiff = 0x40;
+    constexpr unsigned char opLuma = 0x80;
+    constexpr unsigned char opRun = 0xc0;
+    constexpr unsigned char opRgb = 0xfe;
+    constexpr unsigned char opRgba = 0xff;
+    constexpr unsigned char opMask = 0xc0;
+    constexpr unsigned char endMarker[8] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+
+    // Same limit as the reference implementation, so the pixels size can't overflow:
+    constexpr unsigned int maxPixels = 400000000;
+
+    struct Pixel
+    {
+        unsigned char r;
+        unsigned char g;
+        unsigned char b;
+        unsigned char a;
+    };
+
+    int getHash(const Pixel& pixel) noexcept
+    {
+        return ((pixel.r * 3) + (pixel.g * 5) + (pixel.b * 7) + (pixel.a * 11)) % 64;
+    }
+
+    bool operator==(const Pixel& a, const Pixel& b) noexcept
+    {
+        return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+    }
+
+    unsigned int readUint32(const unsigned char* data) noexcept
+    {
+        return (static_cast<unsigned int>(data[0]) << 24) | (static_cast<unsigned int>(data[1]) << 16) |
+                (static_cast<unsigned int>(data[2]) << 8) | static_cast<unsigned int>(data[3]);
+    }
+
+    void writeUint32(unsigned char* data, unsigned int value) noexcept
+    {
+        data[0] = static_cast<unsigned char>(value >> 24);
+        data[1] = static_cast<unsigned char>(value >> 16);
+        data[2] = static_cast<unsigned char>(value >> 8);
+        data[3] = static_cast<unsigned char>(value);
+    }
+}
+
+bool isQoi(const unsigned char* data, std::size_t size) noexcept
+{
+    return data && size >= headerSize && ! memcmp(data, "qoif", 4);
+}
+
+bool getSize(const unsigned char* data, std::size_t size, int& width, int& height) noexcept
+{
+    if(! isQoi(data, size))
+    {
+        return false;
+    }
+
+    unsigned int headerWidth = readUint32(data + 4);
+    unsigned int headerHeight = readUint32(data + 8);
+    unsigned int channels = data[12];
+    unsigned int colorSpace = data[13];
+    if(! headerWidth || ! headerHeight || headerHeight >= maxPixels / headerWidth ||
+            channels < 3 || channels > 4 || colorSpace > 1)
+    {
+        return false;
+    }
+
+    width = static_cast<int>(headerWidth);
+    height = static_cast<int>(headerHeight);
+    return true;
+}
+
+bool getFileSize(const String& filePath, int& width, int& height)
+{
+    unsigned char header[headerSize];
+    std::ifstream fileStream(filePath.getCharArray(), std::ios::binary);
+    if(! fileStream.read(reinterpret_cast<char*>(header), headerSize))
+    {
+        return false;
+    }
+
+    return getSize(header, headerSize, width, height);
+}
+
+unsigned char* decode(const unsigned char* data, std::size_t size, int& width, int& height) noexcept
+{
+    int imageWidth, imageHeight;
+    if(! getSize(data, size, imageWidth, imageHeight))
+    {
+        return nullptr;
+    }
+
+    std::size_t numPixels = static_cast<std::size_t>(imageWidth) * static_cast<std::size_t>(imageHeight);
+    auto pixels = static_cast<unsigned char*>(malloc(numPixels * 4));
+    if(! pixels)
+    {
+        return nullptr;
+    }
+
+    Pixel index[64];
+    memset(index, 0, sizeof(index));
+
+    Pixel pixel = { 0, 0, 0, 255 };
+    const unsigned char* chunk = data + headerSize;
+    const unsigned char* chunksEnd = data + size - sizeof(endMarker);
+    unsigned char* output = pixels;
+    unsigned char* outputEnd = pixels + (numPixels * 4);
+    int run = 0;
+
+    while(output < outputEnd)
+    {
+        if(run)
+        {
+            --run;
+        }
+        else if(chunk < chunksEnd)
+        {
+            unsigned char op = *chunk++;
+            if(op == opRgb)
+            {
+                pixel.r = chunk[0];
+                pixel.g = chunk[1];
+                pixel.b = chunk[2];
+                chunk += 3;
+            }
+            else if(op == opRgba)
+            {
+                pixel.r = chunk[0];
+                pixel.g = chunk[1];
+                pixel.b = chunk[2];
+                pixel.a = chunk[3];
+                chunk += 4;
+            }
+            else
+            {
+                switch(op & opMask)
+                {
+
+                case opIndex:
+                    pixel = index[op];
+                    break;
+
+                case opDiff:
+                    pixel.r += ((op >> 4) & 0x03) - 2;
+                    pixel.g += ((op >> 2) & 0x03) - 2;
+                    pixel.b += (op & 0x03) - 2;
+                    break;
+
+                case opLuma:
+                {
+                    int greenDiff = (op & 0x3f) - 32;
+                    unsigned char redBlueDiffs = *chunk++;
+                    pixel.r += greenDiff - 8 + ((redBlueDiffs >> 4) & 0x0f);
+                    pixel.g += greenDiff;
+                    pixel.b += greenDiff - 8 + (redBlueDiffs & 0x0f);
+                    break;
+                }
+
+                default:
+                    run = op & 0x3f;
+                    break;
+                }
+            }
+
+            index[getHash(pixel)] = pixel;
+        }
+        else
+        {
+            // Truncated data:
+            free(pixels);
+            return nullptr;
+        }
+
+        memcpy(output, &pixel, 4);
+        output += 4;
+    }
+
+    width = imageWidth;
+    height = imageHeight;
+    return pixels;
+}
+
+void encode(const unsigned char* pixels, int width, int height, std::vector<unsigned char>& output)
+{
+    std::size_t numPixels = static_cast<std::size_t>(width) * static_cast<std::size_t>(height);
+
+    // Worst case is a RGBA chunk per pixel:
+    output.resize(headerSize + (numPixels * 5) + sizeof(endMarker));
+
+    unsigned char* chunk = output.data();
+    memcpy(chunk, "qoif", 4);
+    writeUint32(chunk + 4, static_cast<unsigned int>(width));
+    writeUint32(chunk + 8, static_cast<unsigned int>(height));
+    chunk[12] = 4;
+    chunk[13] = 0;
+    chunk += headerSize;
+
+    Pixel index[64];
+    memset(index, 0, sizeof(index));
+
+    Pixel previousPixel = { 0, 0, 0, 255 };
+    int run = 0;
+
+    for(std::size_t pixelIndex = 0; pixelIndex < numPixels; ++pixelIndex)
+    {
+        Pixel pixel;
+        memcpy(&pixel, pixels + (pixelIndex * 4), 4);
+
+        if(pixel == previousPixel)
+        {
+            ++run;
+            if(run == 62 || pixelIndex == numPixels - 1)
+            {
+                *chunk++ = opRun | (run - 1);
+                run = 0;
+            }
+
+            continue;
+        }
+
+        if(run)
+        {
+            *chunk++ = opRun | (run - 1);
+            run = 0;
+        }
+
+        int hash = getHash(pixel);
+        if(index[hash] == pixel)
+        {
+            *chunk++ = opIndex | hash;
+        }
+        else
+        {
+            index[hash] = pixel;
+
+            if(pixel.a == previousPixel.a)
+            {
+                // Differences wrap around like the decoder sums:
+                auto redDiff = static_cast<signed char>(pixel.r - previousPixel.r);
+                auto greenDiff = static_cast<signed char>(pixel.g - previousPixel.g);
+                auto blueDiff = static_cast<signed char>(pixel.b - previousPixel.b);
+                int redGreenDiff = redDiff - greenDiff;
+                int blueGreenDiff = blueDiff - greenDiff;
+
+                if(redDiff >= -2 && redDiff <= 1 && greenDiff >= -2 && greenDiff <= 1 &&
+                        blueDiff >= -2 && blueDiff <= 1)
+                {
+                    *chunk++ = opDiff | ((redDiff + 2) << 4) | ((greenDiff + 2) << 2) | (blueDiff + 2);
+                }
+                else if(redGreenDiff >= -8 && redGreenDiff <= 7 && greenDiff >= -32 && greenDiff <= 31 &&
+                        blueGreenDiff >= -8 && blueGreenDiff <= 7)
+                {
+                    chunk[0] = opLuma | (greenDiff + 32);
+                    chunk[1] = ((redGreenDiff + 8) << 4) | (blueGreenDiff + 8);
+                    chunk += 2;
+                }
+                else
+                {
+                    chunk[0] = opRgb;
+                    chunk[1] = pixel.r;
+                    chunk[2] = pixel.g;
+                    chunk[3] = pixel.b;
+                    chunk += 4;
+                }
+            }
+            else
+            {
+                chunk[0] = opRgba;
+                memcpy(chunk + 1, &pixel, 4);
+                chunk += 5;
+            }
+        }
+
+        previousPixel = pixel;
+    }
+
+    memcpy(chunk, endMarker, sizeof(endMarker));
+    chunk += sizeof(endMarker);
+    output.resize(chunk - output.data());
+}
+
+}
+
+}
+
+}
@@ -0,0 +1,305 @@
+//
+// Copyright (c) 2015 Gustavo Valiente gustavovalient@gmail.com
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+//
+
+#include "private/trjrendercacherecorder.h"
+
+#include "nanovg.h"
+#include "trjnode.h"
+#include "trjrendercontext.h"
+#include "trjdebug.h"
+#include "private/trjdisplaylistmanager.h"
+#include "private/trjimagemanager.h"
+#include "private/trjspatialindex.h"
+
+namespace trj
+{
+
+namespace priv
+{
+
+RenderCacheRecorder* RenderCacheRecorder::smInstance = nullptr;
+
+RenderCacheRecorder::~RenderCacheRecorder()
+{
+    stopThreads();
+    deleteRecordingContexts();
+
+    smInstance = nullptr;
+}
+
+#ifdef TRJ_CFG_ENABLE_RENDER_CACHE
+
+void RenderCacheRecorder::record(Node& rootNode, RenderContext& renderContext, float devicePixelRatio)
+{
+    RenderCacheRecorder& recorder = *smInstance;
+    if(recorder.mNumThreads == 1)
+    {
+        return;
+    }
+
+    NVGcontext& nanoVgContext = renderContext.getNanoVgContext();
+    const Rect& windowRect = renderContext.getWindowRect();
+    recorder.mWindowWidth = static_cast<int>(windowRect.getWidth());
+    recorder.mWindowHeight = static_cast<int>(windowRect.getHeight());
+    recorder.collect(rootNode, renderContext, renderContext.renderOffScreen());
+
+    if(recorder.mRecords.empty())
+    {
+        return;
+    }
+
+    auto& recordingContexts = recorder.mRecordingContexts;
+    if(recordingContexts.empty())
+    {
+        for(int index = 0; index < recorder.mNumThreads; ++index)
+        {
+            NVGcontext* recordingContext = nvgCreateRecordingContext(&nanoVgContext);
+            TRJ_ASSERT(recordingContext, "NanoVG recording context build failed");
+            recordingContexts.push_back(recordingContext);
+        }
+    }
+
+    // The recording contexts tessellate with the same settings as the application one:
+    for(NVGcontext* recordingContext : recordingContexts)
+    {
+        nvgBeginFrame(recordingContext, recorder.mWindowWidth, recorder.mWindowHeight, devicePixelRatio);
+    }
+
+    recorder.recordInParallel();
+
+    for(const Record& record : recorder.mRecords)
+    {
+        nvgUploadDisplayList(&nanoVgContext, record.renderCache->displayList);
+        DisplayListManager::recorded(nanoVgContext, *record.renderCache);
+    }
+
+    recorder.mRecords.clear();
+}
+
+void RenderCacheRecorder::release()
+{
+    auto& renderCaches = smInstance->mRenderCaches;
+    for(RenderCache* renderCache : renderCaches)
+    {
+        DisplayListManager::push(*renderCache);
+    }
+
+    renderCaches.clear();
+}
+
+void RenderCacheRecorder::collect(Node& node, RenderContext& renderContext, bool renderOffScreen)
+{
+    // Same traversal as Node::render, with the world transforms and scales it will use:
+    if(node.isHidden())
+    {
+        return;
+    }
+
+    renderOffScreen = renderOffScreen || node.mRenderOffScreen;
+
+    if(! node.mChildren.empty() && ! node.isSubtreeOnScreen(renderContext, renderOffScreen))
+    {
+        return;
+    }
+
+    if(node.renderCacheConcurrent())
+    {
+        float recordScaleX;
+        float recordScaleY;
+        Hash key = node.getPendingRenderCacheKey(renderContext, node.mWorldScaleX, node.mWorldScaleY,
+                recordScaleX, recordScaleY);
+
+        if(key.value && (renderOffScreen || node.getBoundingBox().getTransformed(node.mWorldTransform).isIntersecting(
+                renderContext.getWindowRect())))
+        {
+            addRecord(node, renderContext.getNanoVgContext(), key, recordScaleX, recordScaleY);
+        }
+    }
+
+    // Children with a spatial index are queried with the window rect, like Node::renderChildren does:
+    std::array<float, 6> inverseTransform;
+    if(node.mSpatialIndex && ! renderOffScreen &&
+            nvgTransformInverse(inverseTransform.data(), node.mWorldTransform.data()))
+    {
+        node.updateSpatialIndex(renderContext.getAspectRatio());
+
+        Rect windowRect = renderContext.getWindowRect().getTransformed(inverseTransform);
+        for(Node* child : node.mSpatialIndex->query(windowRect))
+        {
+            collect(*child, renderContext, renderOffScreen);
+        }
+    }
+    else
+    {
+        for(const Node* child : node.mChildren)
+        {
+            collect(const_cast<Node&>(*child), renderContext, renderOffScreen);
+        }
+    }
+}
+
+void RenderCacheRecorder::addRecord(Node& node, NVGcontext& nanoVgContext, const Hash& key, float scaleX,
+        float scaleY)
+{
+    // Render caches already shared (by other nodes or by a previous record) aren't recorded again:
+    if(RenderCache* sharedRenderCache = DisplayListManager::find(key))
+    {
+        DisplayListManager::push(*sharedRenderCache);
+        return;
+    }
+
+    // The render cache is kept until the render is done, so the node can take it:
+    RenderCache& renderCache = DisplayListManager::pull();
+    renderCache.scaleX = scaleX;
+    renderCache.scaleY = scaleY;
+    renderCache.recorded = true;
+    DisplayListManager::insert(renderCache, key);
+    mRenderCaches.push_back(&renderCache);
+
+    // Render caches written in previous runs are read instead of recorded:
+    if(! DisplayListManager::load(nanoVgContext, renderCache))
+    {
+        mRecords.push_back(Record{ &node, &renderCache });
+    }
+}
+
+#endif
+
+void RenderCacheRecorder::recordInParallel()
+{
+    mNextRecord.store(0);
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        ++mPhase;
+        mNumPendingThreads = mThreads.size();
+    }
+
+    mStartCondition.notify_all();
+    runWorker(0);
+
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mEndCondition.wait(lock, [this]{ return mNumPendingThreads == 0; });
+    }
+}
+
+void RenderCacheRecorder::runWorker(int workerIndex)
+{
+    NVGcontext& nanoVgContext = *mRecordingContexts[workerIndex];
+    RenderContext renderContext(nanoVgContext, {{ 1, 0, 0, 1, 0, 0 }}, mWindowWidth, mWindowHeight, false, false,
+            false);
+    int numRecords = mRecords.size();
+
+    for(int index = mNextRecord++; index < numRecords; index = mNextRecord++)
+    {
+        const Record& record = mRecords[index];
+        RenderCache& renderCache = *record.renderCache;
+
+        // Same steps as Node::recordRenderCache, without blend colors:
+        nvgResetTransform(&nanoVgContext);
+        nvgResetScissor(&nanoVgContext);
+        nvgScale(&nanoVgContext, renderCache.scaleX, renderCache.scaleY);
+        nvgGlobalAlpha(&nanoVgContext, 1);
+        nvgBindDisplayList(&nanoVgContext, renderCache.displayList);
+        ImageManager::beginRecord(renderCache.atlasPageGenerations);
+        record.node->renderItself(renderContext);
+        ImageManager::endRecord();
+        nvgBindDisplayList(&nanoVgContext, nullptr);
+    }
+}
+
+void RenderCacheRecorder::runThread(int workerIndex, unsigned int phase)
+{
+    while(true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mStartCondition.wait(lock, [this, phase]{ return mExit || mPhase != phase; });
+
+            if(mExit)
+            {
+                return;
+            }
+
+            phase = mPhase;
+        }
+
+        runWorker(workerIndex);
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            --mNumPendingThreads;
+        }
+
+        mEndCondition.notify_one();
+    }
+}
+
+void RenderCacheRecorder::stopThreads() noexcept
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mExit = true;
+    }
+
+    mStartCondition.notify_all();
+
+    for(std::thread& thread : mThreads)
+    {
+        thread.join();
+    }
+
+    mThreads.clear();
+    mExit = false;
+}
+
+void RenderCacheRecorder::deleteRecordingContexts() noexcept
+{
+    for(NVGcontext* recordingContext : mRecordingContexts)
+    {
+        nvgDeleteRecordingContext(recordingContext);
+    }
+
+    mRecordingContexts.clear();
+}
+
+int RenderCacheRecorder::getNumThreads() noexcept
+{
+    return smInstance->mNumThreads;
+}
+
+void RenderCacheRecorder::setNumThreads(int numThreads)
+{
+    TRJ_ASSERT(numThreads > 0, "Invalid num threads");
+
+    // Recording contexts are built again for the new threads when they are needed:
+    RenderCacheRecorder& recorder = *smInstance;
+    recorder.stopThreads();
+    recorder.deleteRecordingContexts();
+    recorder.mNumThreads = numThreads;
+
+    for(int index = 1; index < numThreads; ++index)
+    {
+        recorder.mThreads.emplace_back(&RenderCacheRecorder::runThread, &recorder, index, recorder.mPhase);
+    }
+}
+
+}
+
+}
@@ -0,0 +1,410 @@
+//
+// Copyright (c) 2015 Gustavo Valiente gustavovalient@gmail.com
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+//
+
+#include "private/trjspatialindex.h"
+
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#include "trjrect.h"
+#include "trjdebug.h"
+
+namespace trj
+{
+
+namespace priv
+{
+
+int SpatialIndex::addCell(float x, float y, float size)
+{
+    Cell cell;
+    cell.x = x;
+    cell.y = y;
+    cell.size = size;
+    cell.parent = kNoCell;
+    cell.children[0] = kNoCell;
+    cell.children[1] = kNoCell;
+    cell.children[2] = kNoCell;
+    cell.children[3] = kNoCell;
+
+    // Cells are created empty:
+    cell.minX = std::numeric_limits<float>::max();
+    cell.minY = std::numeric_limits<float>::max();
+    cell.maxX = -std::numeric_limits<float>::max();
+    cell.maxY = -std::numeric_limits<float>::max();
+    cell.boundsDirty = false;
+
+    mCells.push_back(std::move(cell));
+    return mCells.size() - 1;
+}
+
+void SpatialIndex::growRoot(float centerX, float centerY, float extent)
+{
+    if(mRootCell == kNoCell)
+    {
+        float size = std::max(extent, 1.0f) * 2;
+        mRootCell = addCell(centerX - (size * 0.5f), centerY - (size * 0.5f), size);
+        return;
+    }
+
+    while(true)
+    {
+        const Cell& root = mCells[mRootCell];
+        float x = root.x;
+        float y = root.y;
+        float size = root.size;
+
+        if(centerX >= x && centerX < x + size && centerY >= y && centerY < y + size && extent <= size)
+        {
+            return;
+        }
+
+        float newX = centerX < x ? x - size : x;
+        float newY = centerY < y ? y - size : y;
+        int newRoot = addCell(newX, newY, size * 2);
+        int quadrant = (x > newX ? 1 : 0) + (y > newY ? 2 : 0);
+        Cell& newRootRef = mCells[newRoot];
+        newRootRef.children[quadrant] = mRootCell;
+        newRootRef.boundsDirty = true;
+        mCells[mRootCell].parent = newRoot;
+        mRootCell = newRoot;
+    }
+}
+
+void SpatialIndex::link(int item)
+{
+    Item& itemRef = mItems[item];
+    float centerX = (itemRef.minX + itemRef.maxX) * 0.5f;
+    float centerY = (itemRef.minY + itemRef.maxY) * 0.5f;
+    float extent = std::max(itemRef.maxX - itemRef.minX, itemRef.maxY - itemRef.minY);
+    growRoot(centerX, centerY, extent);
+
+    int cell = mRootCell;
+    for(int depth = 0; depth < kMaxDepth; ++depth)
+    {
+        const Cell& cellRef = mCells[cell];
+        float half = cellRef.size * 0.5f;
+        if(extent > half)
+        {
+            break;
+        }
+
+        bool right = centerX >= cellRef.x + half;
+        bool bottom = centerY >= cellRef.y + half;
+        int quadrant = (right ? 1 : 0) + (bottom ? 2 : 0);
+        int child = cellRef.children[quadrant];
+        if(child == kNoCell)
+        {
+            child = addCell(right ? cellRef.x + half : cellRef.x, bottom ? cellRef.y + half : cellRef.y, half);
+            mCells[cell].children[quadrant] = child;
+            mCells[child].parent = cell;
+        }
+
+        cell = child;
+    }
+
+    std::vector<int>& cellItems = mCells[cell].items;
+    Item& linkedItem = mItems[item];
+    linkedItem.cell = cell;
+    linkedItem.slot = cellItems.size();
+    cellItems.push_back(item);
+    invalidateBounds(cell);
+}
+
+void SpatialIndex::unlink(int item) noexcept
+{
+    Item& itemRef = mItems[item];
+    std::vector<int>* items;
+    if(itemRef.cell >= 0)
+    {
+        items = &(mCells[itemRef.cell].items);
+        invalidateBounds(itemRef.cell);
+    }
+    else if(itemRef.cell == kUnboundedCell)
+    {
+        items = &mUnboundedItems;
+    }
+    else
+    {
+        return;
+    }
+
+    int lastItem = items->back();
+    (*items)[itemRef.slot] = lastItem;
+    mItems[lastItem].slot = itemRef.slot;
+    items->pop_back();
+    itemRef.cell = kNoCell;
+}
+
+void SpatialIndex::invalidateBounds(int cell) noexcept
+{
+    // The ancestors of a cell with outdated bounds are outdated too:
+    while(cell != kNoCell && ! mCells[cell].boundsDirty)
+    {
+        Cell& cellRef = mCells[cell];
+        cellRef.boundsDirty = true;
+        cell = cellRef.parent;
+    }
+}
+
+void SpatialIndex::updateBounds(int cell) noexcept
+{
+    Cell& cellRef = mCells[cell];
+    if(! cellRef.boundsDirty)
+    {
+        return;
+    }
+
+    float minX = std::numeric_limits<float>::max();
+    float minY = std::numeric_limits<float>::max();
+    float maxX = -std::numeric_limits<float>::max();
+    float maxY = -std::numeric_limits<float>::max();
+
+    for(int item : cellRef.items)
+    {
+        const Item& itemRef = mItems[item];
+        minX = std::min(minX, itemRef.minX);
+        minY = std::min(minY, itemRef.minY);
+        maxX = std::max(maxX, itemRef.maxX);
+        maxY = std::max(maxY, itemRef.maxY);
+    }
+
+    for(int child : cellRef.children)
+    {
+        if(child != kNoCell)
+        {
+            updateBounds(child);
+
+            const Cell& childRef = mCells[child];
+            minX = std::min(minX, childRef.minX);
+            minY = std::min(minY, childRef.minY);
+            maxX = std::max(maxX, childRef.maxX);
+            maxY = std::max(maxY, childRef.maxY);
+        }
+    }
+
+    // mCells isn't resized while updating, so the reference is still valid:
+    cellRef.minX = minX;
+    cellRef.minY = minY;
+    cellRef.maxX = maxX;
+    cellRef.maxY = maxY;
+    cellRef.boundsDirty = false;
+}
+
+int SpatialIndex::add(Node& node, int order)
+{
+    int item;
+    if(mFreeItems.empty())
+    {
+        item = mItems.size();
+        mItems.push_back(Item());
+    }
+    else
+    {
+        item = mFreeItems.back();
+        mFreeItems.pop_back();
+    }
+
+    Item& itemRef = mItems[item];
+    itemRef.node = &node;
+    itemRef.order = order;
+    itemRef.cell = kNoCell;
+    itemRef.slot = 0;
+    return item;
+}
+
+void SpatialIndex::remove(int item) noexcept
+{
+    TRJ_ASSERT(item >= 0 && item < (int) mItems.size(), "Invalid item");
+
+    unlink(item);
+    mItems[item].node = nullptr;
+    mFreeItems.push_back(item);
+}
+
+void SpatialIndex::setBounds(int item, const Rect& bounds)
+{
+    TRJ_ASSERT(item >= 0 && item < (int) mItems.size(), "Invalid item");
+
+    if(bounds.isEmpty())
+    {
+        unlink(item);
+        return;
+    }
+
+    float minX = bounds.getX();
+    float minY = bounds.getY();
+    float maxX = minX + bounds.getWidth();
+    float maxY = minY + bounds.getHeight();
+    if(! std::isfinite(minX) || ! std::isfinite(minY) || ! std::isfinite(maxX) || ! std::isfinite(maxY))
+    {
+        setUnbounded(item);
+        return;
+    }
+
+    Item& itemRef = mItems[item];
+    itemRef.minX = minX;
+    itemRef.minY = minY;
+    itemRef.maxX = maxX;
+    itemRef.maxY = maxY;
+
+    if(itemRef.cell >= 0)
+    {
+        // Keep the item in its cell while it still fits in the loose bounds:
+        const Cell& cell = mCells[itemRef.cell];
+        float centerX = (minX + maxX) * 0.5f;
+        float centerY = (minY + maxY) * 0.5f;
+        if(centerX >= cell.x && centerX < cell.x + cell.size && centerY >= cell.y &&
+                centerY < cell.y + cell.size && std::max(maxX - minX, maxY - minY) <= cell.size)
+        {
+            invalidateBounds(itemRef.cell);
+            return;
+        }
+    }
+
+    unlink(item);
+    link(item);
+}
+
+void SpatialIndex::setUnbounded(int item)
+{
+    TRJ_ASSERT(item >= 0 && item < (int) mItems.size(), "Invalid item");
+
+    Item& itemRef = mItems[item];
+    if(itemRef.cell != kUnboundedCell)
+    {
+        unlink(item);
+        itemRef.cell = kUnboundedCell;
+        itemRef.slot = mUnboundedItems.size();
+        mUnboundedItems.push_back(item);
+    }
+}
+
+void SpatialIndex::clear() noexcept
+{
+    mCells.clear();
+    mItems.clear();
+    mFreeItems.clear();
+    mUnboundedItems.clear();
+    mDirtyNodes.clear();
+    mRootCell = kNoCell;
+}
+
+const std::vector<Node*>& SpatialIndex::query(const Rect& rect)
+{
+    float minX = rect.getX();
+    float minY = rect.getY();
+    float maxX = minX + rect.getWidth();
+    float maxY = minY + rect.getHeight();
+
+    mQueryItems.clear();
+
+    for(int item : mUnboundedItems)
+    {
+        const Item& itemRef = mItems[item];
+        mQueryItems.push_back(std::make_pair(itemRef.order, itemRef.node));
+    }
+
+    if(mRootCell != kNoCell)
+    {
+        mQueryCells.clear();
+        mQueryCells.push_back(mRootCell);
+
+        while(! mQueryCells.empty())
+        {
+            const Cell& cell = mCells[mQueryCells.back()];
+            mQueryCells.pop_back();
+
+            float looseMargin = cell.size * 0.5f;
+            if(cell.x - looseMargin > maxX || cell.x + cell.size + looseMargin < minX ||
+                    cell.y - looseMargin > maxY || cell.y + cell.size + looseMargin < minY)
+            {
+                continue;
+            }
+
+            for(int item : cell.items)
+            {
+                const Item& itemRef = mItems[item];
+                if(itemRef.minX <= maxX && itemRef.maxX >= minX && itemRef.minY <= maxY &&
+                        itemRef.maxY >= minY)
+                {
+                    mQueryItems.push_back(std::make_pair(itemRef.order, itemRef.node));
+                }
+            }
+
+            for(int child : cell.children)
+            {
+                if(child != kNoCell)
+                {
+                    mQueryCells.push_back(child);
+                }
+            }
+        }
+    }
+
+    std::sort(mQueryItems.begin(), mQueryItems.end(),
+            [](const std::pair<int, Node*>& a, const std::pair<int, Node*>& b)
+            {
+                return a.first < b.first;
+            });
+
+    mQueryNodes.clear();
+
+    for(const auto& queryItem : mQueryItems)
+    {
+        mQueryNodes.push_back(queryItem.second);
+    }
+
+    return mQueryNodes;
+}
+
+bool SpatialIndex::getBounds(Rect& bounds)
+{
+    if(! mUnboundedItems.empty())
+    {
+        return false;
+    }
+
+    bounds = Rect();
+
+    if(mRootCell != kNoCell)
+    {
+        updateBounds(mRootCell);
+
+        const Cell& root = mCells[mRootCell];
+        if(root.minX <= root.maxX && root.minY <= root.maxY)
+        {
+            bounds = Rect(root.minX, root.minY, root.maxX - root.minX, root.maxY - root.minY);
+        }
+    }
+
+    return true;
+}
+
+void SpatialIndex::removeDirtyNode(Node& node) noexcept
+{
+    auto it = std::find(mDirtyNodes.begin(), mDirtyNodes.end(), &node);
+    if(it != mDirtyNodes.end())
+    {
+        mDirtyNodes.erase(it);
+    }
+}
+
+}
+
+}
@@ -59,6 +59,9 @@
 #include "nanovg_gl.h"
 #include "nanovg_gl_utils.h"
 
+#define NANOVG_NULL_IMPLEMENTATION
+#include "nanovg_null.h"
+
 #include "trjnode.h"
 #include "trjfont.h"
 #include "trjkeyboard.h"
@@ -67,10 +70,14 @@
 #include "trjperfgraph.h"
 #include "trjapplicationconfig.h"
 #include "trjrendercontext.h"
+#include "trjrenderstats.h"
+#include "trjrendercachestats.h"
 #include "trjexception.h"
 #include "trjdebug.h"
 #include "private/trjimagemanager.h"
 #include "private/trjdisplaylistmanager.h"
+#include "private/trjnodeupdatemanager.h"
+#include "private/trjrendercacherecorder.h"
 
 namespace trj
 {
@@ -102,19 +109,22 @@ struct Application::Impl
     Ptr<Keyboard> keyboard;
     Ptr<Mouse> mouse;
     priv::ImageManager imageManager;
-    #ifdef TRJ_CFG_ENABLE_RENDER_CACHE
-        Ptr<priv::DisplayListManager> displayListManager;
-    #endif
+    priv::NodeUpdateManager nodeUpdateManager;
+    priv::RenderCacheRecorder renderCacheRecorder;
+    Ptr<priv::DisplayListManager> displayListManager;
     Color backgroundColor;
     ApplicationConfig config;
     PerfGraph frameTimeGraph;
     PerfGraph cpuGraph;
+    PerfGraph mergedCallsGraph;
     GLFWwindow* window = nullptr;
     NVGcontext* context = nullptr;
+    std::chrono::steady_clock::time_point headlessStartTime;
     double previousTime = 0;
     double cpuPreviousTime = 0;
     double fpsLimitWaitTime = 0;
     float frameTime = kEpsilon;
+    float updateTime = 0;
     float pixelAspectRatio = 0;
     int windowWidth = -1;
     int windowHeight = -1;
@@ -123,11 +133,15 @@ struct Application::Impl
     bool showPerformanceGraphs = false;
     bool showBoundingBoxes = false;
     bool glfwLoaded = false;
+    bool headless = false;
+    bool headlessClosed = false;
+    bool streamingBuffers = false;
 
     explicit Impl(ApplicationConfig config) :
         config(std::move(config)),
         frameTimeGraph(PerfGraph::Style::FPS, "Frame Time"),
-        cpuGraph(PerfGraph::Style::MS, "CPU Time")
+        cpuGraph(PerfGraph::Style::MS, "CPU Time"),
+        mergedCallsGraph(PerfGraph::Style::PERCENT, "Merged Calls")
     {
     }
 };
@@ -145,6 +159,11 @@ Font& Application::getDefaultFont() noexcept
 ImageData Application::getScreenshot()
 {
     auto impl = smInstance->mImpl;
+    if(impl->headless)
+    {
+        return ImageData(impl->windowWidth, impl->windowHeight);
+    }
+
     int frameBufferWidth, frameBufferHeight;
     glfwGetFramebufferSize(impl->window, &frameBufferWidth, &frameBufferHeight);
 
@@ -191,6 +210,19 @@ void* Application::getFrameBuffer(Node& node, const Color& backgroundColor, int
     TRJ_ASSERT(height > 0, "Invalid height");
 
     auto impl = smInstance->mImpl;
+    if(impl->headless)
+    {
+        imageHandle = nvgCreateImageRGBA(impl->context, width, height, imageFlags, nullptr);
+        if(! imageHandle)
+        {
+            throw FrameBufferException(__FILE__, __LINE__);
+        }
+
+        smInstance->render(node, width, height, width / impl->pixelAspectRatio,
+                height / impl->pixelAspectRatio, backgroundColor, false);
+        return nullptr;
+    }
+
     NVGLUframebuffer* frameBuffer = nvgluCreateFramebuffer(impl->context, width, height, imageFlags);
     if(! frameBuffer)
     {
@@ -229,26 +261,29 @@ void Application::render(Node& node, int frameBufferWidth, int frameBufferHeight
     TRJ_ASSERT(windowWidth > 0, "Invalid windowWidth");
     TRJ_ASSERT(windowHeight > 0, "Invalid windowHeight");
 
-    glViewport(0, 0, frameBufferWidth, frameBufferHeight);
-    glClearColor(backgroundColor.getRed(), backgroundColor.getGreen(), backgroundColor.getBlue(),
-            backgroundColor.getAlpha());
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
-
-    #if defined(TRJ_CFG_GLES2) || defined(TRJ_CFG_GLES3)
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-        glEnable(GL_CULL_FACE);
-        glDisable(GL_DEPTH_TEST);
-    #endif
+    if(! mImpl->headless)
+    {
+        glViewport(0, 0, frameBufferWidth, frameBufferHeight);
+        glClearColor(backgroundColor.getRed(), backgroundColor.getGreen(), backgroundColor.getBlue(),
+                backgroundColor.getAlpha());
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+
+        #if defined(TRJ_CFG_GLES2) || defined(TRJ_CFG_GLES3)
+            glEnable(GL_BLEND);
+            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            glEnable(GL_CULL_FACE);
+            glDisable(GL_DEPTH_TEST);
+        #endif
+    }
 
     // Calculate pixel ratio for hi-dpi devices:
     nvgBeginFrame(mImpl->context, windowWidth, windowHeight, mImpl->pixelAspectRatio);
 
     nvgSave(mImpl->context);
-    nvgTranslate(mImpl->context, windowWidth * 0.5f, windowHeight * 0.5f);
 
     float windowScale = windowHeight / getScreenHeight();
-    nvgScale(mImpl->context, windowScale, windowScale);
+    std::array<float, 6> transform = {{ windowScale, 0, 0, windowScale, windowWidth * 0.5f,
+            windowHeight * 0.5f }};
 
     bool windowWidthChanged = false;
     if(windowWidth != mImpl->lastWindowWidth)
@@ -264,23 +299,51 @@ void Application::render(Node& node, int frameBufferWidth, int frameBufferHeight
         windowHeightChanged = true;
     }
 
-    RenderContext renderContext(*(mImpl->context), windowWidth, windowHeight, windowWidthChanged,
-            windowHeightChanged, mImpl->showBoundingBoxes);
-    node.render(renderContext);
+    RenderContext renderContext(*(mImpl->context), transform, windowWidth, windowHeight,
+            windowWidthChanged, windowHeightChanged, mImpl->showBoundingBoxes);
+
+    // Render caches are recorded at the window resolution, so text glyphs keep their size:
+    renderContext.setFinalScaleX(windowScale);
+    renderContext.setFinalScaleY(windowScale);
+
+    // Frame buffer nodes are rendered from another transform, so their world transforms are updated
+    // again for it and invalidated for the next render of the application tree:
+    bool frameBufferNode = &node != mImpl->node.get();
+    node.updateWorldTransforms(transform, windowScale, windowScale, renderContext.getAspectRatio(),
+            renderContext.windowSizeChanged(), frameBufferNode || renderContext.windowSizeChanged());
+
+    #ifdef TRJ_CFG_ENABLE_RENDER_CACHE
+        priv::RenderCacheRecorder::record(node, renderContext, mImpl->pixelAspectRatio);
+        node.render(renderContext);
+        priv::RenderCacheRecorder::release();
+    #else
+        node.render(renderContext);
+    #endif
 
     nvgRestore(mImpl->context);
 
+    if(frameBufferNode)
+    {
+        node.invalidateWorldTransform();
+    }
+
     if(renderPerformanceGraphs)
     {
         int fontHandle = mImpl->font->getHandle();
         mImpl->frameTimeGraph.renderGraph(*(mImpl->context), 5, 5, fontHandle);
         mImpl->cpuGraph.renderGraph(*(mImpl->context), 5 + 200 + 5, 5, fontHandle);
+        mImpl->mergedCallsGraph.renderGraph(*(mImpl->context), 5 + 200 + 5 + 200 + 5, 5, fontHandle);
     }
 
     nvgEndFrame(mImpl->context);
 
+    mImpl->displayListManager->update();
+
     #if defined(TRJ_CFG_GLES2) || defined(TRJ_CFG_GLES3)
-        glEnable(GL_DEPTH_TEST);
+        if(! mImpl->headless)
+        {
+            glEnable(GL_DEPTH_TEST);
+        }
     #endif
 }
 
@@ -299,149 +362,199 @@ Application::Application(ApplicationConfig config) :
 
     smInstance = this;
 
-    if(glfwInit() == GL_FALSE)
+    const ApplicationConfig& appConfig = mImpl->config;
+    int nanoVgFlags = NVG_STENCIL_STROKES;
+    if(appConfig.isAntialiasEnabled())
     {
-        throw Exception(__FILE__, __LINE__, "GLFW initialization failed");
+        nanoVgFlags |= NVG_ANTIALIAS;
     }
 
-    mImpl->glfwLoaded = true;
-
-    glfwSetErrorCallback(glfwErrorCallback);
-
-    #if defined(TRJ_CFG_GLES3)
-        glfwWindowHint(GLFW_CLIENT_API, GLFW_OPENGL_ES_API);
-        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 0);
-    #elif defined(TRJ_CFG_GL3)
-        // Not required on win32, and works with more cards:
-        #ifndef _WIN32
-            glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-            glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 2);
-            glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
-            glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-        #endif
-
-        #ifdef TRJ_DEBUG
-            glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, 1);
-        #else
-            glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, 0);
-        #endif
-    #elif defined(TRJ_CFG_GLES2)
-        glfwWindowHint(GLFW_CLIENT_API, GLFW_OPENGL_ES_API);
-        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 2);
-        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 0);
-    #else
-        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 2);
-        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 0);
+    #ifdef TRJ_DEBUG
+        nanoVgFlags |= NVG_DEBUG;
     #endif
 
-    GLFWmonitor* monitor = glfwGetPrimaryMonitor();
-    if(! monitor)
+    if(appConfig.isHeadlessEnabled())
     {
-        throw Exception(__FILE__, __LINE__, "GLFW monitor not found");
-    }
+        int screenWidth = appConfig.getScreenWidth();
+        int screenHeight = appConfig.getScreenHeight();
 
-    const ApplicationConfig& appConfig = mImpl->config;
-    if(appConfig.isFullScreenEnabled())
-    {
-        const GLFWvidmode* videoMode = glfwGetVideoMode(monitor);
-        if(! videoMode)
-        {
-            throw Exception(__FILE__, __LINE__, "GLFW monitor video mode not found");
-        }
+        TRJ_ASSERT(screenWidth > 0, "Invalid screenWidth");
+        TRJ_ASSERT(screenHeight > 0, "Invalid screenHeight");
 
-        glfwWindowHint(GLFW_RED_BITS, videoMode->redBits);
-        glfwWindowHint(GLFW_GREEN_BITS, videoMode->greenBits);
-        glfwWindowHint(GLFW_BLUE_BITS, videoMode->blueBits);
-        glfwWindowHint(GLFW_REFRESH_RATE, videoMode->refreshRate);
+        mImpl->headless = true;
+        mImpl->windowWidth = screenWidth;
+        mImpl->windowHeight = screenHeight;
+        mImpl->pixelAspectRatio = 1;
+        mImpl->keyboard.reset(new Keyboard(nullptr));
+        mImpl->mouse.reset(new Mouse(nullptr));
 
-        mImpl->window = glfwCreateWindow(videoMode->width, videoMode->height,
-                appConfig.getWindowTitle().getCharArray(), monitor, NULL);
-        if(! mImpl->window)
+        mImpl->context = nvgCreateNull(nanoVgFlags);
+        if(! mImpl->context)
         {
-            throw Exception(__FILE__, __LINE__, "GLFW full screen window build failed");
+            throw Exception(__FILE__, __LINE__, "NanoVG null context build failed");
         }
     }
     else
     {
-        int screenWidth = appConfig.getScreenWidth();
-        int screenHeight = appConfig.getScreenHeight();
-
-        TRJ_ASSERT(screenWidth > 0, "Invalid screenWidth");
-        TRJ_ASSERT(screenHeight > 0, "Invalid screenHeight");
-
-        mImpl->window = glfwCreateWindow(screenWidth, screenHeight,
-                appConfig.getWindowTitle().getCharArray(), NULL, NULL);
-        if(! mImpl->window)
+        if(glfwInit() == GL_FALSE)
         {
-            throw Exception(__FILE__, __LINE__, "GLFW window build failed");
+            throw Exception(__FILE__, __LINE__, "GLFW initialization failed");
         }
-    }
 
-    mImpl->keyboard.reset(new Keyboard(mImpl->window));
-    mImpl->mouse.reset(new Mouse(mImpl->window));
-    glfwMakeContextCurrent(mImpl->window);
+        mImpl->glfwLoaded = true;
 
-    #ifdef TRJ_CFG_ENABLE_GLEW
-        if(! smGlewLoaded)
-        {
-            if(glewInit() != GLEW_OK)
-            {
-                throw Exception(__FILE__, __LINE__, "GLEW initialization failed");
-            }
+        glfwSetErrorCallback(glfwErrorCallback);
 
-            smGlewLoaded = true;
-        }
-    #endif
-
-    int nanoVgFlags = NVG_STENCIL_STROKES;
-    if(appConfig.isAntialiasEnabled())
-    {
-        nanoVgFlags |= NVG_ANTIALIAS;
-    }
+        #if defined(TRJ_CFG_GLES3)
+            glfwWindowHint(GLFW_CLIENT_API, GLFW_OPENGL_ES_API);
+            glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+            glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 0);
+        #elif defined(TRJ_CFG_GL3)
+            // Not required on win32, and works with more cards:
+            #ifndef _WIN32
+                glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+                glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+                glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+                glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+            #endif
 
-    #ifdef TRJ_DEBUG
-        nanoVgFlags |= NVG_DEBUG;
-    #endif
+            #ifdef TRJ_DEBUG
+                glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, 1);
+            #else
+                glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, 0);
+            #endif
+        #elif defined(TRJ_CFG_GLES2)
+            glfwWindowHint(GLFW_CLIENT_API, GLFW_OPENGL_ES_API);
+            glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 2);
+            glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 0);
+        #else
+            glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 2);
+            glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 0);
+        #endif
 
-    #if defined(TRJ_CFG_GLES3)
-        mImpl->context = nvgCreateGLES3(nanoVgFlags);
-        if(! mImpl->context)
+        GLFWmonitor* monitor = glfwGetPrimaryMonitor();
+        if(! monitor)
         {
-            throw Exception(__FILE__, __LINE__, "NanoVG GLES3 context build failed");
+            throw Exception(__FILE__, __LINE__, "GLFW monitor not found");
         }
-    #elif defined(TRJ_CFG_GL3)
-        mImpl->context = nvgCreateGL3(nanoVgFlags);
-        if(! mImpl->context)
-        {
-            throw Exception(__FILE__, __LINE__, "NanoVG GL3 context build failed");
-        }
-    #elif defined(TRJ_CFG_GLES2)
-        mImpl->context = nvgCreateGLES2(nanoVgFlags);
-        if(! mImpl->context)
+
+        if(appConfig.isFullScreenEnabled())
         {
-            throw Exception(__FILE__, __LINE__, "NanoVG GLES2 context build failed");
+            const GLFWvidmode* videoMode = glfwGetVideoMode(monitor);
+            if(! videoMode)
+            {
+                throw Exception(__FILE__, __LINE__, "GLFW monitor video mode not found");
+            }
+
+            glfwWindowHint(GLFW_RED_BITS, videoMode->redBits);
+            glfwWindowHint(GLFW_GREEN_BITS, videoMode->greenBits);
+            glfwWindowHint(GLFW_BLUE_BITS, videoMode->blueBits);
+            glfwWindowHint(GLFW_REFRESH_RATE, videoMode->refreshRate);
+
+            mImpl->window = glfwCreateWindow(videoMode->width, videoMode->height,
+                    appConfig.getWindowTitle().getCharArray(), monitor, NULL);
+            if(! mImpl->window)
+            {
+                throw Exception(__FILE__, __LINE__, "GLFW full screen window build failed");
+            }
         }
-    #else
-        mImpl->context = nvgCreateGL2(nanoVgFlags);
-        if(! mImpl->context)
+        else
         {
-            throw Exception(__FILE__, __LINE__, "NanoVG GL2 context build failed");
+            int screenWidth = appConfig.getScreenWidth();
+            int screenHeight = appConfig.getScreenHeight();
+
+            TRJ_ASSERT(screenWidth > 0, "Invalid screenWidth");
+            TRJ_ASSERT(screenHeight > 0, "Invalid screenHeight");
+
+            mImpl->window = glfwCreateWindow(screenWidth, screenHeight,
+                    appConfig.getWindowTitle().getCharArray(), NULL, NULL);
+            if(! mImpl->window)
+            {
+                throw Exception(__FILE__, __LINE__, "GLFW window build failed");
+            }
         }
-    #endif
 
-    glfwSwapInterval(appConfig.isVSyncEnabled());
+        mImpl->keyboard.reset(new Keyboard(mImpl->window));
+        mImpl->mouse.reset(new Mouse(mImpl->window));
+        glfwMakeContextCurrent(mImpl->window);
 
-    #ifdef TRJ_CFG_ENABLE_RENDER_CACHE
-        mImpl->displayListManager.reset(new priv::DisplayListManager());
-    #endif
+        #ifdef TRJ_CFG_ENABLE_GLEW
+            if(! smGlewLoaded)
+            {
+                #ifdef TRJ_CFG_GL3
+                    // Core profile entry points aren't listed as extensions, so GLEW must load them anyway:
+                    glewExperimental = GL_TRUE;
+                #endif
+
+                if(glewInit() != GLEW_OK)
+                {
+                    throw Exception(__FILE__, __LINE__, "GLEW initialization failed");
+                }
+
+                // glewInit queries the extensions string, which is an invalid enum in core profiles:
+                glGetError();
+
+                smGlewLoaded = true;
+            }
+        #endif
+
+        #if defined(TRJ_CFG_GLES3)
+            mImpl->context = nvgCreateGLES3(nanoVgFlags);
+            if(! mImpl->context)
+            {
+                throw Exception(__FILE__, __LINE__, "NanoVG GLES3 context build failed");
+            }
+        #elif defined(TRJ_CFG_GL3)
+            if(appConfig.isStreamingBuffersEnabled())
+            {
+                nanoVgFlags |= NVG_STREAMING_BUFFERS;
+                mImpl->streamingBuffers = true;
+            }
+
+            mImpl->context = nvgCreateGL3(nanoVgFlags);
+            if(! mImpl->context)
+            {
+                throw Exception(__FILE__, __LINE__, "NanoVG GL3 context build failed");
+            }
+        #elif defined(TRJ_CFG_GLES2)
+            mImpl->context = nvgCreateGLES2(nanoVgFlags);
+            if(! mImpl->context)
+            {
+                throw Exception(__FILE__, __LINE__, "NanoVG GLES2 context build failed");
+            }
+        #else
+            mImpl->context = nvgCreateGL2(nanoVgFlags);
+            if(! mImpl->context)
+            {
+                throw Exception(__FILE__, __LINE__, "NanoVG GL2 context build failed");
+            }
+        #endif
+
+        glfwSwapInterval(appConfig.isVSyncEnabled());
+    }
+
+    mImpl->displayListManager.reset(new priv::DisplayListManager(appConfig.getRenderCacheBudget(),
+            appConfig.getRenderCacheEvictionFrames(), appConfig.getRenderCacheFolderPath()));
 
     mImpl->font.reset(new Font(appConfig.getDefaultFontName(), appConfig.getDefaultFontFilePath()));
     mImpl->node = Node::create();
+    priv::NodeUpdateManager::setNumThreads(appConfig.getNumUpdateThreads());
+    priv::RenderCacheRecorder::setNumThreads(appConfig.getNumRenderCacheThreads());
+    priv::ImageManager::setNumThreads(appConfig.getNumImageLoadThreads());
+    priv::ImageManager::setUploadBudget(appConfig.getImageUploadBudget());
+    priv::ImageManager::setAtlasEnabled(appConfig.isImageAtlasEnabled());
 
     TRJ_ASSERT(isPositive(getScreenHeight()), "Invalid logical screen height");
 
-    glfwSetTime(0);
+    if(mImpl->headless)
+    {
+        mImpl->headlessStartTime = std::chrono::steady_clock::now();
+    }
+    else
+    {
+        glfwSetTime(0);
+    }
+
     update();
 }
 
@@ -452,24 +565,29 @@ Application::~Application()
         mImpl->node.reset();
         mImpl->font.reset();
 
-        #ifdef TRJ_CFG_ENABLE_RENDER_CACHE
-            mImpl->displayListManager.reset();
-        #endif
+        mImpl->displayListManager.reset();
 
         mImpl->mouse.reset();
         mImpl->keyboard.reset();
 
         if(mImpl->context)
         {
-            #if defined(TRJ_CFG_GLES3)
-                nvgDeleteGLES3(mImpl->context);
-            #elif defined(TRJ_CFG_GL3)
-                nvgDeleteGL3(mImpl->context);
-            #elif defined(TRJ_CFG_GLES2)
-                nvgDeleteGLES2(mImpl->context);
-            #else
-                nvgDeleteGL2(mImpl->context);
-            #endif
+            if(mImpl->headless)
+            {
+                nvgDeleteNull(mImpl->context);
+            }
+            else
+            {
+                #if defined(TRJ_CFG_GLES3)
+                    nvgDeleteGLES3(mImpl->context);
+                #elif defined(TRJ_CFG_GL3)
+                    nvgDeleteGL3(mImpl->context);
+                #elif defined(TRJ_CFG_GLES2)
+                    nvgDeleteGLES2(mImpl->context);
+                #else
+                    nvgDeleteGL2(mImpl->context);
+                #endif
+            }
 
             mImpl->context = nullptr;
         }
@@ -566,6 +684,13 @@ int Application::getRealScreenHeight() noexcept
 
 double Application::getElapsedTime()
 {
+    auto impl = smInstance->mImpl;
+    if(impl->headless)
+    {
+        std::chrono::duration<double> elapsedTime = std::chrono::steady_clock::now() - impl->headlessStartTime;
+        return elapsedTime.count();
+    }
+
     return glfwGetTime();
 }
 
@@ -574,6 +699,11 @@ float Application::getFrameTime() noexcept
     return smInstance->mImpl->frameTime;
 }
 
+float Application::getUpdateTime() noexcept
+{
+    return smInstance->mImpl->updateTime;
+}
+
 float Application::getFpsLimit() noexcept
 {
     double fpsLimitWaitTime = smInstance->mImpl->fpsLimitWaitTime;
@@ -592,14 +722,86 @@ void Application::setFpsLimit(float fpsLimit) noexcept
     smInstance->mImpl->fpsLimitWaitTime = 1 / fpsLimit;
 }
 
+int Application::getNumUpdateThreads() noexcept
+{
+    return priv::NodeUpdateManager::getNumThreads();
+}
+
+void Application::setNumUpdateThreads(int numThreads)
+{
+    TRJ_ASSERT(numThreads > 0, "Invalid num threads");
+
+    priv::NodeUpdateManager::setNumThreads(numThreads);
+}
+
+int Application::getNumRenderCacheThreads() noexcept
+{
+    return priv::RenderCacheRecorder::getNumThreads();
+}
+
+void Application::setNumRenderCacheThreads(int numThreads)
+{
+    TRJ_ASSERT(numThreads > 0, "Invalid num threads");
+
+    priv::RenderCacheRecorder::setNumThreads(numThreads);
+}
+
+int Application::getNumImageLoadThreads() noexcept
+{
+    return priv::ImageManager::getNumThreads();
+}
+
+void Application::setNumImageLoadThreads(int numThreads)
+{
+    TRJ_ASSERT(numThreads > 0, "Invalid num threads");
+
+    priv::ImageManager::setNumThreads(numThreads);
+}
+
+std::size_t Application::getImageUploadBudget() noexcept
+{
+    return priv::ImageManager::getUploadBudget();
+}
+
+void Application::setImageUploadBudget(std::size_t budget)
+{
+    TRJ_ASSERT(budget > 0, "Invalid image upload budget");
+
+    priv::ImageManager::setUploadBudget(budget);
+}
+
+bool Application::isImageAtlasEnabled() noexcept
+{
+    return priv::ImageManager::isAtlasEnabled();
+}
+
+void Application::setImageAtlasEnabled(bool enabled) noexcept
+{
+    priv::ImageManager::setAtlasEnabled(enabled);
+}
+
 bool Application::isClosed()
 {
-    return glfwWindowShouldClose(smInstance->mImpl->window);
+    auto impl = smInstance->mImpl;
+    if(impl->headless)
+    {
+        return impl->headlessClosed;
+    }
+
+    return glfwWindowShouldClose(impl->window);
 }
 
 void Application::setClosed(bool closed)
 {
-    glfwSetWindowShouldClose(smInstance->mImpl->window, closed);
+    auto impl = smInstance->mImpl;
+    if(impl->headless)
+    {
+        impl->headlessClosed = closed;
+    }
+    else
+    {
+        glfwSetWindowShouldClose(impl->window, closed);
+    }
 }
 
 bool Application::showBoundingBoxes() noexcept
@@ -612,6 +814,71 @@ void Application::setShowBoundingBoxes(bool show) noexcept
     smInstance->mImpl->showBoundingBoxes = show;
 }
 
+bool Application::isHeadless() noexcept
+{
+    return smInstance->mImpl->headless;
+}
+
+bool Application::isStreamingBuffersEnabled() noexcept
+{
+    return smInstance->mImpl->streamingBuffers;
+}
+
+void Application::setStreamingBuffersEnabled(bool enabled) noexcept
+{
+    #ifdef TRJ_CFG_GL3
+        auto impl = smInstance->mImpl;
+        if(! impl->headless)
+        {
+            nvglSetStreamingBuffers(impl->context, enabled);
+            impl->streamingBuffers = enabled;
+        }
+    #else
+        (void) enabled;
+    #endif
+}
+
+RenderStats Application::getRenderStats() noexcept
+{
+    auto impl = smInstance->mImpl;
+    if(! impl->headless)
+    {
+        NVGglStats stats = nvglFrameStats(impl->context);
+        return RenderStats(stats.fills, stats.strokes, stats.triangles, stats.paths, stats.vertices,
+                stats.mergedCalls, stats.sortedCalls, stats.draws);
+    }
+
+    NVGnullStats stats = nvgNullFrameStats(impl->context);
+    return RenderStats(stats.fills, stats.strokes, stats.triangles, stats.paths, stats.vertices, 0, 0, 0);
+}
+
+std::size_t Application::getRenderCacheBudget() noexcept
+{
+    return priv::DisplayListManager::getBudget();
+}
+
+void Application::setRenderCacheBudget(std::size_t budget) noexcept
+{
+    priv::DisplayListManager::setBudget(budget);
+}
+
+int Application::getRenderCacheEvictionFrames() noexcept
+{
+    return priv::DisplayListManager::getEvictionFrames();
+}
+
+void Application::setRenderCacheEvictionFrames(int evictionFrames)
+{
+    TRJ_ASSERT(evictionFrames >= 0, "Invalid render cache eviction frames");
+
+    priv::DisplayListManager::setEvictionFrames(evictionFrames);
+}
+
+RenderCacheStats Application::getRenderCacheStats() noexcept
+{
+    return priv::DisplayListManager::getStats();
+}
+
 NVGcontext& Application::getNanoVgContext() noexcept
 {
     return *(smInstance->mImpl->context);
@@ -635,30 +902,47 @@ void Application::update()
         impl->frameTime = std::max(time - impl->previousTime, (double) kEpsilon);
     }
 
-    impl->node->update(impl->frameTime, impl->frameTime, false);
+    priv::NodeUpdateManager::updateNodes(*(impl->node), impl->frameTime);
+    impl->updateTime = getElapsedTime() - time;
     impl->previousTime = time;
-
-    glfwGetWindowSize(impl->window, &(impl->windowWidth), &(impl->windowHeight));
+    priv::ImageManager::update();
 
     int frameBufferWidth, frameBufferHeight;
-    glfwGetFramebufferSize(impl->window, &frameBufferWidth, &frameBufferHeight);
-    impl->pixelAspectRatio = frameBufferWidth / (float) impl->windowWidth;
+    if(impl->headless)
+    {
+        frameBufferWidth = impl->windowWidth;
+        frameBufferHeight = impl->windowHeight;
+    }
+    else
+    {
+        glfwGetWindowSize(impl->window, &(impl->windowWidth), &(impl->windowHeight));
+        glfwGetFramebufferSize(impl->window, &frameBufferWidth, &frameBufferHeight);
+        impl->pixelAspectRatio = frameBufferWidth / (float) impl->windowWidth;
+    }
 
     smInstance->render(*(impl->node), frameBufferWidth, frameBufferHeight, impl->windowWidth,
             impl->windowHeight, impl->backgroundColor, impl->showPerformanceGraphs);
 
     impl->frameTimeGraph.update(impl->frameTime);
     impl->cpuGraph.update(getElapsedTime() - impl->cpuPreviousTime - sleepTime);
+    impl->mergedCallsGraph.update(getRenderStats().getMergeRate() * 100);
 
-    glfwSwapBuffers(impl->window);
+    if(! impl->headless)
+    {
+        glfwSwapBuffers(impl->window);
+    }
 
     impl->cpuPreviousTime = getElapsedTime();
-    glfwPollEvents();
+
+    if(! impl->headless)
+    {
+        glfwPollEvents();
+    }
 
     impl->keyboard->update();
     impl->mouse->update(impl->window, impl->windowWidth, impl->windowHeight, getScreenHeight());
 
-    if(glfwWindowShouldClose(impl->window))
+    if(isClosed())
     {
         throw ApplicationClosedException(__FILE__, __LINE__);
     }
@@ -678,5 +962,12 @@ void Application::update(float seconds)
     }
 }
 
+void Application::updateNodes(float frameTime)
+{
+    TRJ_ASSERT(isPositive(frameTime), "Invalid frame time");
+
+    priv::NodeUpdateManager::updateNodes(*(smInstance->mImpl->node), frameTime);
+}
+
 }
 
@@ -25,6 +25,7 @@ CallBackAction::CallBackAction(std::function<void()> function) :
     mFunction(std::move(function)),
     mCalled(false)
 {
+    mCallBacks = true;
 }
 
 bool CallBackAction::run(float, Node&)
@@ -18,6 +18,8 @@
 
 #include "trjcolor.h"
 
+#include <algorithm>
+
 #include "nanovg.h"
 #include "trjdebug.h"
 
@@ -70,6 +72,46 @@ std::pair<Color, float> Color::getBlendResult(
     return result;
 }
 
+std::pair<Color, float> Color::getBlendTint(
+        const std::vector<std::pair<Color, float>>& blendColors) noexcept
+{
+    int numColors = blendColors.size();
+    if(numColors <= 1)
+    {
+        return numColors ? blendColors.front() : std::make_pair(Color(), 0.0f);
+    }
+
+    // Blending a color with each blend color in order is the same as blending it once with the
+    // weighted average of the blend colors:
+    float inverseFactor = 1;
+    float red = 0;
+    float green = 0;
+    float blue = 0;
+    float alpha = 0;
+
+    for(const std::pair<Color, float>& blendColor : blendColors)
+    {
+        const Color& color = blendColor.first;
+        float factor = blendColor.second;
+        float blendInverseFactor = 1 - factor;
+        inverseFactor *= blendInverseFactor;
+        red = (red * blendInverseFactor) + (color.mRed * factor);
+        green = (green * blendInverseFactor) + (color.mGreen * factor);
+        blue = (blue * blendInverseFactor) + (color.mBlue * factor);
+        alpha = (alpha * blendInverseFactor) + (color.mAlpha * factor);
+    }
+
+    float factor = 1 - inverseFactor;
+    if(factor <= 0)
+    {
+        return std::make_pair(Color(), 0.0f);
+    }
+
+    auto clamp = [](float value) { return std::min(std::max(value, 0.0f), 1.0f); };
+    return std::make_pair(Color(clamp(red / factor), clamp(green / factor), clamp(blue / factor),
+            clamp(alpha / factor)), factor);
+}
+
 Color::Color(float red, float green, float blue, float alpha) noexcept :
     mRed(red),
     mGreen(green),
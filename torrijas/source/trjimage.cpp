@@ -29,6 +29,12 @@
 namespace trj
 {
 
+Image::Image(int handle) :
+    mHandle(handle)
+{
+    initSize();
+}
+
 void Image::initSize()
 {
     int imageWidth, imageHeight;
@@ -39,13 +45,23 @@ void Image::initSize()
 
 void Image::getSize(int imageHandle, int& imageWidth, int& imageHeight)
 {
-    NVGcontext& nanoVgContext = Application::getNanoVgContext();
-    getSize(nanoVgContext, imageHandle, imageWidth, imageHeight);
+    priv::ImageManager::getImageSize(imageHandle, imageWidth, imageHeight);
+}
+
+void Image::getSize(NVGcontext&, int imageHandle, int& imageWidth, int& imageHeight)
+{
+    // Atlas images have negative handles which NanoVG doesn't know:
+    getSize(imageHandle, imageWidth, imageHeight);
+}
+
+Image Image::loadAsync(const String& filePath, int flags)
+{
+    return Image(priv::ImageManager::addImageAsync(filePath, flags));
 }
 
-void Image::getSize(NVGcontext& nanoVgContext, int imageHandle, int& imageWidth, int& imageHeight)
+Image Image::loadAsync(const File& file, int flags)
 {
-    nvgImageSize(&nanoVgContext, imageHandle, &imageWidth, &imageHeight);
+    return loadAsync(file.getPath(), flags);
 }
 
 Image::Image(const ImageData& imageData, int flags) :
@@ -144,6 +160,16 @@ Image& Image::operator=(Image&& other) noexcept
     return *this;
 }
 
+bool Image::isLoaded() const
+{
+    return mHandle && priv::ImageManager::isImageLoaded(mHandle);
+}
+
+bool Image::isLoadFailed() const
+{
+    return mHandle && priv::ImageManager::isImageLoadFailed(mHandle);
+}
+
 Image::~Image()
 {
     if(mHandle)
@@ -19,6 +19,8 @@
 #include "trjimagedata.h"
 
 #include <stdlib.h>
+#include <fstream>
+#include <vector>
 #include "stb_image.h"
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #include "stb_image_write.h"
@@ -28,6 +30,8 @@
 #include "trjcolor.h"
 #include "trjexception.h"
 #include "trjdebug.h"
+#include "private/trjmappedfile.h"
+#include "private/trjqoi.h"
 
 namespace trj
 {
@@ -67,8 +71,21 @@ ImageData::ImageData(const unsigned char* data, int width, int height) :
 
 ImageData::ImageData(const String& filePath)
 {
-    int numComponents;
-    mData = stbi_load(filePath.getCharArray(), &mWidth, &mHeight, &numComponents, 4);
+    // The file is decoded from its memory map:
+    priv::MappedFile mappedFile(filePath);
+    const unsigned char* fileData = mappedFile.getData();
+    std::size_t fileSize = mappedFile.getSize();
+    if(priv::qoi::isQoi(fileData, fileSize))
+    {
+        mData = priv::qoi::decode(fileData, fileSize, mWidth, mHeight);
+    }
+    else if(! mappedFile.isEmpty())
+    {
+        int numComponents;
+        mData = stbi_load_from_memory(fileData, static_cast<int>(fileSize), &mWidth, &mHeight, &numComponents,
+                4);
+    }
+
     if(! mData)
     {
         throw Exception(__FILE__, __LINE__, "Image file load failed");
@@ -85,9 +102,17 @@ ImageData::ImageData(const unsigned char* compressedData, int compressedDataSize
     TRJ_ASSERT(compressedData, "Data is null");
     TRJ_ASSERT(compressedDataSize > 0, "Invalid data size");
 
-    int numComponents;
-    mData = stbi_load_from_memory(compressedData, compressedDataSize, &mWidth, &mHeight,
-            &numComponents, 4);
+    if(priv::qoi::isQoi(compressedData, compressedDataSize))
+    {
+        mData = priv::qoi::decode(compressedData, compressedDataSize, mWidth, mHeight);
+    }
+    else
+    {
+        int numComponents;
+        mData = stbi_load_from_memory(compressedData, compressedDataSize, &mWidth, &mHeight,
+                &numComponents, 4);
+    }
+
     if(! mData)
     {
         throw Exception(__FILE__, __LINE__, "Image data load failed");
@@ -173,6 +198,17 @@ void ImageData::save(const String& filePath, FileFormat format) const
     case FileFormat::TGA:
         success = stbi_write_tga(filePath.getCharArray(), mWidth, mHeight, 4, mData);
         break;
+
+    case FileFormat::QOI:
+    {
+        std::vector<unsigned char> fileData;
+        priv::qoi::encode(mData, mWidth, mHeight, fileData);
+
+        std::ofstream fileStream(filePath.getCharArray(), std::ios::binary | std::ios::trunc);
+        fileStream.write(reinterpret_cast<const char*>(fileData.data()), fileData.size());
+        success = fileStream.good();
+        break;
+    }
     }
 
     if(! success)
@@ -18,9 +18,12 @@
 
 #include "trjimagenode.h"
 
+#include <typeinfo>
 #include "nanovg.h"
 #include "trjimage.h"
 #include "trjrendercontext.h"
+#include "private/trjhash.h"
+#include "private/trjimagemanager.h"
 
 namespace trj
 {
@@ -55,28 +58,61 @@ Rect ImageNode::generateBoundingBox()
     return boundingBox;
 }
 
-void ImageNode::renderItself(RenderContext& renderContext)
+bool ImageNode::renderCacheAvailable(const RenderContext& renderContext) const
+{
+    // Images without shapes are drawn as sprites, which are batched with the next ones and are cheaper to draw
+    // than a render cache:
+    if(mShapeGroups.empty())
+    {
+        return false;
+    }
+
+    // Images loaded asynchronously aren't drawn until they are loaded, so nothing is recorded before:
+    return mImage.isLoaded() && Node::renderCacheAvailable(renderContext);
+}
+
+bool ImageNode::renderCacheBlendable() const
 {
-    NVGcontext& nanoVgContext = renderContext.getNanoVgContext();
-    NVGpaint paint = nvgImagePattern(&nanoVgContext, mImagePatternRect.getX(),
-            mImagePatternRect.getY(), mImagePatternRect.getWidth(), mImagePatternRect.getHeight(),
-            0, mImage.getHandle(), 1);
-    nvgBeginPath(&nanoVgContext);
-    nvgRect(&nanoVgContext, mRect.getX(), mRect.getY(), mRect.getWidth(), mRect.getHeight());
-    nvgFillPaint(&nanoVgContext, paint);
-    nvgFill(&nanoVgContext);
+    return typeid(*this) == typeid(ImageNode);
+}
 
-    if(! renderContext.getBlendColors().empty())
+bool ImageNode::renderCacheConcurrent() const
+{
+    return typeid(*this) == typeid(ImageNode);
+}
+
+priv::Hash ImageNode::generateRenderCacheHash() const
+{
+    priv::Hash hash = Node::generateRenderCacheHash();
+    priv::hashCombine(hash, String("ImageNode"));
+    priv::hashCombine(hash, mImage.getHandle());
+    priv::hashCombine(hash, mRect);
+    priv::hashCombine(hash, mImagePatternRect);
+
+    return hash;
+}
+
+void ImageNode::renderItself(RenderContext& renderContext)
+{
+    if(! mImage.isLoaded())
     {
-        std::pair<Color, float> blendResult = renderContext.getBlendResult();
-        const Color& blendColor = blendResult.first;
-        nvgBeginPath(&nanoVgContext);
-        nvgRect(&nanoVgContext, mRect.getX(), mRect.getY(), mRect.getWidth(), mRect.getHeight());
-        nvgFillColor(&nanoVgContext, nvgRGBAf(blendColor.getRed(), blendColor.getGreen(),
-                blendColor.getBlue(), blendColor.getAlpha() * blendResult.second));
-        nvgFill(&nanoVgContext);
+        Node::renderItself(renderContext);
+        return;
     }
 
+    // Atlas images are drawn from their page:
+    Rect textureRect;
+    int texture = priv::ImageManager::getTexture(mImage.getHandle(), mImagePatternRect, 0, textureRect);
+    float s0 = (mRect.getX() - textureRect.getX()) / textureRect.getWidth();
+    float t0 = (mRect.getY() - textureRect.getY()) / textureRect.getHeight();
+    float s1 = (mRect.getX() + mRect.getWidth() - textureRect.getX()) / textureRect.getWidth();
+    float t1 = (mRect.getY() + mRect.getHeight() - textureRect.getY()) / textureRect.getHeight();
+
+    // Consecutive sprites of the same texture are drawn with one call, and the blend colors are applied
+    // by the NanoVG global tint:
+    nvgSprite(&renderContext.getNanoVgContext(), texture, mRect.getX(), mRect.getY(), mRect.getWidth(),
+            mRect.getHeight(), s0, t0, s1, t1, nvgRGBAf(0, 0, 0, 0), 0, 1);
+
     Node::renderItself(renderContext);
 }
 
@@ -54,12 +54,13 @@ Keyboard* Keyboard::smInstance = nullptr;
 
 Keyboard::Keyboard(void* window)
 {
-    TRJ_ASSERT(window, "Window is null");
-
     smInstance = this;
 
-    GLFWwindow* glfwWindow = static_cast<GLFWwindow*>(window);
-    glfwSetKeyCallback(glfwWindow, glfwKeyCallback);
+    if(window)
+    {
+        GLFWwindow* glfwWindow = static_cast<GLFWwindow*>(window);
+        glfwSetKeyCallback(glfwWindow, glfwKeyCallback);
+    }
 }
 
 void Keyboard::update()
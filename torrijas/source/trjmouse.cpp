@@ -56,22 +56,21 @@ void Mouse::Button::update(int state)
 
 Mouse::Mouse(void* window)
 {
-    TRJ_ASSERT(window, "Window is null");
-
     smInstance = this;
 
-    GLFWwindow* glfwWindow = static_cast<GLFWwindow*>(window);
-    glfwSetScrollCallback(glfwWindow, glfwScrollCallback);
+    if(window)
+    {
+        GLFWwindow* glfwWindow = static_cast<GLFWwindow*>(window);
+        glfwSetScrollCallback(glfwWindow, glfwScrollCallback);
+    }
 }
 
 void Mouse::update(void* window, int windowWidth, int windowHeight, int logicalWindowHeight)
 {
-    if(windowWidth <= 0 || windowHeight <= 0)
+    if(! window || windowWidth <= 0 || windowHeight <= 0)
     {
         return;
     }
-
-    TRJ_ASSERT(window, "Window is null");
     TRJ_ASSERT(logicalWindowHeight > 0, "Invalid logical window height");
 
     GLFWwindow* glfwWindow = static_cast<GLFWwindow*>(window);
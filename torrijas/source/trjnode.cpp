@@ -19,18 +19,35 @@
 #include "trjnode.h"
 
 #include <algorithm>
+#include <cmath>
+#include <typeinfo>
 #include "nanovg.h"
 #include "trjapplication.h"
 #include "trjrendercontext.h"
 #include "trjdebug.h"
+#include "private/trjspatialindex.h"
+#include "private/trjnodeupdatemanager.h"
+#include "private/trjhash.h"
 
 #ifdef TRJ_CFG_ENABLE_RENDER_CACHE
     #include "private/trjdisplaylistmanager.h"
+    #include "private/trjimagemanager.h"
 #endif
 
 namespace trj
 {
 
+#ifdef TRJ_CFG_ENABLE_RENDER_CACHE
+    namespace
+    {
+        // Returns the nearest power of sqrt(2) scale:
+        float getLodScale(float scale) noexcept
+        {
+            return std::exp2(std::round(std::log2(scale) * 2) / 2);
+        }
+    }
+#endif
+
 Node::Node(const Node& other) :
     mPosition(other.mPosition),
     mBlendColor(other.mBlendColor),
@@ -38,6 +55,8 @@ Node::Node(const Node& other) :
     mBoundingBox(other.mBoundingBox),
     mFinalBoundingBox(other.mFinalBoundingBox),
     mTag(other.mTag),
+    mRenderCacheHash(other.mRenderCacheHash),
+    mRenderCacheCheckHash(other.mRenderCacheCheckHash),
     mRotationAngle(other.mRotationAngle),
     mSkewXAngle(other.mSkewXAngle),
     mSkewYAngle(other.mSkewYAngle),
@@ -46,23 +65,23 @@ Node::Node(const Node& other) :
     mOpacity(other.mOpacity),
     mBlendColorFactor(other.mBlendColorFactor),
     mActionsSpeed(other.mActionsSpeed),
-    mFinalScaleX(other.mFinalScaleX),
-    mFinalScaleY(other.mFinalScaleY),
     mVisible(other.mVisible),
     mHidden(other.mHidden),
     mScaleWithScreenAspectRatio(other.mScaleWithScreenAspectRatio),
     mFlipX(other.mFlipX),
     mFlipY(other.mFlipY),
     mActionsPaused(other.mActionsPaused),
+    mUpdateEnabled(other.mUpdateEnabled),
     mRenderOffScreen(other.mRenderOffScreen),
+    mRenderInstanced(other.mRenderInstanced),
     mInvalidateBoundingBox(other.mInvalidateBoundingBox),
-    mInvalidateRenderCache(other.mInvalidateRenderCache || other.mRenderCache),
+    mInvalidateRenderCache(other.mInvalidateRenderCache),
     mInvalidateTransform(other.mInvalidateTransform),
     mInvalidateHidden(other.mInvalidateHidden),
     mIsOnScreen(other.mIsOnScreen),
     mShapeGroups(other.mShapeGroups),
     mTransform(other.mTransform),
-    mFinalTransform(other.mFinalTransform)
+    mWorldTransform(other.mWorldTransform)
 {
     int numActions = other.mActions.size();
     if(numActions)
@@ -87,6 +106,24 @@ Node::Node(const Node& other) :
             mChildren.push_back(childClone.release());
         }
     }
+
+    if(other.mSpatialIndex)
+    {
+        setSpatialIndexEnabled(true);
+    }
+
+    #ifdef TRJ_CFG_ENABLE_RENDER_CACHE
+        // The clone shares the render cache of the original node until one of them must record it again.
+        // Without one, the clone records its own render cache:
+        auto renderCache = static_cast<priv::RenderCache*>(other.mRenderCache);
+        if(renderCache && ! mInvalidateRenderCache)
+        {
+            priv::DisplayListManager::share(*renderCache);
+            mRenderCache = renderCache;
+        }
+    #endif
+
+    refreshUpdateEntry();
 }
 
 Rect Node::generateBoundingBox()
@@ -105,9 +142,33 @@ void Node::updateItself(float)
 {
 }
 
-bool Node::renderCacheAvailable(const RenderContext& renderContext) const
+bool Node::renderCacheAvailable(const RenderContext&) const
+{
+    return true;
+}
+
+bool Node::renderCacheBlendable() const
+{
+    // The hash only covers the shape groups, which is all that Node::renderItself renders:
+    return typeid(*this) == typeid(Node);
+}
+
+bool Node::renderCacheConcurrent() const
+{
+    return typeid(*this) == typeid(Node);
+}
+
+priv::Hash Node::generateRenderCacheHash() const
 {
-    return ! mFlipX && ! mFlipY && ! renderContext.isScissorEnabled();
+    priv::Hash hash;
+    priv::hashCombine(hash, mShapeGroups.size());
+
+    for(const ShapeGroup& shapeGroup : mShapeGroups)
+    {
+        priv::hashCombine(hash, shapeGroup.getHash());
+    }
+
+    return hash;
 }
 
 void Node::renderItself(RenderContext& renderContext)
@@ -124,6 +185,7 @@ void Node::addActionImpl(Ptr<Action>&& action)
     TRJ_ASSERT(! mActionsRunning, "Actions can't be modified while they are running");
 
     mActions.push_back(std::move(action));
+    refreshUpdateEntry();
 }
 
 void Node::addChildImpl(Ptr<Node>&& child)
@@ -132,7 +194,15 @@ void Node::addChildImpl(Ptr<Node>&& child)
 
     Node* childPtr = child.release();
     childPtr->mParent = this;
+    childPtr->invalidateWorldTransform();
     mChildren.push_back(childPtr);
+
+    if(mSpatialIndex)
+    {
+        addSpatialIndexItem(*childPtr, mChildren.size() - 1);
+    }
+
+    invalidateSubtreeBoundingBox();
 }
 
 void Node::insertChildImpl(int index, Ptr<Node>&& child)
@@ -142,7 +212,20 @@ void Node::insertChildImpl(int index, Ptr<Node>&& child)
 
     Node* childPtr = child.release();
     childPtr->mParent = this;
+    childPtr->invalidateWorldTransform();
     mChildren.insert(mChildren.begin() + index, childPtr);
+
+    if(mSpatialIndex)
+    {
+        addSpatialIndexItem(*childPtr, index);
+
+        for(int childIndex = 0, limit = mChildren.size(); childIndex < limit; ++childIndex)
+        {
+            mSpatialIndex->setOrder(mChildren[childIndex]->mSpatialIndexItem, childIndex);
+        }
+    }
+
+    invalidateSubtreeBoundingBox();
 }
 
 void Node::setChildImpl(int index, Ptr<Node>&& child) noexcept
@@ -152,17 +235,29 @@ void Node::setChildImpl(int index, Ptr<Node>&& child) noexcept
 
     Node* childPtr = child.release();
     childPtr->mParent = this;
+    childPtr->invalidateWorldTransform();
+
+    if(mSpatialIndex)
+    {
+        removeSpatialIndexItem(const_cast<Node&>(*mChildren[index]));
+        addSpatialIndexItem(*childPtr, index);
+    }
+
     mChildren[index] = childPtr;
+    invalidateSubtreeBoundingBox();
 }
 
 void Node::update(float elapsedTime, float actionsElapsedTime, bool actionsPaused)
 {
-    actionsPaused |= mActionsPaused;
+    updateActions(actionsElapsedTime, actionsPaused);
+    commitUpdate(elapsedTime);
+}
 
+void Node::updateActions(float actionsElapsedTime, bool actionsPaused)
+{
     if(! actionsPaused)
     {
         mActionsRunning = true;
-        actionsElapsedTime *= mActionsSpeed;
 
         for(auto it = mActions.begin(), end = mActions.end(); it != end; )
         {
@@ -180,23 +275,59 @@ void Node::update(float elapsedTime, float actionsElapsedTime, bool actionsPause
 
         mActionsRunning = false;
     }
+}
 
-    updateItself(elapsedTime);
+void Node::commitUpdate(float elapsedTime)
+{
+    if(mUpdateEnabled)
+    {
+        updateItself(elapsedTime);
+    }
 
-    for(const Node* child : mChildren)
+    if(mActions.empty())
     {
-        const_cast<Node*>(child)->update(elapsedTime, actionsElapsedTime, actionsPaused);
+        refreshUpdateEntry();
     }
 }
 
-void Node::render(RenderContext& renderContext)
+void Node::refreshUpdateEntry()
 {
-    bool oldInvalidateFinalBoundingBoxes = renderContext.invalidateFinalBoundingBoxes();
-    if(oldInvalidateFinalBoundingBoxes)
+    bool updateRequired = mUpdateEnabled || (! mActions.empty() && ! mActionsPaused);
+
+    if(updateRequired)
     {
-        mInvalidateBoundingBox = true;
+        if(mUpdateIndex < 0)
+        {
+            priv::NodeUpdateManager::addNode(*this);
+        }
+    }
+    else if(mUpdateIndex >= 0)
+    {
+        priv::NodeUpdateManager::removeNode(*this);
     }
+}
+
+void Node::checkUpdateEnabled() noexcept
+{
+    // Only GCC can read the address of the updateItself override without calling it:
+    #if defined(TRJ_DEBUG) && defined(__GNUC__) && ! defined(__clang__)
+        #pragma GCC diagnostic push
+        #pragma GCC diagnostic ignored "-Wpmf-conversions"
+        typedef void (*UpdateItselfFunction)(Node*, float);
+        static bool warned = false;
+
+        if(! warned && ! mUpdateEnabled &&
+                (UpdateItselfFunction) (this->*(&Node::updateItself)) != (UpdateItselfFunction) (&Node::updateItself))
+        {
+            warned = true;
+            TRJ_WARNING("updateItself is overridden, but it isn't called until setUpdateEnabled(true) is called");
+        }
+        #pragma GCC diagnostic pop
+    #endif
+}
 
+bool Node::isHidden() noexcept
+{
     if(mInvalidateHidden)
     {
         mHidden = ! mVisible || isPositiveZero(mScaleX) || isPositiveZero(mScaleY) ||
@@ -204,14 +335,33 @@ void Node::render(RenderContext& renderContext)
         mInvalidateHidden = false;
     }
 
-    if(mHidden)
+    return mHidden;
+}
+
+void Node::render(RenderContext& renderContext)
+{
+    #ifdef TRJ_DEBUG
+        checkUpdateEnabled();
+    #endif
+
+    bool oldInvalidateFinalBoundingBoxes = renderContext.invalidateFinalBoundingBoxes();
+    if(mInvalidateFinalBoundingBoxes)
     {
-        if(oldInvalidateFinalBoundingBoxes)
+        renderContext.setInvalidateFinalBoundingBoxes(true);
+        mInvalidateFinalBoundingBoxes = false;
+    }
+
+    if(renderContext.invalidateFinalBoundingBoxes())
+    {
+        mInvalidateBoundingBox = true;
+    }
+
+    if(isHidden())
+    {
+        // The invalidation is delayed until the node is shown again:
+        if(renderContext.invalidateFinalBoundingBoxes())
         {
-            for(const Node* child : mChildren)
-            {
-                const_cast<Node*>(child)->mInvalidateBoundingBox = true;
-            }
+            mInvalidateFinalBoundingBoxes = true;
         }
     }
     else
@@ -221,36 +371,40 @@ void Node::render(RenderContext& renderContext)
         bool oldRenderOffScreen = renderContext.renderOffScreen();
         renderContext.setRenderOffScreen(oldRenderOffScreen || mRenderOffScreen);
 
-        if(mInvalidateTransform || renderContext.windowSizeChanged())
-        {
-            updateTransform(renderContext);
-            renderContext.setInvalidateFinalBoundingBoxes(true);
-        }
-        else
-        {
-            renderContext.setFinalScaleX(renderContext.getFinalScaleX() * mScaleX);
-            renderContext.setFinalScaleY(renderContext.getFinalScaleY() * mScaleY);
-        }
+        // The world transforms pass has already set the final bounding boxes invalidation
+        // of the nodes whose world transform has changed:
+        renderContext.setFinalScaleX(mWorldScaleX);
+        renderContext.setFinalScaleY(mWorldScaleY);
 
         bool invalidateFinalBoundingBoxes = renderContext.invalidateFinalBoundingBoxes();
         bool mustUpdateItself = mIsOnScreen || invalidateFinalBoundingBoxes ||
                 renderContext.renderOffScreen();
-        if(mustUpdateItself || ! mChildren.empty())
+        if(! mChildren.empty() && ! isSubtreeOnScreen(renderContext, renderContext.renderOffScreen()))
+        {
+            // The whole subtree is skipped, so the final bounding boxes invalidation
+            // is delayed until it is rendered again:
+            if(invalidateFinalBoundingBoxes)
+            {
+                mInvalidateFinalBoundingBoxes = true;
+            }
+        }
+        else if(mustUpdateItself || ! mChildren.empty())
         {
+            // The NanoVG state is set only before rendering primitives, so there's no need to
+            // save and restore it for each node:
             NVGcontext& nanoVgContext = renderContext.getNanoVgContext();
-            nvgSave(&nanoVgContext);
+            std::array<float, 6> oldTransform = renderContext.getTransform();
 
             bool oldScissorEnabled = renderContext.isScissorEnabled();
-            if(! mScissorRect.isEmpty())
+            bool scissorEnabled = ! mScissorRect.isEmpty();
+            RenderContext::Scissor oldScissor = renderContext.getScissor();
+            if(scissorEnabled)
             {
-                nvgIntersectScissor(&nanoVgContext, mScissorRect.getX(), mScissorRect.getY(),
-                        mScissorRect.getWidth(), mScissorRect.getHeight());
+                renderContext.intersectScissor(mScissorRect);
                 renderContext.setScissorEnabled(true);
             }
 
-            float* transform = mTransform.data();
-            nvgTransform(&nanoVgContext, transform[0], transform[1], transform[2], transform[3],
-                    transform[4], transform[5]);
+            renderContext.setTransform(mWorldTransform);
 
             float oldOpacity = renderContext.getOpacity();
             float newOpacity = oldOpacity * mOpacity;
@@ -264,81 +418,121 @@ void Node::render(RenderContext& renderContext)
 
             if(invalidateFinalBoundingBoxes)
             {
-                nvgCurrentTransform(&nanoVgContext, mFinalTransform.data());
-                mFinalBoundingBox = getBoundingBox().getTransformed(mFinalTransform);
+                // Some bounding boxes (like text ones) depend on the final transform:
+                renderContext.applyNanoVgState();
+
+                Rect oldBoundingBox = mBoundingBox;
+                if(oldBoundingBox != getBoundingBox())
+                {
+                    invalidateSubtreeBoundingBox();
+                }
+
+                mFinalBoundingBox = mBoundingBox.getTransformed(mWorldTransform);
                 mIsOnScreen = mFinalBoundingBox.isIntersecting(renderContext.getWindowRect());
             }
 
             if(mIsOnScreen || renderContext.renderOffScreen())
             {
+                renderContext.applyNanoVgState();
+
                 #ifdef TRJ_CFG_ENABLE_RENDER_CACHE
                     if(renderCacheAvailable(renderContext))
                     {
                         float finalScaleX = renderContext.getFinalScaleX();
                         float finalScaleY = renderContext.getFinalScaleY();
+                        auto renderCache = static_cast<priv::RenderCache*>(mRenderCache);
+                        bool blendable = renderCacheBlendable();
+
+                        // The scale is animated if it has changed since the last frame:
+                        bool scaleChanged = ! areEquals(mRenderScaleX, finalScaleX) ||
+                                ! areEquals(mRenderScaleY, finalScaleY);
+                        mRenderScaleX = finalScaleX;
+                        mRenderScaleY = finalScaleY;
 
-                        if(mInvalidateRenderCache || ! areEquals(mFinalScaleX, finalScaleX) ||
-                                ! areEquals(mFinalScaleY, finalScaleY))
+                        if(! renderCache || ! renderCache->recorded || mInvalidateRenderCache ||
+                                priv::DisplayListManager::isOutdated(nanoVgContext, *renderCache))
                         {
-                            mFinalScaleX = finalScaleX;
-                            mFinalScaleY = finalScaleY;
-                            mInvalidateRenderCache = false;
+                            // A shared render cache not recorded yet (or evicted) is kept for the other nodes
+                            // if the content of this one has changed:
+                            if(mInvalidateRenderCache && renderCache && renderCache->numReferences > 1)
+                            {
+                                priv::DisplayListManager::push(*renderCache);
+                                mRenderCache = nullptr;
+                            }
 
-                            if(mRenderCache)
+                            mInvalidateRenderCache = false;
+                            releaseLodRenderCaches();
+                            updateRenderCache(renderContext, mRenderCache, finalScaleX, finalScaleY);
+                            renderCache = static_cast<priv::RenderCache*>(mRenderCache);
+                        }
+                        else if(! areEquals(renderCache->scaleX, finalScaleX) ||
+                                ! areEquals(renderCache->scaleY, finalScaleY))
+                        {
+                            // While the scale is animated the nearest scale bucket is drawn instead,
+                            // and the exact scale is recorded when the animation settles:
+                            if(scaleChanged)
                             {
-                                nvgResetDisplayList(static_cast<NVGdisplayList*>(mRenderCache));
+                                renderCache = static_cast<priv::RenderCache*>(
+                                        getLodRenderCache(renderContext, finalScaleX, finalScaleY));
                             }
                             else
                             {
-                                mRenderCache = &(priv::DisplayListManager::pull());
+                                updateRenderCache(renderContext, mRenderCache, finalScaleX, finalScaleY);
+                                renderCache = static_cast<priv::RenderCache*>(mRenderCache);
                             }
+                        }
 
-                            nvgSave(&nanoVgContext);
-                            nvgResetTransform(&nanoVgContext);
-                            nvgScale(&nanoVgContext, finalScaleX, finalScaleY);
-                            nvgBindDisplayList(&nanoVgContext, static_cast<NVGdisplayList*>(mRenderCache));
-                            renderItself(renderContext);
-                            nvgBindDisplayList(&nanoVgContext, nullptr);
-                            nvgRestore(&nanoVgContext);
+                        // Blendable render caches are tinted when they are drawn, the other ones have the
+                        // blend colors applied when they are recorded:
+                        if(! blendable)
+                        {
+                            nvgGlobalTint(&nanoVgContext, nvgRGBAf(0, 0, 0, 0), 0);
                         }
 
-                        nvgSave(&nanoVgContext);
-                        nvgScale(&nanoVgContext, 1 / finalScaleX, 1 / finalScaleY);
-                        nvgGlobalAlpha(&nanoVgContext, newOpacity);
-                        nvgDrawDisplayList(&nanoVgContext, static_cast<NVGdisplayList*>(mRenderCache));
-                        nvgRestore(&nanoVgContext);
+                        priv::DisplayListManager::drawn(*renderCache);
+
+                        // The render cache can be recorded with a slightly different scale:
+                        nvgScale(&nanoVgContext, 1 / renderCache->scaleX, 1 / renderCache->scaleY);
+                        if(mRenderInstanced)
+                        {
+                            nvgDrawDisplayListInstance(&nanoVgContext, renderCache->displayList);
+                        }
+                        else
+                        {
+                            nvgDrawDisplayList(&nanoVgContext, renderCache->displayList);
+                        }
                     }
                     else
                     {
                         releaseRenderCache();
-
-                        nvgGlobalAlpha(&nanoVgContext, newOpacity);
                         renderItself(renderContext);
                     }
                 #else
-                    nvgGlobalAlpha(&nanoVgContext, newOpacity);
                     renderItself(renderContext);
                 #endif
 
                 if(renderContext.showBoundingBoxes() && ! mFinalBoundingBox.isEmpty())
                 {
-                    nvgSave(&nanoVgContext);
                     nvgResetTransform(&nanoVgContext);
+                    nvgGlobalTint(&nanoVgContext, nvgRGBAf(0, 0, 0, 0), 0);
 
                     nvgBeginPath(&nanoVgContext);
                     nvgRect(&nanoVgContext, mFinalBoundingBox.getX(), mFinalBoundingBox.getY(),
                             mFinalBoundingBox.getWidth(), mFinalBoundingBox.getHeight());
                     nvgStrokeWidth(&nanoVgContext, 1);
+                    nvgLineCap(&nanoVgContext, NVG_BUTT);
+                    nvgLineJoin(&nanoVgContext, NVG_MITER);
                     nvgStrokeColor(&nanoVgContext, nvgRGBAf(0, 0, 0, 0.5));
                     nvgStroke(&nanoVgContext);
-
-                    nvgRestore(&nanoVgContext);
                 }
             }
 
-            for(const Node* child : mChildren)
+            renderChildren(renderContext);
+
+            renderContext.setTransform(oldTransform);
+            if(scissorEnabled)
             {
-                const_cast<Node*>(child)->render(renderContext);
+                renderContext.setScissor(oldScissor);
             }
 
             renderContext.setScissorEnabled(oldScissorEnabled);
@@ -347,8 +541,6 @@ void Node::render(RenderContext& renderContext)
             {
                 renderContext.popBlendColor();
             }
-
-            nvgRestore(&nanoVgContext);
         }
 
         renderContext.setFinalScaleX(oldFinalScaleX);
@@ -359,85 +551,524 @@ void Node::render(RenderContext& renderContext)
     renderContext.setInvalidateFinalBoundingBoxes(oldInvalidateFinalBoundingBoxes);
 }
 
-void Node::updateTransform(RenderContext& renderContext)
+void Node::renderChildren(RenderContext& renderContext)
 {
-    float* transform = mTransform.data();
-    nvgTransformIdentity(transform);
-    mInvalidateTransform = false;
+    if(! mSpatialIndex)
+    {
+        for(const Node* child : mChildren)
+        {
+            const_cast<Node*>(child)->render(renderContext);
+        }
+
+        return;
+    }
 
-    if(mFlipX)
+    updateSpatialIndex(renderContext.getAspectRatio());
+
+    const std::array<float, 6>& transform = renderContext.getTransform();
+    std::array<float, 6> inverseTransform;
+
+    // Children skipped in a frame don't see the final bounding boxes invalidation,
+    // so they are invalidated the next time they are rendered:
+    priv::SpatialIndex& spatialIndex = *mSpatialIndex;
+    bool oldInvalidateFinalBoundingBoxes = renderContext.invalidateFinalBoundingBoxes();
+    auto renderChild = [&](Node& child)
     {
-        if(mFlipY)
+        unsigned int stamp = spatialIndex.getStamp();
+        if(child.mSpatialIndexStamp != stamp)
         {
-            const float otherTransform[6] = { -1, 0, 0, -1, 0, 0 };
-            nvgTransformPremultiply(transform, otherTransform);
+            child.mSpatialIndexStamp = stamp;
+            renderContext.setInvalidateFinalBoundingBoxes(true);
+            child.render(renderContext);
+            renderContext.setInvalidateFinalBoundingBoxes(oldInvalidateFinalBoundingBoxes);
         }
         else
         {
-            const float otherTransform[6] = { -1, 0, 0, 1, 0, 0 };
-            nvgTransformPremultiply(transform, otherTransform);
+            child.render(renderContext);
+        }
+    };
+
+    if(renderContext.renderOffScreen() || ! nvgTransformInverse(inverseTransform.data(), transform.data()))
+    {
+        for(const Node* child : mChildren)
+        {
+            renderChild(const_cast<Node&>(*child));
         }
     }
-    else if(mFlipY)
+    else
     {
-        const float otherTransform[6] = { 1, 0, 0, -1, 0, 0 };
-        nvgTransformPremultiply(transform, otherTransform);
+        if(oldInvalidateFinalBoundingBoxes)
+        {
+            spatialIndex.increaseStamp();
+        }
+
+        Rect windowRect = renderContext.getWindowRect().getTransformed(inverseTransform);
+
+        for(Node* child : spatialIndex.query(windowRect))
+        {
+            renderChild(*child);
+        }
     }
+}
 
-    float otherTransform[6];
-    if(! isZero(mPosition.getX()) || ! isZero(mPosition.getY()))
+void Node::addDirtySpatialIndexItem() noexcept
+{
+    mSpatialIndexItemDirty = true;
+    mParent->mSpatialIndex->addDirtyNode(*this);
+}
+
+void Node::addSpatialIndexItem(Node& child, int order)
+{
+    child.mSpatialIndexItem = mSpatialIndex->add(child, order);
+    child.mSpatialIndexStamp = 0;
+    child.mSpatialIndexItemDirty = true;
+    mSpatialIndex->addDirtyNode(child);
+}
+
+void Node::removeSpatialIndexItem(Node& child) noexcept
+{
+    if(child.mSpatialIndexItemDirty)
+    {
+        mSpatialIndex->removeDirtyNode(child);
+        child.mSpatialIndexItemDirty = false;
+    }
+
+    mSpatialIndex->remove(child.mSpatialIndexItem);
+    child.mSpatialIndexItem = -1;
+}
+
+void Node::updateSpatialIndex(float aspectRatio)
+{
+    priv::SpatialIndex& spatialIndex = *mSpatialIndex;
+
+    if(! areEquals(spatialIndex.getAspectRatio(), aspectRatio))
+    {
+        spatialIndex.setAspectRatio(aspectRatio);
+
+        for(const Node* constChild : mChildren)
+        {
+            Node* child = const_cast<Node*>(constChild);
+            child->mInvalidateTransform = true;
+
+            if(! child->mSpatialIndexItemDirty)
+            {
+                child->mSpatialIndexItemDirty = true;
+                spatialIndex.addDirtyNode(*child);
+            }
+        }
+    }
+
+    const std::vector<Node*>& dirtyChildren = spatialIndex.getDirtyNodes();
+    if(dirtyChildren.empty())
     {
-        nvgTransformTranslate(otherTransform, mPosition.getX(), mPosition.getY());
-        nvgTransformPremultiply(transform, otherTransform);
+        return;
     }
 
+    for(Node* child : dirtyChildren)
+    {
+        child->mSpatialIndexItemDirty = false;
+
+        const Rect& subtreeBoundingBox = child->getSubtreeBoundingBox(aspectRatio);
+        if(child->mSubtreeUnbounded)
+        {
+            spatialIndex.setUnbounded(child->mSpatialIndexItem);
+        }
+        else
+        {
+            const std::array<float, 6>& childTransform = child->getTransform(aspectRatio);
+            spatialIndex.setBounds(child->mSpatialIndexItem, subtreeBoundingBox.getTransformed(childTransform));
+        }
+    }
+
+    spatialIndex.clearDirtyNodes();
+}
+
+const Rect& Node::getSubtreeBoundingBox(float aspectRatio)
+{
+    if(mInvalidateSubtreeBoundingBox || ! areEquals(mSubtreeAspectRatio, aspectRatio))
+    {
+        mSubtreeBoundingBox = getBoundingBox();
+        mSubtreeUnbounded = mRenderOffScreen;
+
+        if(mSpatialIndex)
+        {
+            updateSpatialIndex(aspectRatio);
+
+            Rect childrenBoundingBox;
+            if(! mSpatialIndex->getBounds(childrenBoundingBox))
+            {
+                mSubtreeUnbounded = true;
+            }
+            else if(! childrenBoundingBox.isEmpty())
+            {
+                mSubtreeBoundingBox.join(childrenBoundingBox);
+            }
+        }
+        else
+        {
+            for(const Node* constChild : mChildren)
+            {
+                Node* child = const_cast<Node*>(constChild);
+                const Rect& childBoundingBox = child->getSubtreeBoundingBox(aspectRatio);
+                if(child->mSubtreeUnbounded)
+                {
+                    mSubtreeUnbounded = true;
+                }
+                else if(! childBoundingBox.isEmpty())
+                {
+                    const std::array<float, 6>& childTransform = child->getTransform(aspectRatio);
+                    Rect transformedBoundingBox = childBoundingBox.getTransformed(childTransform);
+                    if(! transformedBoundingBox.isEmpty())
+                    {
+                        mSubtreeBoundingBox.join(transformedBoundingBox);
+                    }
+                }
+            }
+        }
+
+        mSubtreeAspectRatio = aspectRatio;
+        mInvalidateSubtreeBoundingBox = false;
+    }
+
+    return mSubtreeBoundingBox;
+}
+
+bool Node::isSubtreeOnScreen(RenderContext& renderContext, bool renderOffScreen)
+{
+    if(renderOffScreen || renderContext.windowSizeChanged())
+    {
+        return true;
+    }
+
+    const Rect& subtreeBoundingBox = getSubtreeBoundingBox(renderContext.getAspectRatio());
+    if(mSubtreeUnbounded)
+    {
+        return true;
+    }
+
+    if(subtreeBoundingBox.isEmpty())
+    {
+        return false;
+    }
+
+    return subtreeBoundingBox.getTransformed(mWorldTransform).isIntersecting(renderContext.getWindowRect());
+}
+
+void Node::generateTransform(float aspectRatio, float* transform) const noexcept
+{
+    // Closed form of flip * translate * scale * rotate * skew x * skew y:
     float scaleX = mScaleX;
     if(mScaleWithScreenAspectRatio)
     {
-        scaleX *= renderContext.getAspectRatio();
+        scaleX *= aspectRatio;
+    }
+
+    float flipX = mFlipX ? -1 : 1;
+    float flipY = mFlipY ? -1 : 1;
+    float tanSkewX = isZero(mSkewXAngle) ? 0 : std::tan(mSkewXAngle);
+    float tanSkewY = isZero(mSkewYAngle) ? 0 : std::tan(mSkewYAngle);
+    float cosAngle = 1;
+    float sinAngle = 0;
+
+    if(! isZero(mRotationAngle))
+    {
+        cosAngle = std::cos(mRotationAngle);
+        sinAngle = std::sin(mRotationAngle);
     }
 
-    if(! areEquals(scaleX, 1) || ! areEquals(mScaleY, 1))
+    float skewXX = 1 + (tanSkewX * tanSkewY);
+    float finalScaleX = flipX * scaleX;
+    float finalScaleY = flipY * mScaleY;
+
+    transform[0] = finalScaleX * ((cosAngle * skewXX) - (sinAngle * tanSkewY));
+    transform[1] = finalScaleY * ((sinAngle * skewXX) + (cosAngle * tanSkewY));
+    transform[2] = finalScaleX * ((cosAngle * tanSkewX) - sinAngle);
+    transform[3] = finalScaleY * ((sinAngle * tanSkewX) + cosAngle);
+    transform[4] = flipX * mPosition.getX();
+    transform[5] = flipY * mPosition.getY();
+}
+
+void Node::updateWorldTransforms(const std::array<float, 6>& parentTransform, float parentScaleX,
+        float parentScaleY, float aspectRatio, bool windowSizeChanged, bool invalidate)
+{
+    invalidate = invalidate || mInvalidateWorldTransform;
+
+    if(invalidate)
     {
-        renderContext.setFinalScaleX(renderContext.getFinalScaleX() * scaleX);
-        renderContext.setFinalScaleY(renderContext.getFinalScaleY() * mScaleY);
+        // Aspect ratio dependent transforms are generated again when the window size changes:
+        if(mInvalidateTransform || windowSizeChanged)
+        {
+            generateTransform(aspectRatio, mTransform.data());
+            mInvalidateTransform = false;
+        }
+
+        float scaleX = mScaleX;
+        if(mScaleWithScreenAspectRatio)
+        {
+            scaleX *= aspectRatio;
+        }
 
-        nvgTransformScale(otherTransform, scaleX, mScaleY);
-        nvgTransformPremultiply(transform, otherTransform);
+        mWorldTransform = parentTransform;
+        nvgTransformPremultiply(mWorldTransform.data(), mTransform.data());
+        mWorldScaleX = parentScaleX * scaleX;
+        mWorldScaleY = parentScaleY * mScaleY;
+        mInvalidateWorldTransform = false;
+        mInvalidateFinalBoundingBoxes = true;
     }
 
-    if(! isZero(mRotationAngle))
+    if(invalidate || mInvalidateDescendantWorldTransforms)
     {
-        nvgTransformRotate(otherTransform, mRotationAngle);
-        nvgTransformPremultiply(transform, otherTransform);
+        for(const Node* child : mChildren)
+        {
+            const_cast<Node*>(child)->updateWorldTransforms(mWorldTransform, mWorldScaleX, mWorldScaleY,
+                    aspectRatio, windowSizeChanged, invalidate);
+        }
+
+        mInvalidateDescendantWorldTransforms = false;
     }
+}
 
-    if(! isZero(mSkewXAngle))
+#ifdef TRJ_CFG_ENABLE_RENDER_CACHE
+
+priv::Hash Node::getRenderCacheHash()
+{
+    if(! mRenderCacheHash)
     {
-        nvgTransformSkewX(otherTransform, mSkewXAngle);
-        nvgTransformPremultiply(transform, otherTransform);
+        priv::Hash hash = generateRenderCacheHash();
+        mRenderCacheHash = hash.value;
+        mRenderCacheCheckHash = hash.check;
     }
 
-    if(! isZero(mSkewYAngle))
+    priv::Hash hash;
+    hash.value = mRenderCacheHash;
+    hash.check = mRenderCacheCheckHash;
+    return hash;
+}
+
+void Node::updateRenderCache(RenderContext& renderContext, void*& renderCache, float scaleX, float scaleY)
+{
+    // Render caches with the blend colors applied can't be shared by content:
+    priv::Hash key;
+    if(renderCacheBlendable())
+    {
+        key = priv::DisplayListManager::getKey(getRenderCacheHash(), scaleX, scaleY);
+    }
+
+    priv::RenderCache* sharedRenderCache = nullptr;
+    if(key.value)
+    {
+        sharedRenderCache = priv::DisplayListManager::find(key);
+        if(sharedRenderCache && priv::DisplayListManager::isOutdated(renderContext.getNanoVgContext(),
+                *sharedRenderCache))
+        {
+            priv::DisplayListManager::push(*sharedRenderCache);
+            sharedRenderCache = nullptr;
+        }
+    }
+
+    if(sharedRenderCache)
+    {
+        if(renderCache)
+        {
+            priv::DisplayListManager::push(*static_cast<priv::RenderCache*>(renderCache));
+        }
+
+        renderCache = sharedRenderCache;
+    }
+    else
     {
-        nvgTransformSkewY(otherTransform, mSkewYAngle);
-        nvgTransformPremultiply(transform, otherTransform);
+        recordRenderCache(renderContext, renderCache, scaleX, scaleY, key);
     }
 }
 
+void* Node::getLodRenderCache(RenderContext& renderContext, float finalScaleX, float finalScaleY)
+{
+    if(void* nearestRenderCache = findLodRenderCache(renderContext.getNanoVgContext(), finalScaleX, finalScaleY))
+    {
+        return nearestRenderCache;
+    }
+
+    // Otherwise the nearest power of sqrt(2) scale is recorded, replacing the oldest one:
+    float lodScaleX = getLodScale(finalScaleX);
+    float lodScaleY = getLodScale(finalScaleY);
+
+    if(mLodRenderCaches[1])
+    {
+        priv::DisplayListManager::push(*static_cast<priv::RenderCache*>(mLodRenderCaches[1]));
+    }
+
+    mLodRenderCaches[1] = mLodRenderCaches[0];
+    mLodRenderCaches[0] = nullptr;
+    updateRenderCache(renderContext, mLodRenderCaches[0], lodScaleX, lodScaleY);
+
+    return mLodRenderCaches[0];
+}
+
+void* Node::findLodRenderCache(NVGcontext& nanoVgContext, float finalScaleX, float finalScaleY)
+{
+    // A render cache is drawn if its scale is less than a quarter of an octave away:
+    void* nearestRenderCache = nullptr;
+    float nearestDistance = 0.25f;
+
+    for(void* renderCache : { mRenderCache, mLodRenderCaches[0], mLodRenderCaches[1] })
+    {
+        auto lodRenderCache = static_cast<priv::RenderCache*>(renderCache);
+        if(lodRenderCache && lodRenderCache->recorded &&
+                ! priv::DisplayListManager::isOutdated(nanoVgContext, *lodRenderCache))
+        {
+            float distance = std::max(std::abs(std::log2(lodRenderCache->scaleX / finalScaleX)),
+                    std::abs(std::log2(lodRenderCache->scaleY / finalScaleY)));
+
+            if(distance <= nearestDistance)
+            {
+                nearestRenderCache = renderCache;
+                nearestDistance = distance;
+            }
+        }
+    }
+
+    return nearestRenderCache;
+}
+
+priv::Hash Node::getPendingRenderCacheKey(RenderContext& renderContext, float finalScaleX,
+        float finalScaleY, float& scaleX, float& scaleY)
+{
+    if(! renderCacheAvailable(renderContext) || ! renderCacheBlendable())
+    {
+        return priv::Hash();
+    }
+
+    // Same steps as render, without modifying the render caches:
+    auto renderCache = static_cast<priv::RenderCache*>(mRenderCache);
+    scaleX = finalScaleX;
+    scaleY = finalScaleY;
+
+    if(renderCache && renderCache->recorded && ! mInvalidateRenderCache)
+    {
+        if(areEquals(renderCache->scaleX, finalScaleX) && areEquals(renderCache->scaleY, finalScaleY))
+        {
+            return priv::Hash();
+        }
+
+        if(! areEquals(mRenderScaleX, finalScaleX) || ! areEquals(mRenderScaleY, finalScaleY))
+        {
+            if(findLodRenderCache(renderContext.getNanoVgContext(), finalScaleX, finalScaleY))
+            {
+                return priv::Hash();
+            }
+
+            scaleX = getLodScale(finalScaleX);
+            scaleY = getLodScale(finalScaleY);
+        }
+    }
+
+    return priv::DisplayListManager::getKey(getRenderCacheHash(), scaleX, scaleY);
+}
+
+void Node::recordRenderCache(RenderContext& renderContext, void*& renderCachePtr, float scaleX, float scaleY,
+        const priv::Hash& key)
+{
+    NVGcontext& nanoVgContext = renderContext.getNanoVgContext();
+    bool blendable = renderCacheBlendable();
+    auto renderCache = static_cast<priv::RenderCache*>(renderCachePtr);
+
+    // A recorded render cache shared with other nodes is kept for them:
+    if(renderCache && renderCache->recorded && (renderCache->numReferences > 1 || renderCache->key))
+    {
+        priv::DisplayListManager::push(*renderCache);
+        renderCache = nullptr;
+    }
+
+    if(renderCache)
+    {
+        priv::DisplayListManager::reset(*renderCache);
+    }
+    else
+    {
+        renderCache = &(priv::DisplayListManager::pull());
+        renderCachePtr = renderCache;
+    }
+
+    renderCache->scaleX = scaleX;
+    renderCache->scaleY = scaleY;
+    renderCache->recorded = true;
+
+    if(key.value)
+    {
+        priv::DisplayListManager::insert(*renderCache, key);
+
+        // Render caches written in previous runs are read instead of recorded:
+        if(priv::DisplayListManager::load(nanoVgContext, *renderCache))
+        {
+            return;
+        }
+    }
+
+    // The opacity and the blend colors (if possible) are applied when the render cache is drawn:
+    std::vector<std::pair<Color, float>> blendColors;
+    if(blendable)
+    {
+        renderContext.swapBlendColors(blendColors);
+    }
+
+    // The scissor is combined with the current one when the render cache is drawn:
+    nvgResetTransform(&nanoVgContext);
+    nvgResetScissor(&nanoVgContext);
+    nvgScale(&nanoVgContext, scaleX, scaleY);
+    nvgGlobalAlpha(&nanoVgContext, 1);
+
+    const std::pair<Color, float>& blendTint = renderContext.getBlendTint();
+    const Color& tintColor = blendTint.first;
+    nvgGlobalTint(&nanoVgContext, nvgRGBAf(tintColor.getRed(), tintColor.getGreen(), tintColor.getBlue(),
+            tintColor.getAlpha()), blendTint.second);
+    renderContext.invalidateNanoVgScissor();
+    nvgBindDisplayList(&nanoVgContext, renderCache->displayList);
+    priv::ImageManager::beginRecord(renderCache->atlasPageGenerations);
+    renderItself(renderContext);
+    priv::ImageManager::endRecord();
+    nvgBindDisplayList(&nanoVgContext, nullptr);
+    priv::DisplayListManager::recorded(nanoVgContext, *renderCache);
+
+    if(blendable)
+    {
+        renderContext.swapBlendColors(blendColors);
+    }
+
+    renderContext.applyNanoVgState();
+}
+
+#endif
+
 void Node::releaseRenderCache()
 {
     #ifdef TRJ_CFG_ENABLE_RENDER_CACHE
         if(mRenderCache)
         {
-            NVGdisplayList* displayList = static_cast<NVGdisplayList*>(mRenderCache);
-            priv::DisplayListManager::push(*displayList);
+            priv::DisplayListManager::push(*static_cast<priv::RenderCache*>(mRenderCache));
             mRenderCache = nullptr;
             mInvalidateRenderCache = true;
         }
+
+        releaseLodRenderCaches();
     #endif
 }
 
+#ifdef TRJ_CFG_ENABLE_RENDER_CACHE
+
+void Node::releaseLodRenderCaches()
+{
+    for(void*& lodRenderCache : mLodRenderCaches)
+    {
+        if(lodRenderCache)
+        {
+            priv::DisplayListManager::push(*static_cast<priv::RenderCache*>(lodRenderCache));
+            lodRenderCache = nullptr;
+        }
+    }
+}
+
+#endif
+
 Node& Node::getRootNode() noexcept
 {
     return Application::getRootNode();
@@ -445,8 +1076,14 @@ Node& Node::getRootNode() noexcept
 
 Node::~Node()
 {
+    if(mUpdateIndex >= 0)
+    {
+        priv::NodeUpdateManager::removeNode(*this);
+    }
+
     clearChildren();
     releaseRenderCache();
+    delete mSpatialIndex;
 }
 
 const Rect& Node::getBoundingBox()
@@ -468,6 +1105,34 @@ void Node::setRotationAngle(float angle) noexcept
     invalidateTransform();
 }
 
+void Node::setSpatialIndexEnabled(bool enabled)
+{
+    if(enabled)
+    {
+        if(! mSpatialIndex)
+        {
+            mSpatialIndex = new priv::SpatialIndex();
+
+            for(int index = 0, limit = mChildren.size(); index < limit; ++index)
+            {
+                addSpatialIndexItem(const_cast<Node&>(*mChildren[index]), index);
+            }
+        }
+    }
+    else if(mSpatialIndex)
+    {
+        for(const Node* constChild : mChildren)
+        {
+            Node* child = const_cast<Node*>(constChild);
+            child->mSpatialIndexItem = -1;
+            child->mSpatialIndexItemDirty = false;
+        }
+
+        delete mSpatialIndex;
+        mSpatialIndex = nullptr;
+    }
+}
+
 void Node::setScaleX(float scale) noexcept
 {
     TRJ_ASSERT(scale >= 0, "Invalid scale x");
@@ -492,7 +1157,6 @@ void Node::setOpacity(float opacity) noexcept
 
     mOpacity = opacity;
     invalidateHidden();
-    invalidateRenderCache();
 }
 
 void Node::setBlendColor(const Color& blendColor, float blendFactor) noexcept
@@ -502,7 +1166,11 @@ void Node::setBlendColor(const Color& blendColor, float blendFactor) noexcept
     mBlendColor = blendColor;
     mBlendColorFactor = blendFactor;
     invalidateHidden();
-    invalidateRenderCache();
+
+    if(! renderCacheBlendable())
+    {
+        invalidateRenderCache();
+    }
 }
 
 void Node::reserveShapeGroups(int numShapeGroups)
@@ -576,6 +1244,7 @@ void Node::setActions(std::vector<Ptr<Action>>&& actions) noexcept
     #endif
 
     mActions = std::move(actions);
+    refreshUpdateEntry();
 }
 
 void Node::clearActions() noexcept
@@ -583,6 +1252,7 @@ void Node::clearActions() noexcept
     TRJ_ASSERT(! mActionsRunning, "Actions can't be modified while they are running");
 
     mActions.clear();
+    refreshUpdateEntry();
 }
 
 void Node::resetActions() noexcept
@@ -590,6 +1260,7 @@ void Node::resetActions() noexcept
     TRJ_ASSERT(! mActionsRunning, "Actions can't be modified while they are running");
 
     std::vector<Ptr<Action>>().swap(mActions);
+    refreshUpdateEntry();
 }
 
 void Node::setActionsSpeed(float speed) noexcept
@@ -605,6 +1276,13 @@ void Node::setActionsPaused(bool paused) noexcept
     TRJ_ASSERT(! mActionsRunning, "Actions can't be modified while they are running");
 
     mActionsPaused = paused;
+    refreshUpdateEntry();
+}
+
+void Node::setUpdateEnabled(bool enabled)
+{
+    mUpdateEnabled = enabled;
+    refreshUpdateEntry();
 }
 
 const Node& Node::getChild(int index) const noexcept
@@ -674,6 +1352,11 @@ void Node::reserveChildren(int numChildren)
 
 void Node::setChildren(std::vector<Ptr<Node>>&& children)
 {
+    if(mSpatialIndex)
+    {
+        mSpatialIndex->clear();
+    }
+
     mChildren.clear();
     mChildren.reserve(children.size());
 
@@ -687,8 +1370,16 @@ void Node::removeChild(int index) noexcept
 {
     TRJ_ASSERT(index >= 0 && index < (int) mChildren.size(), "Invalid child node index");
 
-    delete mChildren[index];
+    Node* child = const_cast<Node*>(mChildren[index]);
+    if(mSpatialIndex)
+    {
+        removeSpatialIndexItem(*child);
+    }
+
+    child->mParent = nullptr;
+    delete child;
     mChildren.erase(mChildren.begin() + index);
+    invalidateSubtreeBoundingBox();
 }
 
 void Node::removeChild(Node& child) noexcept
@@ -705,8 +1396,14 @@ Ptr<Node> Node::releaseChild(int index) noexcept
     TRJ_ASSERT(index >= 0 && index < (int) mChildren.size(), "Invalid child node index");
 
     Node* child = const_cast<Node*>(mChildren[index]);
+    if(mSpatialIndex)
+    {
+        removeSpatialIndexItem(*child);
+    }
+
     child->mParent = nullptr;
     mChildren.erase(mChildren.begin() + index);
+    invalidateSubtreeBoundingBox();
     return Ptr<Node>(child);
 }
 
@@ -721,11 +1418,20 @@ Ptr<Node> Node::releaseChild(Node& child) noexcept
 
 void Node::clearChildren() noexcept
 {
+    if(mSpatialIndex)
+    {
+        mSpatialIndex->clear();
+    }
+
     while(! mChildren.empty())
     {
-        delete mChildren.back();
+        Node* child = const_cast<Node*>(mChildren.back());
+        child->mParent = nullptr;
+        delete child;
         mChildren.pop_back();
     }
+
+    invalidateSubtreeBoundingBox();
 }
 
 std::vector<Ptr<Node>> Node::releaseChildren()
@@ -736,10 +1442,18 @@ std::vector<Ptr<Node>> Node::releaseChildren()
     {
         Node* child = const_cast<Node*>(constChild);
         child->mParent = nullptr;
+        child->mSpatialIndexItem = -1;
+        child->mSpatialIndexItemDirty = false;
         releasedChildren.push_back(Ptr<Node>(child));
     }
 
+    if(mSpatialIndex)
+    {
+        mSpatialIndex->clear();
+    }
+
     mChildren.clear();
+    invalidateSubtreeBoundingBox();
     return releasedChildren;
 }
 
@@ -23,19 +23,17 @@
 #include "trjrendercontext.h"
 #include "trjdebug.h"
 #include "private/trjimagemanager.h"
+#include "private/trjhash.h"
 
 namespace trj
 {
 
 namespace
 {
-    NVGcolor getNVGColor(const Color& color,
-            const std::vector<std::pair<Color, float>>& blendColors) noexcept
+    // Blend colors are applied by the NanoVG global tint:
+    NVGcolor getNVGColor(const Color& color) noexcept
     {
-        Color finalColor = color.getBlendedColor(blendColors);
-
-        return nvgRGBAf(finalColor.getRed(), finalColor.getGreen(), finalColor.getBlue(),
-                finalColor.getAlpha());
+        return nvgRGBAf(color.getRed(), color.getGreen(), color.getBlue(), color.getAlpha());
     }
 
     void renderPaint(NVGcontext& nanoVgContext, const NVGpaint& nanoVgPaint, bool stroke,
@@ -102,7 +100,7 @@ Pen::Pen(const ImagePatternInfo& info, bool stroke, float strokeWidth) noexcept
 {
     TRJ_ASSERT(strokeWidth >= 0, "Invalid stroke width");
 
-    priv::ImageManager::addImageRef(mImagePatternInfo.imageHandle);
+    priv::ImageManager::addPatternImageRef(mImagePatternInfo.imageHandle);
 }
 
 Pen& Pen::operator=(const Pen& other)
@@ -215,6 +213,72 @@ Pen::~Pen()
     }
 }
 
+priv::Hash Pen::getHash() const noexcept
+{
+    priv::Hash hash;
+    priv::hashCombine(hash, static_cast<int>(mType));
+    priv::hashCombine(hash, static_cast<int>(mLineCap));
+    priv::hashCombine(hash, static_cast<int>(mLineJoin));
+    priv::hashCombine(hash, mStrokeWidth);
+    priv::hashCombine(hash, mStroke);
+
+    switch(mType)
+    {
+        case Type::COLOR:
+        {
+            priv::hashCombine(hash, mColorInfo.color);
+            break;
+        }
+
+        case Type::LINEAR_GRADIENT:
+        {
+            const LinearGradientInfo& info = mLinearGradientInfo;
+            priv::hashCombine(hash, info.startPosition);
+            priv::hashCombine(hash, info.endPosition);
+            priv::hashCombine(hash, info.innerColor);
+            priv::hashCombine(hash, info.outerColor);
+            break;
+        }
+
+        case Type::BOX_GRADIENT:
+        {
+            const BoxGradientInfo& info = mBoxGradientInfo;
+            priv::hashCombine(hash, info.rect);
+            priv::hashCombine(hash, info.innerColor);
+            priv::hashCombine(hash, info.outerColor);
+            priv::hashCombine(hash, info.cornerRadius);
+            priv::hashCombine(hash, info.cornerBlur);
+            break;
+        }
+
+        case Type::RADIAL_GRADIENT:
+        {
+            const RadialGradientInfo& info = mRadialGradientInfo;
+            priv::hashCombine(hash, info.position);
+            priv::hashCombine(hash, info.innerColor);
+            priv::hashCombine(hash, info.outerColor);
+            priv::hashCombine(hash, info.innerRadius);
+            priv::hashCombine(hash, info.outerRadius);
+            break;
+        }
+
+        case Type::IMAGE_PATTERN:
+        {
+            const ImagePatternInfo& info = mImagePatternInfo;
+            priv::hashCombine(hash, info.rect);
+            priv::hashCombine(hash, info.angle);
+            priv::hashCombine(hash, info.opacity);
+            priv::hashCombine(hash, info.imageHandle);
+            break;
+        }
+
+        case Type::NONE:
+            break;
+    }
+
+    return hash;
+}
+
 void Pen::setupLineCapAndLineJoin(NVGcontext& nanoVgContext) const
 {
     nvgLineCap(&nanoVgContext, static_cast<int>(mLineCap));
@@ -224,7 +288,6 @@ void Pen::setupLineCapAndLineJoin(NVGcontext& nanoVgContext) const
 void Pen::render(RenderContext& renderContext) const
 {
     NVGcontext& nanoVgContext = renderContext.getNanoVgContext();
-    const auto& blendColors = renderContext.getBlendColors();
 
     switch(mType)
     {
@@ -235,12 +298,12 @@ void Pen::render(RenderContext& renderContext) const
             if(mStroke)
             {
                 nvgStrokeWidth(&nanoVgContext, mStrokeWidth);
-                nvgStrokeColor(&nanoVgContext, getNVGColor(mColorInfo.color, blendColors));
+                nvgStrokeColor(&nanoVgContext, getNVGColor(mColorInfo.color));
                 nvgStroke(&nanoVgContext);
             }
             else
             {
-                nvgFillColor(&nanoVgContext, getNVGColor(mColorInfo.color, blendColors));
+                nvgFillColor(&nanoVgContext, getNVGColor(mColorInfo.color));
                 nvgFill(&nanoVgContext);
             }
 
@@ -254,8 +317,8 @@ void Pen::render(RenderContext& renderContext) const
             const Point& endPosition = info.endPosition;
             NVGpaint paint = nvgLinearGradient(&nanoVgContext, startPosition.getX(),
                     startPosition.getY(), endPosition.getX(), endPosition.getY(),
-                    getNVGColor(info.innerColor, blendColors),
-                    getNVGColor(info.outerColor, blendColors));
+                    getNVGColor(info.innerColor),
+                    getNVGColor(info.outerColor));
 
             setupLineCapAndLineJoin(nanoVgContext);
             renderPaint(nanoVgContext, paint, mStroke, mStrokeWidth);
@@ -268,8 +331,8 @@ void Pen::render(RenderContext& renderContext) const
             const Rect& rect = info.rect;
             NVGpaint paint = nvgBoxGradient(&nanoVgContext, rect.getX(), rect.getY(),
                     rect.getWidth(), rect.getHeight(), info.cornerRadius, info.cornerBlur,
-                    getNVGColor(info.innerColor, blendColors),
-                    getNVGColor(info.outerColor, blendColors));
+                    getNVGColor(info.innerColor),
+                    getNVGColor(info.outerColor));
 
             setupLineCapAndLineJoin(nanoVgContext);
             renderPaint(nanoVgContext, paint, mStroke, mStrokeWidth);
@@ -282,8 +345,8 @@ void Pen::render(RenderContext& renderContext) const
             const Point& position = info.position;
             NVGpaint paint = nvgRadialGradient(&nanoVgContext, position.getX(),
                     position.getY(), info.innerRadius, info.outerRadius,
-                    getNVGColor(info.innerColor, blendColors),
-                    getNVGColor(info.outerColor, blendColors));
+                    getNVGColor(info.innerColor),
+                    getNVGColor(info.outerColor));
 
             setupLineCapAndLineJoin(nanoVgContext);
             renderPaint(nanoVgContext, paint, mStroke, mStrokeWidth);
@@ -293,9 +356,10 @@ void Pen::render(RenderContext& renderContext) const
         case Type::IMAGE_PATTERN:
         {
             const ImagePatternInfo& info = mImagePatternInfo;
-            const Rect& rect = info.rect;
+            Rect rect;
+            int texture = priv::ImageManager::getTexture(info.imageHandle, info.rect, info.angle, rect);
             NVGpaint paint = nvgImagePattern(&nanoVgContext, rect.getX(), rect.getY(),
-                    rect.getWidth(), rect.getHeight(), info.angle, info.imageHandle, info.opacity);
+                    rect.getWidth(), rect.getHeight(), info.angle, texture, info.opacity);
 
             setupLineCapAndLineJoin(nanoVgContext);
             renderPaint(nanoVgContext, paint, mStroke, mStrokeWidth);
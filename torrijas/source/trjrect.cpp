@@ -19,6 +19,7 @@
 #include "trjrect.h"
 
 #include <algorithm>
+#include <cmath>
 #include "trjdebug.h"
 
 namespace trj
@@ -196,12 +197,20 @@ Rect Rect::getIntersected(const Rect& other) const noexcept
 
 Rect Rect::getTransformed(const std::array<float, 6>& transformationMatrix) const
 {
-    Point topLeftPosition = getTopLeft().getTransformed(transformationMatrix);
-    Point topRightPosition = getTopRight().getTransformed(transformationMatrix);
-    Point bottomLeftPosition = getBottomLeft().getTransformed(transformationMatrix);
-    Point bottomRightPosition = getBottomRight().getTransformed(transformationMatrix);
+    // Closed form: the center is transformed and the half size is projected on each axis:
+    const float* m = transformationMatrix.data();
+    float halfWidth = getWidth() * 0.5f;
+    float halfHeight = getHeight() * 0.5f;
+    float centerX = getX() + halfWidth;
+    float centerY = getY() + halfHeight;
 
-    return Rect(topLeftPosition, topRightPosition, bottomLeftPosition, bottomRightPosition);
+    float transformedCenterX = (m[0] * centerX) + (m[2] * centerY) + m[4];
+    float transformedCenterY = (m[1] * centerX) + (m[3] * centerY) + m[5];
+    float transformedHalfWidth = (std::abs(m[0]) * halfWidth) + (std::abs(m[2]) * halfHeight);
+    float transformedHalfHeight = (std::abs(m[1]) * halfWidth) + (std::abs(m[3]) * halfHeight);
+
+    return Rect(transformedCenterX - transformedHalfWidth, transformedCenterY - transformedHalfHeight,
+            transformedHalfWidth * 2, transformedHalfHeight * 2);
 }
 
 Rect operator*(const Rect& rect, float scaleFactor)
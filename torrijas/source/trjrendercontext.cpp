@@ -0,0 +1,102 @@
+//
+// Copyright (c) 2015 Gustavo Valiente gustavovalient@gmail.com
+//
+// This software is provided 'as-is', without any express or implied
+// warranty.  In no event will the authors be held liable for any damages
+// arising from the use of this software.
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it
+// freely, subject to the following restrictions:
+// 1. The origin of this software must not be misrepresented; you must not
+//    claim that you wrote the original software. If you use this software
+//    in a product, an acknowledgment in the product documentation would be
+//    appreciated but is not required.
+// 2. Altered source versions must be plainly marked as such, and must not be
+//    misrepresented as being the original software.
+// 3. This notice may not be removed or altered from any source distribution.
+//
+
+#include "trjrendercontext.h"
+
+#include <algorithm>
+#include <cmath>
+#include "nanovg.h"
+
+namespace trj
+{
+
+void RenderContext::intersectScissor(const Rect& rect) noexcept
+{
+    float x = rect.getX();
+    float y = rect.getY();
+    float width = rect.getWidth();
+    float height = rect.getHeight();
+
+    // Same steps as nvgIntersectScissor, the rect is in the current coordinate system:
+    if(mScissor.extentX >= 0)
+    {
+        std::array<float, 6> inverseTransform;
+        std::array<float, 6> scissorTransform = mScissor.transform;
+        nvgTransformInverse(inverseTransform.data(), mTransform.data());
+        nvgTransformMultiply(scissorTransform.data(), inverseTransform.data());
+
+        float extentX = (mScissor.extentX * std::abs(scissorTransform[0])) +
+                (mScissor.extentY * std::abs(scissorTransform[2]));
+        float extentY = (mScissor.extentX * std::abs(scissorTransform[1])) +
+                (mScissor.extentY * std::abs(scissorTransform[3]));
+        float minX = std::max(scissorTransform[4] - extentX, x);
+        float minY = std::max(scissorTransform[5] - extentY, y);
+        float maxX = std::min(scissorTransform[4] + extentX, x + width);
+        float maxY = std::min(scissorTransform[5] + extentY, y + height);
+        x = minX;
+        y = minY;
+        width = maxX - minX;
+        height = maxY - minY;
+    }
+
+    width = std::max(0.0f, width);
+    height = std::max(0.0f, height);
+
+    mScissor.transform = {{ 1, 0, 0, 1, x + (width * 0.5f), y + (height * 0.5f) }};
+    nvgTransformMultiply(mScissor.transform.data(), mTransform.data());
+    mScissor.extentX = width * 0.5f;
+    mScissor.extentY = height * 0.5f;
+    mNanoVgScissorUpdated = false;
+}
+
+void RenderContext::applyNanoVgState() noexcept
+{
+    NVGcontext* nanoVgContext = &mNanoVgContext;
+
+    if(! mNanoVgScissorUpdated)
+    {
+        if(mScissor.extentX < 0)
+        {
+            nvgResetScissor(nanoVgContext);
+        }
+        else
+        {
+            // A rect centered at the origin keeps the scissor transform as is:
+            const float* transform = mScissor.transform.data();
+            nvgResetTransform(nanoVgContext);
+            nvgTransform(nanoVgContext, transform[0], transform[1], transform[2], transform[3],
+                    transform[4], transform[5]);
+            nvgScissor(nanoVgContext, -mScissor.extentX, -mScissor.extentY, mScissor.extentX * 2,
+                    mScissor.extentY * 2);
+        }
+
+        mNanoVgScissorUpdated = true;
+    }
+
+    const float* transform = mTransform.data();
+    nvgResetTransform(nanoVgContext);
+    nvgTransform(nanoVgContext, transform[0], transform[1], transform[2], transform[3], transform[4],
+            transform[5]);
+    nvgGlobalAlpha(nanoVgContext, mOpacity);
+
+    const Color& tintColor = mBlendTint.first;
+    nvgGlobalTint(nanoVgContext, nvgRGBAf(tintColor.getRed(), tintColor.getGreen(), tintColor.getBlue(),
+            tintColor.getAlpha()), mBlendTint.second);
+}
+
+}
@@ -30,6 +30,8 @@ RepeatAction::RepeatAction(Ptr<Action>&& action, int times) :
 {
     TRJ_ASSERT(mAction.get(), "Action is empty");
     TRJ_ASSERT(times >= 0, "Invalid times");
+
+    mCallBacks = mAction->hasCallBacks();
 }
 
 bool RepeatAction::run(float elapsedTime, Node& node)
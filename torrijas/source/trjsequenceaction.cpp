@@ -36,6 +36,11 @@ SequenceAction::SequenceAction(std::vector<Ptr<Action>>&& actions, bool forward)
         }
     #endif
 
+    for(const auto& action : mActions)
+    {
+        mCallBacks |= action->hasCallBacks();
+    }
+
     if(forward)
     {
         mIndex = 0;
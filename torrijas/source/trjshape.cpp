@@ -21,6 +21,7 @@
 #include "nanovg.h"
 #include "trjpen.h"
 #include "trjdebug.h"
+#include "private/trjhash.h"
 
 namespace trj
 {
@@ -282,6 +283,90 @@ void Shape::render(NVGcontext& nanoVgContext) const
     }
 }
 
+priv::Hash Shape::getHash() const noexcept
+{
+    priv::Hash hash;
+    priv::hashCombine(hash, static_cast<int>(mType));
+    priv::hashCombine(hash, mHole);
+
+    switch(mType)
+    {
+        case Type::ARC:
+        {
+            const ArcInfo& info = mArcInfo;
+            priv::hashCombine(hash, info.position);
+            priv::hashCombine(hash, info.radius);
+            priv::hashCombine(hash, info.startAngle);
+            priv::hashCombine(hash, info.endAngle);
+            priv::hashCombine(hash, info.clockWise);
+        }
+        break;
+
+        case Type::TRIANGLE:
+        {
+            const TriangleInfo& info = mTriangleInfo;
+            priv::hashCombine(hash, info.firstVertex);
+            priv::hashCombine(hash, info.secondVertex);
+            priv::hashCombine(hash, info.thirdVertex);
+        }
+        break;
+
+        case Type::RECT:
+        {
+            const RectInfo& info = mRectInfo;
+            priv::hashCombine(hash, info.rect);
+            priv::hashCombine(hash, info.cornerRadius);
+            priv::hashCombine(hash, info.rounded);
+        }
+        break;
+
+        case Type::ELLIPSE:
+        {
+            const EllipseInfo& info = mEllipseInfo;
+            priv::hashCombine(hash, info.position);
+            priv::hashCombine(hash, info.horizontalRadius);
+            priv::hashCombine(hash, info.verticalRadius);
+        }
+        break;
+
+        case Type::MOVE_TO:
+        {
+            const MoveToInfo& info = mMoveToInfo;
+            priv::hashCombine(hash, info.position);
+        }
+        break;
+
+        case Type::LINE_TO:
+        {
+            const LineToInfo& info = mLineToInfo;
+            priv::hashCombine(hash, info.position);
+        }
+        break;
+
+        case Type::BEZIER_TO:
+        {
+            const BezierToInfo& info = mBezierToInfo;
+            priv::hashCombine(hash, info.controlPosition1);
+            priv::hashCombine(hash, info.controlPosition2);
+            priv::hashCombine(hash, info.position);
+        }
+        break;
+
+        case Type::QUAD_TO:
+        {
+            const QuadToInfo& info = mQuadToInfo;
+            priv::hashCombine(hash, info.controlPosition);
+            priv::hashCombine(hash, info.position);
+        }
+        break;
+
+        default:
+            break;
+    }
+
+    return hash;
+}
+
 void Shape::horizontalFlip() noexcept
 {
     switch(mType)
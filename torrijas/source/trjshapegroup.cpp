@@ -21,6 +21,7 @@
 #include "nanovg.h"
 #include "trjrendercontext.h"
 #include "trjdebug.h"
+#include "private/trjhash.h"
 
 namespace trj
 {
@@ -83,6 +84,18 @@ const Rect& ShapeGroup::getBoundingBox() noexcept
     return mBoundingBox;
 }
 
+priv::Hash ShapeGroup::getHash() const noexcept
+{
+    priv::Hash hash = mPen.getHash();
+
+    for(const Shape& shape : mShapes)
+    {
+        priv::hashCombine(hash, shape.getHash());
+    }
+
+    return hash;
+}
+
 void ShapeGroup::reserveShapes(int numShapes)
 {
     TRJ_ASSERT(numShapes > 0, "Invalid num shapes");
@@ -18,11 +18,13 @@
 
 #include "trjtextnode.h"
 
+#include <typeinfo>
 #include "nanovg.h"
 #include "trjfont.h"
 #include "trjapplication.h"
 #include "trjrendercontext.h"
 #include "trjdebug.h"
+#include "private/trjhash.h"
 
 namespace trj
 {
@@ -83,9 +85,37 @@ Rect TextNode::generateBoundingBox()
     return boundingBox;
 }
 
-bool TextNode::renderCacheAvailable(const RenderContext& renderContext) const
+bool TextNode::renderCacheBlendable() const
 {
-    return mTexts.empty() && Node::renderCacheAvailable(renderContext);
+    return typeid(*this) == typeid(TextNode);
+}
+
+bool TextNode::renderCacheConcurrent() const
+{
+    // Glyphs are rendered in the font atlas of the application NanoVG context:
+    return false;
+}
+
+priv::Hash TextNode::generateRenderCacheHash() const
+{
+    priv::Hash hash = Node::generateRenderCacheHash();
+    priv::hashCombine(hash, String("TextNode"));
+    priv::hashCombine(hash, mFontColor);
+    priv::hashCombine(hash, mFontSize);
+    priv::hashCombine(hash, mFontBlur);
+    priv::hashCombine(hash, mFontLetterSpacing);
+    priv::hashCombine(hash, mFontLineHeight);
+    priv::hashCombine(hash, static_cast<int>(mHorizontalAlignment) | static_cast<int>(mVerticalAlignment));
+    priv::hashCombine(hash, mFontHandle);
+
+    for(const Text& text : mTexts)
+    {
+        priv::hashCombine(hash, text.getPosition());
+        priv::hashCombine(hash, text.getString());
+        priv::hashCombine(hash, text.getBoxWidth());
+    }
+
+    return hash;
 }
 
 void TextNode::renderItself(RenderContext& renderContext)
@@ -95,9 +125,9 @@ void TextNode::renderItself(RenderContext& renderContext)
 
     setupContext(nanoVgContext);
 
-    Color finalColor = mFontColor.getBlendedColor(renderContext.getBlendColors());
-    nvgFillColor(&nanoVgContext, nvgRGBAf(finalColor.getRed(), finalColor.getGreen(),
-            finalColor.getBlue(), finalColor.getAlpha()));
+    // Blend colors are applied by the NanoVG global tint:
+    nvgFillColor(&nanoVgContext, nvgRGBAf(mFontColor.getRed(), mFontColor.getGreen(), mFontColor.getBlue(),
+            mFontColor.getAlpha()));
 
     for(const Text& text : mTexts)
     {